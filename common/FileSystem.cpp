@@ -16,6 +16,7 @@
 #include <cstring>
 #include <limits>
 #include <numeric>
+#include <utility>
 
 #ifdef __APPLE__
 #include <mach-o/dyld.h>
@@ -40,6 +41,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <limits.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -1094,6 +1096,29 @@ s64 FileSystem::FSize64(std::FILE* fp)
 	return -1;
 }
 
+FileSystem::MappedFile::MappedFile() = default;
+
+FileSystem::MappedFile::MappedFile(MappedFile&& move)
+{
+	*this = std::move(move);
+}
+
+FileSystem::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+FileSystem::MappedFile& FileSystem::MappedFile::operator=(MappedFile&& move)
+{
+	Close();
+	m_data = std::exchange(move.m_data, nullptr);
+	m_size = std::exchange(move.m_size, 0);
+#ifdef _WIN32
+	m_mapping = std::exchange(move.m_mapping, nullptr);
+#endif
+	return *this;
+}
+
 s64 FileSystem::GetPathFileSize(const char* Path)
 {
 	FILESYSTEM_STAT_DATA sd;
@@ -1885,6 +1910,76 @@ bool FileSystem::SetPathCompression(const char* path, bool enable)
 	return result;
 }
 
+bool FileSystem::MappedFile::Open(const char* path, Error* error)
+{
+	Close();
+
+	const HANDLE file = CreateFileW(GetWin32Path(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		Error::SetWin32(error, "CreateFileW() failed: ", GetLastError());
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+	{
+		Error::SetStringView(error, "File is empty or its size could not be determined.");
+		CloseHandle(file);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file.
+	const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+	{
+		Error::SetWin32(error, "CreateFileMappingW() failed: ", GetLastError());
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		Error::SetWin32(error, "MapViewOfFile() failed: ", GetLastError());
+		CloseHandle(mapping);
+		return false;
+	}
+
+	m_data = static_cast<const u8*>(data);
+	m_size = static_cast<size_t>(size.QuadPart);
+	m_mapping = mapping;
+	return true;
+}
+
+void FileSystem::MappedFile::Close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+		m_size = 0;
+	}
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+}
+
+void FileSystem::MappedFile::Advise(size_t offset, size_t size, AccessPattern pattern) const
+{
+	// Windows only has an equivalent for WillNeed, the cache manager works out sequential access by itself.
+	if (!m_data || offset >= m_size || pattern != AccessPattern::WillNeed)
+		return;
+
+	WIN32_MEMORY_RANGE_ENTRY entry;
+	entry.VirtualAddress = const_cast<u8*>(m_data) + offset;
+	entry.NumberOfBytes = std::min(size, m_size - offset);
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+}
+
 #else
 
 // No 32-bit file offsets breaking stuff please.
@@ -2402,6 +2497,79 @@ bool FileSystem::SetPathCompression(const char* path, bool enable)
 	return false;
 }
 
+bool FileSystem::MappedFile::Open(const char* path, Error* error)
+{
+	Close();
+
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		Error::SetErrno(error, "open() failed: ", errno);
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		Error::SetStringView(error, "File is empty or its size could not be determined.");
+		close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	const int err = errno;
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		Error::SetErrno(error, "mmap() failed: ", err);
+		return false;
+	}
+
+	m_data = static_cast<const u8*>(data);
+	m_size = static_cast<size_t>(st.st_size);
+	return true;
+}
+
+void FileSystem::MappedFile::Close()
+{
+	if (!m_data)
+		return;
+
+	munmap(const_cast<u8*>(m_data), m_size);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+void FileSystem::MappedFile::Advise(size_t offset, size_t size, AccessPattern pattern) const
+{
+	if (!m_data || offset >= m_size)
+		return;
+
+	int advice;
+	switch (pattern)
+	{
+		case AccessPattern::Sequential:
+			advice = MADV_SEQUENTIAL;
+			break;
+		case AccessPattern::Random:
+			advice = MADV_RANDOM;
+			break;
+		case AccessPattern::WillNeed:
+			advice = MADV_WILLNEED;
+			break;
+		case AccessPattern::Normal:
+		default:
+			advice = MADV_NORMAL;
+			break;
+	}
+
+	// madvise() wants a page aligned start address.
+	const size_t aligned_offset = offset & ~static_cast<size_t>(__pagemask);
+	const size_t aligned_size = std::min(size, m_size - offset) + (offset - aligned_offset);
+	madvise(const_cast<u8*>(m_data) + aligned_offset, aligned_size, advice);
+}
+
 FileSystem::POSIXLock::POSIXLock(int fd)
 {
 	if (lockf(fd, F_LOCK, 0) == 0)
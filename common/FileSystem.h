@@ -174,6 +174,45 @@ namespace FileSystem
 	std::wstring GetWin32Path(std::string_view str);
 #endif
 
+	/// Read-only memory mapping of an entire file.
+	class MappedFile
+	{
+	public:
+		enum class AccessPattern
+		{
+			Normal,
+			Sequential,
+			Random,
+			WillNeed,
+		};
+
+		MappedFile();
+		MappedFile(MappedFile&& move);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& move);
+
+		bool Open(const char* path, Error* error = nullptr);
+		void Close();
+
+		bool IsOpen() const { return (m_data != nullptr); }
+		const u8* GetData() const { return m_data; }
+		size_t GetSize() const { return m_size; }
+
+		/// Hints to the OS how the given range of the mapping is going to be accessed.
+		/// Purely advisory, failures are ignored.
+		void Advise(size_t offset, size_t size, AccessPattern pattern) const;
+
+	private:
+		const u8* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void* m_mapping = nullptr;
+#endif
+	};
+
 	/// Abstracts a POSIX file lock.
 #ifndef _WIN32
 	class POSIXLock
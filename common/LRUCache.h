@@ -4,20 +4,20 @@
 #pragma once
 #include "HeterogeneousContainers.h"
 #include <cstdint>
-#include <map>
-
-template <class K, class V>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+/// Least-recently-used cache. Items are kept in a list ordered by last access (most recent at the front),
+/// with a hash index into the list, so lookups, insertions and evictions are all constant time.
+/// Pointers returned by Lookup()/Insert() stay valid until the item is evicted or removed.
+template <class K, class V, class Hash = std::hash<K>>
 class LRUCache
 {
-	using CounterType = std::uint64_t;
-
-	struct Item
-	{
-		V value;
-		CounterType last_access;
-	};
-
-	using MapType = std::conditional_t<std::is_same_v<K, std::string>, StringMap<Item>, std::map<K, Item>>;
+	using ListType = std::list<std::pair<K, V>>;
+	using ListIterator = typename ListType::iterator;
+	using MapType = std::conditional_t<std::is_same_v<K, std::string>, UnorderedStringMap<ListIterator>,
+		std::unordered_map<K, ListIterator, Hash>>;
 
 public:
 	LRUCache(std::size_t max_capacity = 16, bool manual_evict = false)
@@ -27,61 +27,56 @@ public:
 	}
 	~LRUCache() = default;
 
-	std::size_t GetSize() const { return m_items.size(); }
+	std::size_t GetSize() const { return m_index.size(); }
 	std::size_t GetMaxCapacity() const { return m_max_capacity; }
 
-	void Clear() { m_items.clear(); }
+	void Clear()
+	{
+		m_index.clear();
+		m_items.clear();
+	}
 
 	void SetMaxCapacity(std::size_t capacity)
 	{
 		m_max_capacity = capacity;
-		if (m_items.size() > m_max_capacity)
-			Evict(m_items.size() - m_max_capacity);
+		if (m_index.size() > m_max_capacity)
+			Evict(m_index.size() - m_max_capacity);
 	}
 
 	template <typename KeyT>
 	V* Lookup(const KeyT& key)
 	{
-		auto iter = m_items.find(key);
-		if (iter == m_items.end())
+		auto iter = m_index.find(key);
+		if (iter == m_index.end())
 			return nullptr;
 
-		iter->second.last_access = ++m_last_counter;
-		return &iter->second.value;
+		Touch(iter->second);
+		return &iter->second->second;
 	}
 
 	V* Insert(K key, V value)
 	{
-		ShrinkForNewItem();
-
-		auto iter = m_items.find(key);
-		if (iter != m_items.end())
+		auto iter = m_index.find(key);
+		if (iter != m_index.end())
 		{
-			iter->second.value = std::move(value);
-			iter->second.last_access = ++m_last_counter;
-			return &iter->second.value;
-		}
-		else
-		{
-			Item it;
-			it.last_access = ++m_last_counter;
-			it.value = std::move(value);
-			auto ip = m_items.emplace(std::move(key), std::move(it));
-			return &ip.first->second.value;
+			iter->second->second = std::move(value);
+			Touch(iter->second);
+			return &iter->second->second;
 		}
+
+		ShrinkForNewItem();
+
+		m_items.emplace_front(key, std::move(value));
+		m_index.emplace(std::move(key), m_items.begin());
+		return &m_items.front().second;
 	}
 
 	void Evict(std::size_t count = 1)
 	{
 		while (!m_items.empty() && count > 0)
 		{
-			typename MapType::iterator lowest = m_items.end();
-			for (auto iter = m_items.begin(); iter != m_items.end(); ++iter)
-			{
-				if (lowest == m_items.end() || iter->second.last_access < lowest->second.last_access)
-					lowest = iter;
-			}
-			m_items.erase(lowest);
+			m_index.erase(m_items.back().first);
+			m_items.pop_back();
 			count--;
 		}
 	}
@@ -89,10 +84,11 @@ public:
 	template <typename KeyT>
 	bool Remove(const KeyT& key)
 	{
-		auto iter = m_items.find(key);
-		if (iter == m_items.end())
+		auto iter = m_index.find(key);
+		if (iter == m_index.end())
 			return false;
-		m_items.erase(iter);
+		m_items.erase(iter->second);
+		m_index.erase(iter);
 		return true;
 	}
 	void SetManualEvict(bool block)
@@ -104,21 +100,27 @@ public:
 	void ManualEvict()
 	{
 		// evict if we went over
-		while (m_items.size() > m_max_capacity)
-			Evict(m_items.size() - m_max_capacity);
+		if (m_index.size() > m_max_capacity)
+			Evict(m_index.size() - m_max_capacity);
 	}
 
 private:
+	void Touch(ListIterator item)
+	{
+		if (item != m_items.begin())
+			m_items.splice(m_items.begin(), m_items, item);
+	}
+
 	void ShrinkForNewItem()
 	{
-		if (m_items.size() < m_max_capacity)
+		if (m_index.size() < m_max_capacity)
 			return;
 
-		Evict(m_items.size() - (m_max_capacity - 1));
+		Evict(m_index.size() - (m_max_capacity > 0 ? (m_max_capacity - 1) : 0));
 	}
 
-	MapType m_items;
-	CounterType m_last_counter = 0;
+	ListType m_items;
+	MapType m_index;
 	std::size_t m_max_capacity = 0;
 	bool m_manual_evict = false;
-};
\ No newline at end of file
+};
@@ -4,12 +4,14 @@
 #include "common/Perf.h"
 #include "common/Pcsx2Defs.h"
 #include "common/Assertions.h"
+#include "common/Console.h"
 #include "common/StringUtil.h"
 
 #ifdef ENABLE_VTUNE
 #include "jitprofiling.h"
 #endif
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 
@@ -24,7 +26,6 @@
 #endif
 
 //#define ProfileWithPerf
-//#define ProfileWithPerfJitDump
 
 #if defined(ENABLE_VTUNE) && defined(_WIN32)
 #pragma comment(lib, "jitprofiling.lib")
@@ -41,6 +42,7 @@ namespace Perf
 
 // Perf is only supported on linux
 #if defined(__linux__) && defined(ProfileWithPerf)
+	static constexpr bool s_has_static_profiler = true;
 	static std::FILE* s_map_file = nullptr;
 	static bool s_map_file_opened = false;
 	static std::mutex s_mutex;
@@ -64,7 +66,23 @@ namespace Perf
 		std::fprintf(s_map_file, "%" PRIx64 " %zx %s\n", static_cast<u64>(reinterpret_cast<uintptr_t>(ptr)), size, symbol);
 		std::fflush(s_map_file);
 	}
-#elif defined(__linux__) && defined(ProfileWithPerfJitDump)
+#elif defined(ENABLE_VTUNE)
+	static constexpr bool s_has_static_profiler = true;
+	static void RegisterMethod(const void* ptr, size_t size, const char* symbol)
+	{
+		iJIT_Method_Load_V2 ml = {};
+		ml.method_id = iJIT_GetNewMethodID();
+		ml.method_name = const_cast<char*>(symbol);
+		ml.method_load_address = const_cast<void*>(ptr);
+		ml.method_size = static_cast<unsigned int>(size);
+		iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED_V2, &ml);
+	}
+#else
+	static constexpr bool s_has_static_profiler = false;
+	static void RegisterMethod(const void* ptr, size_t size, const char* symbol) {}
+#endif
+
+#ifdef __linux__
 	enum : u32
 	{
 		JIT_CODE_LOAD = 0,
@@ -103,8 +121,31 @@ namespace Perf
 		u64 code_index;
 		// name
 	};
+	struct JITDUMP_CODE_DEBUG_INFO
+	{
+		JITDUMP_RECORD_HEADER header;
+		u64 code_addr;
+		u64 nr_entry;
+		// entries
+	};
+	struct JITDUMP_DEBUG_ENTRY
+	{
+		u64 code_addr;
+		u32 line;
+		u32 discrim;
+		// file name, or "\xff" if it's the same as the previous entry
+	};
 #pragma pack(pop)
 
+	// Code registered with Register() is generated once (dispatchers and the like), so it's kept around to be
+	// written out when the dump is enabled later on. Everything else is recompiled after the caller flushes.
+	struct StaticSymbol
+	{
+		const void* ptr;
+		size_t size;
+		std::string symbol;
+	};
+
 	static u64 JitDumpTimestamp()
 	{
 		struct timespec ts = {};
@@ -112,43 +153,62 @@ namespace Perf
 		return (static_cast<u64>(ts.tv_sec) * 1000000000ULL) + static_cast<u64>(ts.tv_nsec);
 	}
 
+	static std::atomic_bool s_jitdump_enabled{false};
 	static FILE* s_jitdump_file = nullptr;
 	static bool s_jitdump_file_opened = false;
 	static std::mutex s_jitdump_mutex;
-	static u32 s_jitdump_record_id;
+	static u64 s_jitdump_record_id;
+	static std::vector<StaticSymbol> s_static_symbols;
 
-	static void RegisterMethod(const void* ptr, size_t size, const char* symbol)
+	// Call with s_jitdump_mutex held.
+	static bool OpenJitDump()
 	{
-		const u32 namelen = std::strlen(symbol) + 1;
+		if (s_jitdump_file)
+			return true;
+		if (s_jitdump_file_opened)
+			return false;
 
-		std::unique_lock lock(s_jitdump_mutex);
+		s_jitdump_file_opened = true;
+
+		char file[256];
+		snprintf(file, std::size(file), "/tmp/jit-%d.dump", getpid());
+		s_jitdump_file = fopen(file, "w+b");
 		if (!s_jitdump_file)
 		{
-			if (!s_jitdump_file_opened)
-			{
-				char file[256];
-				snprintf(file, std::size(file), "jit-%d.dump", getpid());
-				s_jitdump_file = fopen(file, "w+b");
-				s_jitdump_file_opened = true;
-				if (!s_jitdump_file)
-					return;
-			}
+			Console.Error("Failed to open jitdump file %s", file);
+			return false;
+		}
 
-			void* perf_marker = mmap(nullptr, 4096, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(s_jitdump_file), 0);
-			pxAssertRel(perf_marker != MAP_FAILED, "Map perf marker");
+		// perf finds the dump through this mapping, it has to stay for the life of the process.
+		void* perf_marker = mmap(nullptr, 4096, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(s_jitdump_file), 0);
+		if (perf_marker == MAP_FAILED)
+		{
+			Console.Error("Failed to map jitdump marker for %s", file);
+			std::fclose(s_jitdump_file);
+			s_jitdump_file = nullptr;
+			return false;
+		}
 
-			JITDUMP_HEADER jh = {};
+		JITDUMP_HEADER jh = {};
 #if defined(_M_X86)
-			jh.elf_mach = EM_X86_64;
+		jh.elf_mach = EM_X86_64;
 #elif defined(_M_ARM64)
-			jh.elf_mach = EM_AARCH64;
+		jh.elf_mach = EM_AARCH64;
 #else
 #error Unhandled architecture.
 #endif
-			jh.pid = getpid();
-			jh.timestamp = JitDumpTimestamp();
-			std::fwrite(&jh, sizeof(jh), 1, s_jitdump_file);
-		}
+		jh.pid = getpid();
+		jh.timestamp = JitDumpTimestamp();
+		std::fwrite(&jh, sizeof(jh), 1, s_jitdump_file);
+
+		Console.WriteLn("Writing jitdump to %s", file);
+		return true;
+	}
+
+	// Call with s_jitdump_mutex held.
+	static void WriteJitDumpLoad(const void* ptr, size_t size, const char* symbol)
+	{
+		const u32 namelen = std::strlen(symbol) + 1;
 
 		JITDUMP_CODE_LOAD cl = {};
 		cl.header.id = JIT_CODE_LOAD;
@@ -165,19 +225,151 @@ namespace Perf
 		std::fwrite(ptr, size, 1, s_jitdump_file);
 		std::fflush(s_jitdump_file);
 	}
-#elif defined(ENABLE_VTUNE)
-	static void RegisterMethod(const void* ptr, size_t size, const char* symbol)
+
+	// Call with s_jitdump_mutex held. Has to come before the load record of the code it describes.
+	static void WriteJitDumpDebugInfo(const void* ptr, const std::vector<JITDUMP_DEBUG_ENTRY>& entries, const std::string& file)
 	{
-		iJIT_Method_Load_V2 ml = {};
-		ml.method_id = iJIT_GetNewMethodID();
-		ml.method_name = const_cast<char*>(symbol);
-		ml.method_load_address = const_cast<void*>(ptr);
-		ml.method_size = static_cast<unsigned int>(size);
-		iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED_V2, &ml);
+		const u32 first_namelen = static_cast<u32>(file.size()) + 1;
+		const u32 repeat_namelen = 2;
+
+		JITDUMP_CODE_DEBUG_INFO di = {};
+		di.header.id = JIT_CODE_DEBUG_INFO;
+		di.header.total_size = static_cast<u32>(sizeof(di) + sizeof(JITDUMP_DEBUG_ENTRY) * entries.size() +
+												 first_namelen + repeat_namelen * (entries.size() - 1));
+		di.header.timestamp = JitDumpTimestamp();
+		di.code_addr = static_cast<u64>(reinterpret_cast<uintptr_t>(ptr));
+		di.nr_entry = entries.size();
+		std::fwrite(&di, sizeof(di), 1, s_jitdump_file);
+
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			std::fwrite(&entries[i], sizeof(JITDUMP_DEBUG_ENTRY), 1, s_jitdump_file);
+			if (i == 0)
+				std::fwrite(file.c_str(), first_namelen, 1, s_jitdump_file);
+			else
+				std::fwrite("\xff", repeat_namelen, 1, s_jitdump_file);
+		}
+	}
+
+	void SetJitDumpEnabled(bool enabled)
+	{
+		std::unique_lock lock(s_jitdump_mutex);
+		if (s_jitdump_enabled.load(std::memory_order_relaxed) == enabled)
+			return;
+
+		if (enabled)
+		{
+			if (!OpenJitDump())
+				return;
+
+			for (const StaticSymbol& sym : s_static_symbols)
+				WriteJitDumpLoad(sym.ptr, sym.size, sym.symbol.c_str());
+		}
+		else
+		{
+			std::fflush(s_jitdump_file);
+		}
+
+		s_jitdump_enabled.store(enabled, std::memory_order_release);
+	}
+
+	bool IsJitDumpEnabled()
+	{
+		return s_jitdump_enabled.load(std::memory_order_acquire);
+	}
+
+	static void NotifyLoad(const void* ptr, size_t size, const char* symbol)
+	{
+		RegisterMethod(ptr, size, symbol);
+
+		if (IsJitDumpEnabled())
+		{
+			std::unique_lock lock(s_jitdump_mutex);
+			if (OpenJitDump())
+				WriteJitDumpLoad(ptr, size, symbol);
+		}
+	}
+
+	bool Group::OpenListing()
+	{
+		if (m_listing)
+			return true;
+		if (!m_listing_path.empty())
+			return false;
+
+		m_listing_path = StringUtil::StdStringFromFormat("/tmp/jit-%d-%s.s", getpid(), HasPrefix() ? m_prefix : "JIT");
+		m_listing = std::fopen(m_listing_path.c_str(), "wb");
+		if (!m_listing)
+			Console.Error("Failed to open jitdump listing %s", m_listing_path.c_str());
+
+		return (m_listing != nullptr);
+	}
+
+	void Group::RegisterBlock(const void* ptr, size_t size, u32 pc, const GuestInstruction* insts, size_t count,
+		DisassembleFn disassemble)
+	{
+		if (!IsJitDumpEnabled() || count == 0)
+		{
+			RegisterPC(ptr, size, pc);
+			return;
+		}
+
+		char full_symbol[128];
+		if (HasPrefix())
+			std::snprintf(full_symbol, std::size(full_symbol), "%s_%08X", m_prefix, pc);
+		else
+			std::snprintf(full_symbol, std::size(full_symbol), "%08X", pc);
+		RegisterMethod(ptr, size, full_symbol);
+
+		std::unique_lock lock(s_jitdump_mutex);
+		if (!OpenJitDump())
+			return;
+
+		if (OpenListing())
+		{
+			std::vector<JITDUMP_DEBUG_ENTRY> entries;
+			entries.reserve(count);
+
+			std::fprintf(m_listing, "%s:\n", full_symbol);
+			m_listing_line++;
+
+			std::string disasm;
+			for (size_t i = 0; i < count; i++)
+			{
+				disasm.clear();
+				disassemble(disasm, insts[i].pc);
+				std::fprintf(m_listing, "%08X\t%s\n", insts[i].pc, disasm.c_str());
+				m_listing_line++;
+
+				JITDUMP_DEBUG_ENTRY& entry = entries.emplace_back();
+				entry.code_addr = static_cast<u64>(reinterpret_cast<uintptr_t>(ptr) + insts[i].host_offset);
+				entry.line = m_listing_line;
+				entry.discrim = 0;
+			}
+			std::fflush(m_listing);
+
+			WriteJitDumpDebugInfo(ptr, entries, m_listing_path);
+		}
+
+		WriteJitDumpLoad(ptr, size, full_symbol);
+	}
+
+	void Group::Unregister(const void* ptr, size_t size)
+	{
+		if (!IsJitDumpEnabled() || size == 0)
+			return;
+
+		// jitdump has no unload record, perf attributes samples to the newest load at an address, so reused
+		// memory is taken care of by the next load. Log it in the listing so stale ranges can be told apart.
+		std::unique_lock lock(s_jitdump_mutex);
+		if (!OpenListing())
+			return;
+
+		std::fprintf(m_listing, "; unloaded %p-%p at %" PRIu64 "\n", ptr, static_cast<const u8*>(ptr) + size,
+			JitDumpTimestamp());
+		m_listing_line++;
 	}
-#endif
 
-#if (defined(__linux__) && (defined(ProfileWithPerf) || defined(ProfileWithPerfJitDump))) || defined(ENABLE_VTUNE)
 	void Group::Register(const void* ptr, size_t size, const char* symbol)
 	{
 		char full_symbol[128];
@@ -185,31 +377,86 @@ namespace Perf
 			std::snprintf(full_symbol, std::size(full_symbol), "%s_%s", m_prefix, symbol);
 		else
 			StringUtil::Strlcpy(full_symbol, symbol, std::size(full_symbol));
-		RegisterMethod(ptr, size, full_symbol);
+
+		{
+			std::unique_lock lock(s_jitdump_mutex);
+			auto it = std::find_if(s_static_symbols.begin(), s_static_symbols.end(),
+				[ptr](const StaticSymbol& sym) { return sym.ptr == ptr; });
+			if (it == s_static_symbols.end())
+				it = s_static_symbols.insert(s_static_symbols.end(), StaticSymbol{ptr, size, {}});
+			it->size = size;
+			it->symbol = full_symbol;
+		}
+
+		NotifyLoad(ptr, size, full_symbol);
+	}
+#else
+	void SetJitDumpEnabled(bool enabled)
+	{
+		if (enabled)
+			Console.Warning("jitdump output is only supported on Linux.");
+	}
+
+	bool IsJitDumpEnabled()
+	{
+		return false;
+	}
+
+	static void NotifyLoad(const void* ptr, size_t size, const char* symbol)
+	{
+		RegisterMethod(ptr, size, symbol);
+	}
+
+	bool Group::OpenListing()
+	{
+		return false;
+	}
+
+	void Group::RegisterBlock(const void* ptr, size_t size, u32 pc, const GuestInstruction* insts, size_t count,
+		DisassembleFn disassemble)
+	{
+		RegisterPC(ptr, size, pc);
 	}
 
+	void Group::Unregister(const void* ptr, size_t size) {}
+
+	void Group::Register(const void* ptr, size_t size, const char* symbol)
+	{
+		if constexpr (!s_has_static_profiler)
+			return;
+
+		char full_symbol[128];
+		if (HasPrefix())
+			std::snprintf(full_symbol, std::size(full_symbol), "%s_%s", m_prefix, symbol);
+		else
+			StringUtil::Strlcpy(full_symbol, symbol, std::size(full_symbol));
+		NotifyLoad(ptr, size, full_symbol);
+	}
+#endif
+
 	void Group::RegisterPC(const void* ptr, size_t size, u32 pc)
 	{
+		if (!s_has_static_profiler && !IsJitDumpEnabled())
+			return;
+
 		char full_symbol[128];
 		if (HasPrefix())
 			std::snprintf(full_symbol, std::size(full_symbol), "%s_%08X", m_prefix, pc);
 		else
 			std::snprintf(full_symbol, std::size(full_symbol), "%08X", pc);
-		RegisterMethod(ptr, size, full_symbol);
+		NotifyLoad(ptr, size, full_symbol);
 	}
 
 	void Group::RegisterKey(const void* ptr, size_t size, const char* prefix, u64 key)
 	{
+		if (!s_has_static_profiler && !IsJitDumpEnabled())
+			return;
+
 		char full_symbol[128];
 		if (HasPrefix())
 			std::snprintf(full_symbol, std::size(full_symbol), "%s_%s%016" PRIX64, m_prefix, prefix, key);
 		else
 			std::snprintf(full_symbol, std::size(full_symbol), "%s%016" PRIX64, prefix, key);
-		RegisterMethod(ptr, size, full_symbol);
+		NotifyLoad(ptr, size, full_symbol);
 	}
-#else
-	void Group::Register(const void* ptr, size_t size, const char* symbol) {}
-	void Group::RegisterPC(const void* ptr, size_t size, u32 pc) {}
-	void Group::RegisterKey(const void* ptr, size_t size, const char* prefix, u64 key) {}
-#endif
 } // namespace Perf
@@ -5,21 +5,53 @@
 
 #include <vector>
 #include <cstdio>
+#include <string>
 #include "common/Pcsx2Types.h"
 
 namespace Perf
 {
+	/// Offset of a guest instruction's host code from the start of its block.
+	struct GuestInstruction
+	{
+		u32 host_offset;
+		u32 pc;
+	};
+
+	/// Writes the disassembly of the guest instruction at pc to dest.
+	using DisassembleFn = void (*)(std::string& dest, u32 pc);
+
+	/// Starts or stops writing /tmp/jit-<pid>.dump for `perf inject --jit` (Linux only). Code which was
+	/// compiled while the dump was disabled isn't in it, so the caller should flush the recompilers.
+	void SetJitDumpEnabled(bool enabled);
+	bool IsJitDumpEnabled();
+
 	class Group
 	{
 		const char* m_prefix;
 
+		// Guest disassembly listing referenced by the jitdump's line info, opened on first use.
+		std::FILE* m_listing = nullptr;
+		std::string m_listing_path;
+		u32 m_listing_line = 0;
+
 	public:
-		constexpr Group(const char* prefix) : m_prefix(prefix) {}
+		Group(const char* prefix) : m_prefix(prefix) {}
 		bool HasPrefix() const { return (m_prefix && m_prefix[0]); }
 
 		void Register(const void* ptr, size_t size, const char* symbol);
 		void RegisterPC(const void* ptr, size_t size, u32 pc);
 		void RegisterKey(const void* ptr, size_t size, const char* prefix, u64 key);
+
+		/// Registers a recompiled block along with where each guest instruction starts in it. When the jitdump
+		/// is enabled, the instructions are disassembled into a listing so perf annotate can show guest code.
+		void RegisterBlock(const void* ptr, size_t size, u32 pc, const GuestInstruction* insts, size_t count,
+			DisassembleFn disassemble);
+
+		/// Notes that code previously registered in the range has been invalidated.
+		void Unregister(const void* ptr, size_t size);
+
+	private:
+		bool OpenListing();
 	};
 
 	extern Group any;
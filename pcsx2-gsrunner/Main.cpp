@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
 // SPDX-License-Identifier: GPL-3.0+
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
@@ -24,6 +25,7 @@
 #include "common/ProgressCallback.h"
 #include "common/SettingsWrapper.h"
 #include "common/StringUtil.h"
+#include "common/Timer.h"
 
 #include "pcsx2/PrecompiledHeader.h"
 
@@ -31,6 +33,7 @@
 #include "pcsx2/CDVD/CDVD.h"
 #include "pcsx2/GS.h"
 #include "pcsx2/GS/GSPerfMon.h"
+#include "pcsx2/GS/Renderers/Common/GSFunctionMap.h"
 #include "pcsx2/GSDumpReplayer.h"
 #include "pcsx2/GameList.h"
 #include "pcsx2/Host.h"
@@ -53,6 +56,9 @@ namespace GSRunner
 	static bool ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& params);
 	static void DumpStats();
 
+	static void UpdateBenchmarkFrame();
+	static bool WriteBenchmarkReport(const std::string& dump_filename);
+
 	static bool CreatePlatformWindow();
 	static void DestroyPlatformWindow();
 	static std::optional<WindowInfo> GetPlatformWindowInfo();
@@ -68,6 +74,7 @@ static std::string s_output_prefix;
 static s32 s_loop_count = 1;
 static std::optional<bool> s_use_window;
 static bool s_no_console = false;
+static std::string s_benchmark_path;
 
 // Owned by the GS thread.
 static u32 s_dump_frame_number = 0;
@@ -89,6 +96,12 @@ static u64 s_total_readbacks = 0;
 static u32 s_total_frames = 0;
 static u32 s_total_drawn_frames = 0;
 
+// Benchmark timings, only accessed on the GS thread until playback has finished.
+static Common::Timer::Value s_benchmark_start_time = 0;
+static Common::Timer::Value s_benchmark_last_frame_time = 0;
+static std::vector<float> s_benchmark_frame_times;
+static std::vector<u64> s_benchmark_start_sw_cpu_time;
+
 bool GSRunner::InitializeConfig()
 {
 	EmuFolders::SetAppRoot();
@@ -250,6 +263,9 @@ void Host::BeginPresentFrame()
 		GSQueueSnapshot(dump_path);
 	}
 
+	if (!s_benchmark_path.empty())
+		GSRunner::UpdateBenchmarkFrame();
+
 	if (GSIsHardwareRenderer())
 	{
 		const u32 last_draws = s_total_internal_draws;
@@ -445,6 +461,8 @@ static void PrintCommandLineHelp(const char* progname)
 	std::fprintf(stderr, "  -dumpdir <dir>: Frame dump directory (will be dumped as filename_frameN.png).\n");
 	std::fprintf(stderr, "  -loop <count>: Loops dump playback N times. Defaults to 1. 0 will loop infinitely.\n");
 	std::fprintf(stderr, "  -renderer <renderer>: Sets the graphics renderer. Defaults to Auto.\n");
+	std::fprintf(stderr, "  -benchmark <filename>: Writes frame times and software renderer statistics to filename\n"
+						 "    as JSON. Requires the SW or Null renderer, use -loop to set the number of runs.\n");
 	std::fprintf(stderr, "  -window: Forces a window to be displayed.\n");
 	std::fprintf(stderr, "  -surfaceless: Disables showing a window.\n");
 	std::fprintf(stderr, "  -logfile <filename>: Writes emu log to filename.\n");
@@ -533,6 +551,8 @@ bool GSRunner::ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& pa
 #endif
 				else if (StringUtil::Strcasecmp(rname, "sw") == 0)
 					type = GSRendererType::SW;
+				else if (StringUtil::Strcasecmp(rname, "null") == 0)
+					type = GSRendererType::Null;
 				else
 				{
 					Console.Error("Unknown renderer '%s'", rname);
@@ -543,6 +563,17 @@ bool GSRunner::ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& pa
 				s_settings_interface.SetIntValue("EmuCore/GS", "Renderer", static_cast<int>(type));
 				continue;
 			}
+			else if (CHECK_ARG_PARAM("-benchmark"))
+			{
+				s_benchmark_path = StringUtil::StripWhitespace(argv[++i]);
+				if (s_benchmark_path.empty())
+				{
+					Console.Error("Invalid benchmark output filename specified.");
+					return false;
+				}
+
+				continue;
+			}
 			else if (CHECK_ARG_PARAM("-renderhacks"))
 			{
 				std::string str(argv[++i]);
@@ -643,6 +674,26 @@ bool GSRunner::ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& pa
 		return false;
 	}
 
+	if (!s_benchmark_path.empty())
+	{
+		// Hardware renderers are timed by the GPU, which we don't have a way of reporting.
+		const GSRendererType type = static_cast<GSRendererType>(
+			s_settings_interface.GetIntValue("EmuCore/GS", "Renderer", static_cast<int>(GSRendererType::Auto)));
+		if (type != GSRendererType::SW && type != GSRendererType::Null)
+		{
+			Console.Error("Benchmark mode requires the SW or Null renderer.");
+			return false;
+		}
+
+		if (type == GSRendererType::SW)
+			s_settings_interface.SetBoolValue("EmuCore/GS", "sw_draw_stats", true);
+
+		if (!s_use_window.has_value())
+			s_use_window = false;
+
+		Console.WriteLn(fmt::format("Writing benchmark results to {}", s_benchmark_path));
+	}
+
 	// set up the frame dump directory
 	if (!s_output_prefix.empty())
 	{
@@ -671,6 +722,134 @@ void GSRunner::DumpStats()
 	Console.WriteLn("============================================");
 }
 
+void GSRunner::UpdateBenchmarkFrame()
+{
+	const Common::Timer::Value now = Common::Timer::GetCurrentValue();
+	if (s_benchmark_last_frame_time == 0)
+	{
+		// Start timing from the first frame, so renderer and thread creation isn't counted.
+		s_benchmark_start_time = now;
+		s_benchmark_start_sw_cpu_time.resize(PerformanceMetrics::GetGSSWThreadCount());
+		for (u32 i = 0; i < static_cast<u32>(s_benchmark_start_sw_cpu_time.size()); i++)
+			s_benchmark_start_sw_cpu_time[i] = PerformanceMetrics::GetGSSWThreadCPUTime(i);
+	}
+	else
+	{
+		s_benchmark_frame_times.push_back(
+			static_cast<float>(Common::Timer::ConvertValueToMilliseconds(now - s_benchmark_last_frame_time)));
+	}
+
+	s_benchmark_last_frame_time = now;
+}
+
+static std::string EscapeJSONString(const std::string_view str)
+{
+	std::string ret;
+	ret.reserve(str.size());
+	for (const char ch : str)
+	{
+		if (ch == '"' || ch == '\\')
+		{
+			ret.push_back('\\');
+			ret.push_back(ch);
+		}
+		else if (static_cast<unsigned char>(ch) < 0x20)
+		{
+			fmt::format_to(std::back_inserter(ret), "\\u{:04x}", static_cast<unsigned>(ch));
+		}
+		else
+		{
+			ret.push_back(ch);
+		}
+	}
+
+	return ret;
+}
+
+bool GSRunner::WriteBenchmarkReport(const std::string& dump_filename)
+{
+	// Gather everything on the GS thread, before the renderer goes away.
+	double elapsed = 0.0;
+	std::vector<double> thread_usage;
+	std::vector<GSFunctionMapStats> selectors;
+	MTGS::RunOnGSThread([&elapsed, &thread_usage, &selectors]() {
+		if (s_benchmark_last_frame_time == 0)
+			return;
+
+		elapsed = Common::Timer::ConvertValueToSeconds(s_benchmark_last_frame_time - s_benchmark_start_time);
+
+		// Make sure the rasterizer threads are idle before sampling their time.
+		GSgetSWDrawStats(&selectors);
+
+		const double ticks_per_second = static_cast<double>(Threading::GetThreadTicksPerSecond());
+		for (u32 i = 0; i < static_cast<u32>(s_benchmark_start_sw_cpu_time.size()); i++)
+		{
+			const u64 delta = PerformanceMetrics::GetGSSWThreadCPUTime(i) - s_benchmark_start_sw_cpu_time[i];
+			thread_usage.push_back((elapsed > 0.0) ? (static_cast<double>(delta) / ticks_per_second / elapsed * 100.0) : 0.0);
+		}
+	});
+	MTGS::WaitGS(false, false, false);
+
+	std::vector<float> frame_times(std::move(s_benchmark_frame_times));
+	std::sort(frame_times.begin(), frame_times.end());
+
+	const auto percentile = [&frame_times](double pct) {
+		if (frame_times.empty())
+			return 0.0f;
+
+		const size_t index = static_cast<size_t>(std::ceil(pct / 100.0 * static_cast<double>(frame_times.size())));
+		return frame_times[std::clamp<size_t>(index, 1, frame_times.size()) - 1];
+	};
+
+	double total_frame_time = 0.0;
+	for (const float time : frame_times)
+		total_frame_time += time;
+
+	std::string json;
+	fmt::format_to(std::back_inserter(json), "{{\n  \"dump\": \"{}\",\n", EscapeJSONString(dump_filename));
+	fmt::format_to(std::back_inserter(json), "  \"renderer\": \"{}\",\n", Pcsx2Config::GSOptions::GetRendererName(GSConfig.Renderer));
+	fmt::format_to(std::back_inserter(json), "  \"loops\": {},\n", s_loop_count);
+	fmt::format_to(std::back_inserter(json), "  \"frames\": {},\n", frame_times.size());
+	fmt::format_to(std::back_inserter(json), "  \"elapsed_seconds\": {:.6f},\n", elapsed);
+	fmt::format_to(std::back_inserter(json), "  \"fps\": {:.3f},\n", (elapsed > 0.0) ? (frame_times.size() / elapsed) : 0.0);
+	fmt::format_to(std::back_inserter(json),
+		"  \"frame_time_ms\": {{ \"mean\": {:.4f}, \"min\": {:.4f}, \"p50\": {:.4f}, \"p90\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f} }},\n",
+		frame_times.empty() ? 0.0 : (total_frame_time / frame_times.size()), frame_times.empty() ? 0.0f : frame_times.front(),
+		percentile(50.0), percentile(90.0), percentile(95.0), percentile(99.0), frame_times.empty() ? 0.0f : frame_times.back());
+
+	json += "  \"sw_thread_utilization_pct\": [";
+	for (size_t i = 0; i < thread_usage.size(); i++)
+		fmt::format_to(std::back_inserter(json), "{}{:.2f}", (i > 0) ? ", " : "", thread_usage[i]);
+	json += "],\n";
+
+	std::sort(selectors.begin(), selectors.end(), [](const GSFunctionMapStats& lhs, const GSFunctionMapStats& rhs) {
+		return lhs.ticks > rhs.ticks;
+	});
+
+	const double tick_ms = 1000.0 / static_cast<double>(GetTickFrequency());
+	json += "  \"selectors\": [";
+	for (size_t i = 0; i < selectors.size(); i++)
+	{
+		const GSFunctionMapStats& sel = selectors[i];
+		fmt::format_to(std::back_inserter(json),
+			"{}\n    {{ \"key\": \"{:016x}\", \"frames\": {}, \"prims\": {}, \"ticks\": {}, \"time_ms\": {:.4f}, "
+			"\"pixels\": {}, \"pixels_processed\": {}, \"ns_per_pixel\": {:.3f} }}",
+			(i > 0) ? "," : "", sel.key, sel.frames, sel.prims, sel.ticks, sel.ticks * tick_ms, sel.actual, sel.total,
+			(sel.ticks * tick_ms * 1000000.0) / static_cast<double>(sel.actual));
+	}
+	json += selectors.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+	if (!FileSystem::WriteStringToFile(s_benchmark_path.c_str(), json))
+	{
+		Console.Error(fmt::format("Failed to write benchmark results to {}", s_benchmark_path));
+		return false;
+	}
+
+	Console.WriteLn(fmt::format("@BENCH@ {} frames in {:.3f} seconds, {:.2f} FPS, p99 {:.3f} ms", frame_times.size(), elapsed,
+		(elapsed > 0.0) ? (frame_times.size() / elapsed) : 0.0, percentile(99.0)));
+	return true;
+}
+
 #ifdef _WIN32
 // We can't handle unicode in filenames if we don't use wmain on Win32.
 #define main real_main
@@ -704,6 +883,7 @@ int main(int argc, char* argv[])
 	VMManager::ApplySettings();
 	GSDumpReplayer::SetIsDumpRunner(true);
 
+	int result = EXIT_SUCCESS;
 	if (VMManager::Initialize(params))
 	{
 		// run until end
@@ -711,6 +891,10 @@ int main(int argc, char* argv[])
 		VMManager::SetState(VMState::Running);
 		while (VMManager::GetState() == VMState::Running)
 			VMManager::Execute();
+
+		if (!s_benchmark_path.empty() && !GSRunner::WriteBenchmarkReport(params.filename))
+			result = EXIT_FAILURE;
+
 		VMManager::Shutdown(false);
 		GSRunner::DumpStats();
 	}
@@ -718,7 +902,7 @@ int main(int argc, char* argv[])
 	VMManager::Internal::CPUThreadShutdown();
 	GSRunner::DestroyPlatformWindow();
 
-	return EXIT_SUCCESS;
+	return result;
 }
 
 void Host::PumpMessagesOnCPUThread()
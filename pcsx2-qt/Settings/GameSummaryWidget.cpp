@@ -276,7 +276,7 @@ void GameSummaryWidget::onVerifyClicked()
 	}
 
 	QtModalProgressCallback callback(this);
-	hasher.ComputeHashes(&callback);
+	hasher.ComputeHashes(&callback, true);
 	if (callback.IsCancelled())
 		return;
 
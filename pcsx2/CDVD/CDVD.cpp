@@ -563,15 +563,12 @@ static std::string ExecutablePathToSerial(const std::string& path)
 	return serial;
 }
 
-void cdvdGetDiscInfo(std::string* out_serial, std::string* out_elf_path, std::string* out_version, u32* out_crc,
-	CDVDDiscType* out_disc_type)
+static void GetDiscInfo(IsoReader& isor, bool opened, Error& error, std::string* out_serial, std::string* out_elf_path,
+	std::string* out_version, u32* out_crc, CDVDDiscType* out_disc_type)
 {
-	Error error;
-	IsoReader isor;
-
 	std::string elfpath, version;
 	CDVDDiscType disc_type = CDVDDiscType::Other;
-	if (!isor.Open(&error) || (disc_type = GetPS2ElfName(isor, &elfpath, &version, &error)) == CDVDDiscType::Other)
+	if (!opened || (disc_type = GetPS2ElfName(isor, &elfpath, &version, &error)) == CDVDDiscType::Other)
 		Console.Error(fmt::format("Failed to get ELF name: {}", error.GetDescription()));
 
 	// Don't bother parsing it if we don't need the CRC.
@@ -607,6 +604,42 @@ void cdvdGetDiscInfo(std::string* out_serial, std::string* out_elf_path, std::st
 		*out_disc_type = disc_type;
 }
 
+void cdvdGetDiscInfo(std::string* out_serial, std::string* out_elf_path, std::string* out_version, u32* out_crc,
+	CDVDDiscType* out_disc_type)
+{
+	Error error;
+	IsoReader isor;
+	const bool opened = isor.Open(&error);
+	GetDiscInfo(isor, opened, error, out_serial, out_elf_path, out_version, out_crc, out_disc_type);
+}
+
+bool cdvdGetDiscInfoFromFile(const std::string& path, s32* out_disc_type, std::string* out_serial, u32* out_crc,
+	Error* error)
+{
+	// Works on its own copy of the image, not the global CDVD object, so several can be looked at in parallel.
+	InputIsoFile iso;
+	if (!iso.Open(path, error))
+		return false;
+
+	Error fs_error;
+	IsoReader isor;
+	const bool opened = isor.Open(&iso, &fs_error);
+
+	// Same result as DoCDVDdetectDiskType(), images only have the one track.
+	if (iso.GetType() == ISOTYPE_AUDIO)
+	{
+		*out_disc_type = CDVD_TYPE_CDDA;
+	}
+	else
+	{
+		*out_disc_type = DoCDVDcheckDiskTypeFS(opened ? &isor : nullptr,
+			(iso.GetType() == ISOTYPE_DVD) ? CDVD_TYPE_DETCTDVDS : CDVD_TYPE_DETCTCD);
+	}
+
+	GetDiscInfo(isor, opened, fs_error, out_serial, nullptr, nullptr, out_crc, nullptr);
+	return true;
+}
+
 void cdvdReadKey(u8, u16, u32 arg2, u8* key)
 {
 	const std::string DiscSerial = VMManager::GetDiscSerial();
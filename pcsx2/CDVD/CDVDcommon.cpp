@@ -66,10 +66,16 @@ static void CheckNullCDVD()
 static int CheckDiskTypeFS(int baseType)
 {
 	IsoReader isor;
-	if (isor.Open())
+	return DoCDVDcheckDiskTypeFS(isor.Open() ? &isor : nullptr, baseType);
+}
+
+// isor is null if the filesystem couldn't be opened.
+s32 DoCDVDcheckDiskTypeFS(IsoReader* isor, s32 baseType)
+{
+	if (isor)
 	{
 		std::vector<u8> data;
-		if (isor.ReadFile("SYSTEM.CNF", &data))
+		if (isor->ReadFile("SYSTEM.CNF", &data))
 		{
 			if (StringUtil::ContainsSubString(data, "BOOT2"))
 			{
@@ -87,13 +93,13 @@ static int CheckDiskTypeFS(int baseType)
 		}
 
 		// PS2 Linux disc 2, doesn't have a System.CNF or a normal ELF
-		if (isor.FileExists("P2L_0100.02"))
+		if (isor->FileExists("P2L_0100.02"))
 			return CDVD_TYPE_PS2DVD;
 
-		if (isor.FileExists("PSX.EXE"))
+		if (isor->FileExists("PSX.EXE"))
 			return CDVD_TYPE_PSCD;
 
-		if (isor.FileExists("VIDEO_TS/VIDEO_TS.IFO"))
+		if (isor->FileExists("VIDEO_TS/VIDEO_TS.IFO"))
 			return CDVD_TYPE_DVDV;
 	}
 
@@ -8,6 +8,7 @@
 #include <string>
 
 class Error;
+class IsoReader;
 class ProgressCallback;
 
 typedef struct _cdvdSubQ
@@ -161,4 +162,5 @@ extern s32 DoCDVDreadSector(u8* buffer, u32 lsn, int mode);
 extern s32 DoCDVDreadTrack(u32 lsn, int mode);
 extern s32 DoCDVDgetBuffer(u8* buffer);
 extern s32 DoCDVDdetectDiskType();
+extern s32 DoCDVDcheckDiskTypeFS(IsoReader* isor, s32 baseType);
 extern void DoCDVDresetDiskTypeCache();
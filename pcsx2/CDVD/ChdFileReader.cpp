@@ -7,6 +7,7 @@
 #include "common/Console.h"
 #include "common/Error.h"
 #include "common/FileSystem.h"
+#include "common/LRUCache.h"
 #include "common/Path.h"
 #include "common/ProgressCallback.h"
 #include "common/SmallString.h"
@@ -20,6 +21,51 @@ static constexpr u32 MAX_PARENTS = 32; // Surely someone wouldn't be insane enou
 static std::vector<std::pair<std::string, chd_header>> s_chd_hash_cache; // <filename, header>
 static std::recursive_mutex s_chd_hash_cache_mutex;
 
+// Decompressed hunks, shared between every reader in the process so that the game list, hashing and
+// the running game don't all decompress the same hunks again (e.g. swapping between discs of a set).
+static constexpr u64 HUNK_CACHE_SIZE = 32 * _1mb;
+namespace
+{
+	struct HunkCacheKey
+	{
+		std::array<u8, CHD_SHA1_BYTES> sha1;
+		u32 hunk;
+
+		bool operator==(const HunkCacheKey& rhs) const
+		{
+			return (hunk == rhs.hunk && std::memcmp(sha1.data(), rhs.sha1.data(), sha1.size()) == 0);
+		}
+	};
+
+	struct HunkCacheKeyHash
+	{
+		size_t operator()(const HunkCacheKey& key) const
+		{
+			// The SHA1 is already well distributed, so mixing part of it with the hunk index is enough.
+			u64 h;
+			std::memcpy(&h, key.sha1.data(), sizeof(h));
+			return static_cast<size_t>(h ^ (static_cast<u64>(key.hunk) * 0x9E3779B97F4A7C15ULL));
+		}
+	};
+} // namespace
+static LRUCache<HunkCacheKey, std::vector<u8>, HunkCacheKeyHash> s_hunk_cache(0);
+static std::mutex s_hunk_cache_mutex;
+static u32 s_hunk_cache_max_hunk_size = 0;
+static std::atomic<u64> s_hunk_cache_hits{0};
+static std::atomic<u64> s_hunk_cache_misses{0};
+static thread_local bool s_hunk_cache_bypass = false;
+
+ChdFileReader::ScopedHunkCacheBypass::ScopedHunkCacheBypass()
+	: m_prev(s_hunk_cache_bypass)
+{
+	s_hunk_cache_bypass = true;
+}
+
+ChdFileReader::ScopedHunkCacheBypass::~ScopedHunkCacheBypass()
+{
+	s_hunk_cache_bypass = m_prev;
+}
+
 ChdFileReader::ChdFileReader() = default;
 
 ChdFileReader::~ChdFileReader()
@@ -170,6 +216,14 @@ bool ChdFileReader::Open2(std::string filename, Error* error)
 
 	const chd_header* chd_header = chd_get_header(ChdFile);
 	hunk_size = chd_header->hunkbytes;
+
+	// Old versions don't have an overall checksum, so there's nothing to safely share hunks by.
+	// Hashing opens with the cache bypassed, since it has to see what's actually in the file.
+	std::memcpy(sha1.data(), chd_header->sha1, sha1.size());
+	use_hunk_cache = !s_hunk_cache_bypass && std::any_of(sha1.begin(), sha1.end(), [](u8 v) { return v != 0; }) &&
+					 hunk_size <= HUNK_CACHE_SIZE;
+	hunk_cache_hits.store(0, std::memory_order_relaxed);
+	hunk_cache_misses.store(0, std::memory_order_relaxed);
 	// CHD likes to use full 2448 byte blocks, but keeps the +24 offset of source ISOs
 	// The rest of PCSX2 likes to use 2448 byte buffers, which can't fit that so trim blocks instead
 	m_internalBlockSize = chd_header->unitbytes;
@@ -213,6 +267,7 @@ bool ChdFileReader::Precache2(ProgressCallback* progress, Error* error)
 		return false;
 	}
 
+	precached = true;
 	return true;
 }
 
@@ -237,23 +292,120 @@ int ChdFileReader::ReadChunk(void* dst, s64 chunkID)
 	if (chunkID < 0)
 		return -1;
 
-	chd_error error = chd_read(ChdFile, chunkID, dst);
+	return ReadHunk(ChdFile, dst, chunkID);
+}
+
+int ChdFileReader::ReadHunk(chd_file* chd, void* dst, s64 hunk)
+{
+	const HunkCacheKey key = {sha1, static_cast<u32>(hunk)};
+	if (use_hunk_cache)
+	{
+		std::unique_lock lock(s_hunk_cache_mutex);
+		if (const std::vector<u8>* data = s_hunk_cache.Lookup(key); data && data->size() == hunk_size)
+		{
+			std::memcpy(dst, data->data(), hunk_size);
+			lock.unlock();
+			hunk_cache_hits.fetch_add(1, std::memory_order_relaxed);
+			s_hunk_cache_hits.fetch_add(1, std::memory_order_relaxed);
+			return hunk_size;
+		}
+	}
+
+	chd_error error = chd_read(chd, static_cast<u32>(hunk), dst);
 	if (error != CHDERR_NONE)
 	{
 		Console.Error("CDVD: chd_read returned error: %s", chd_error_string(error));
 		return 0;
 	}
 
+	if (use_hunk_cache)
+	{
+		hunk_cache_misses.fetch_add(1, std::memory_order_relaxed);
+		s_hunk_cache_misses.fetch_add(1, std::memory_order_relaxed);
+
+		const u8* src = static_cast<const u8*>(dst);
+		std::vector<u8> data(src, src + hunk_size);
+
+		// Capacity is in entries, so size it for the largest hunks we've seen to stay within the byte budget.
+		std::unique_lock lock(s_hunk_cache_mutex);
+		if (hunk_size > s_hunk_cache_max_hunk_size)
+		{
+			s_hunk_cache_max_hunk_size = hunk_size;
+			s_hunk_cache.SetMaxCapacity(HUNK_CACHE_SIZE / hunk_size);
+		}
+		s_hunk_cache.Insert(key, std::move(data));
+	}
+
 	return hunk_size;
 }
 
+ChdFileReader::HunkCacheStats ChdFileReader::GetHunkCacheStats()
+{
+	HunkCacheStats stats;
+	stats.hits = s_hunk_cache_hits.load(std::memory_order_relaxed);
+	stats.misses = s_hunk_cache_misses.load(std::memory_order_relaxed);
+
+	std::unique_lock lock(s_hunk_cache_mutex);
+	stats.size = static_cast<u64>(s_hunk_cache.GetSize()) * s_hunk_cache_max_hunk_size;
+	return stats;
+}
+
+bool ChdFileReader::OpenWorkerContexts(u32 count)
+{
+	// Workers would go back to the disk, which is what precaching is trying to avoid.
+	if (precached)
+		return false;
+
+	// libchdr decompressors are per-file, so each worker needs its own handle.
+	for (u32 i = 0; i < count; i++)
+	{
+		auto fp = FileSystem::OpenManagedSharedCFile(m_filename.c_str(), "rb", FileSystem::FileShareMode::DenyWrite);
+		chd_file* chd = fp ? OpenCHD(m_filename, std::move(fp), nullptr, 0) : nullptr;
+		if (!chd)
+		{
+			CloseWorkerContexts();
+			return false;
+		}
+
+		WorkerChdFiles.push_back(chd);
+	}
+
+	return true;
+}
+
+void ChdFileReader::CloseWorkerContexts()
+{
+	for (chd_file* chd : WorkerChdFiles)
+		chd_close(chd);
+	WorkerChdFiles.clear();
+}
+
+int ChdFileReader::ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker)
+{
+	if (chunkID < 0)
+		return -1;
+
+	return ReadHunk(WorkerChdFiles[worker], dst, chunkID);
+}
+
 void ChdFileReader::Close2()
 {
 	if (ChdFile)
 	{
+		const u64 hits = hunk_cache_hits.load(std::memory_order_relaxed);
+		const u64 misses = hunk_cache_misses.load(std::memory_order_relaxed);
+		if (hits + misses > 0)
+		{
+			const HunkCacheStats stats = GetHunkCacheStats();
+			DEV_LOG("CHD hunk cache: {} hits, {} misses for '{}' ({} hits, {} misses, {} KB held overall)", hits, misses,
+				Path::GetFileName(m_filename), stats.hits, stats.misses, stats.size / 1024);
+		}
+
 		chd_close(ChdFile);
 		ChdFile = nullptr;
 	}
+
+	precached = false;
 }
 
 u32 ChdFileReader::GetBlockCount() const
@@ -3,6 +3,8 @@
 
 #pragma once
 #include "ThreadedFileReader.h"
+#include <array>
+#include <atomic>
 #include <vector>
 
 typedef struct _chd_file chd_file;
@@ -12,6 +14,26 @@ class ChdFileReader final : public ThreadedFileReader
 	DeclareNoncopyableObject(ChdFileReader);
 
 public:
+	struct HunkCacheStats
+	{
+		u64 hits;
+		u64 misses;
+		/// Bytes of decompressed hunks currently held
+		u64 size;
+	};
+
+	/// While alive, CHDs opened on the current thread read straight from the file instead of the shared hunk
+	/// cache. Used when hashing/verifying, where hunks cached by SHA1 could hide corruption on disk.
+	class ScopedHunkCacheBypass
+	{
+	public:
+		ScopedHunkCacheBypass();
+		~ScopedHunkCacheBypass();
+
+	private:
+		bool m_prev;
+	};
+
 	ChdFileReader();
 	~ChdFileReader() override;
 
@@ -22,13 +44,31 @@ public:
 	Chunk ChunkForOffset(u64 offset) override;
 	int ReadChunk(void* dst, s64 blockID) override;
 
+	bool OpenWorkerContexts(u32 count) override;
+	void CloseWorkerContexts() override;
+	int ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker) override;
+
 	void Close2(void) override;
 	uint GetBlockCount(void) const override;
 
+	/// Statistics for the decompressed hunk cache shared by every CHD reader in the process
+	static HunkCacheStats GetHunkCacheStats();
+
 private:
 	bool ParseTOC(u64* out_frame_count);
 
+	/// Reads a hunk through the shared cache, decompressing with `chd` on a miss
+	int ReadHunk(chd_file* chd, void* dst, s64 hunk);
+
 	chd_file* ChdFile = nullptr;
+	std::vector<chd_file*> WorkerChdFiles;
 	u64 file_size = 0;
 	u32 hunk_size = 0;
+	bool precached = false;
+
+	/// Overall SHA1 from the CHD header, identifies the contents in the shared hunk cache regardless of path
+	std::array<u8, 20> sha1 = {};
+	bool use_hunk_cache = false;
+	std::atomic<u64> hunk_cache_hits{0};
+	std::atomic<u64> hunk_cache_misses{0};
 };
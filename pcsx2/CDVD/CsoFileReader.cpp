@@ -145,15 +145,7 @@ bool CsoFileReader::InitializeBuffers(Error* error)
 	// Round up, since part of a frame requires a full frame.
 	u32 numFrames = (u32)((m_totalSize + m_frameSize - 1) / m_frameSize);
 
-	// We might read a bit of alignment too, so be prepared.
-	if (m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
-	{
-		m_readBuffer = std::make_unique<u8[]>(CSO_READ_BUFFER_SIZE);
-	}
-	else
-	{
-		m_readBuffer = std::make_unique<u8[]>(m_frameSize + (1 << m_indexShift));
-	}
+	m_readBuffer = std::make_unique<u8[]>(GetReadBufferSize());
 
 	const u32 indexSize = numFrames + 1;
 	m_index = std::make_unique<u32[]>(indexSize);
@@ -176,6 +168,57 @@ bool CsoFileReader::InitializeBuffers(Error* error)
 	return true;
 }
 
+u32 CsoFileReader::GetReadBufferSize() const
+{
+	// We might read a bit of alignment too, so be prepared.
+	return std::max<u32>(CSO_READ_BUFFER_SIZE, m_frameSize + (1 << m_indexShift));
+}
+
+bool CsoFileReader::OpenWorkerContexts(u32 count)
+{
+	m_workers.resize(count);
+	for (WorkerContext& ctx : m_workers)
+	{
+		// Each worker gets its own handle so seeks don't interfere, unless everything's in memory already.
+		if (!m_file_cache && !(ctx.src = FileSystem::OpenCFile(m_filename.c_str(), "rb")))
+		{
+			CloseWorkerContexts();
+			return false;
+		}
+
+		ctx.readBuffer = std::make_unique<u8[]>(GetReadBufferSize());
+		if (!m_uselz4 && inflateInit2(&ctx.zstream, -15) != Z_OK)
+		{
+			ctx.zstream = {};
+			CloseWorkerContexts();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CsoFileReader::CloseWorkerContexts()
+{
+	for (WorkerContext& ctx : m_workers)
+	{
+		if (ctx.src)
+			std::fclose(ctx.src);
+		if (!m_uselz4 && ctx.zstream.state)
+			inflateEnd(&ctx.zstream);
+	}
+	m_workers.clear();
+}
+
+int CsoFileReader::ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker)
+{
+	if (chunkID < 0)
+		return -1;
+
+	WorkerContext& ctx = m_workers[worker];
+	return ReadFrame(dst, static_cast<u32>(chunkID), ctx.src, ctx.readBuffer.get(), &ctx.zstream);
+}
+
 void CsoFileReader::Close2()
 {
 	m_filename.clear();
@@ -220,8 +263,11 @@ int CsoFileReader::ReadChunk(void* dst, s64 chunkID)
 	if (chunkID < 0)
 		return -1;
 
-	const u32 frame = chunkID;
+	return ReadFrame(dst, static_cast<u32>(chunkID), m_src, m_readBuffer.get(), &m_z_stream);
+}
 
+int CsoFileReader::ReadFrame(void* dst, u32 frame, std::FILE* src, u8* readBuffer, z_stream* zs)
+{
 	// Grab the index data for the frame we're about to read.
 	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
 	const u32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
@@ -244,19 +290,18 @@ int CsoFileReader::ReadChunk(void* dst, s64 chunkID)
 		}
 
 		// Just read directly, easy.
-		if (FileSystem::FSeek64(m_src, frameRawPos, SEEK_SET) != 0)
+		if (FileSystem::FSeek64(src, frameRawPos, SEEK_SET) != 0)
 		{
 			Console.Error("Unable to seek to uncompressed CSO data.");
 			return 0;
 		}
-		return fread(dst, 1, m_frameSize, m_src);
+		return fread(dst, 1, m_frameSize, src);
 	}
 	else
 	{
 		// This might be less bytes than frameRawSize in case of padding on the last frame.
 		// This is because the index positions must be aligned.
 		u32 readRawBytes;
-		u8* readBuffer;
 		if (m_file_cache)
 		{
 			if (frameRawPos >= m_file_cache_size)
@@ -267,13 +312,12 @@ int CsoFileReader::ReadChunk(void* dst, s64 chunkID)
 		}
 		else
 		{
-			if (FileSystem::FSeek64(m_src, frameRawPos, SEEK_SET) != 0)
+			if (FileSystem::FSeek64(src, frameRawPos, SEEK_SET) != 0)
 			{
 				Console.Error("Unable to seek to compressed CSO data.");
 				return 0;
 			}
-			readBuffer = m_readBuffer.get();
-			readRawBytes = fread(m_readBuffer.get(), 1, frameRawSize, m_src);
+			readRawBytes = fread(readBuffer, 1, frameRawSize, src);
 		}
 
 		bool success = false;
@@ -290,20 +334,20 @@ int CsoFileReader::ReadChunk(void* dst, s64 chunkID)
 		}
 		else
 		{
-			m_z_stream.next_in = readBuffer;
-			m_z_stream.avail_in = readRawBytes;
-			m_z_stream.next_out = static_cast<Bytef*>(dst);
-			m_z_stream.avail_out = m_frameSize;
+			zs->next_in = readBuffer;
+			zs->avail_in = readRawBytes;
+			zs->next_out = static_cast<Bytef*>(dst);
+			zs->avail_out = m_frameSize;
 
-			const int status = inflate(&m_z_stream, Z_FINISH);
-			success = (status == Z_STREAM_END && m_z_stream.total_out == m_frameSize);
+			const int status = inflate(zs, Z_FINISH);
+			success = (status == Z_STREAM_END && zs->total_out == m_frameSize);
 		}
 
 		if (!success)
 			Console.Error(fmt::format("Unable to decompress CSO frame using {}", (m_uselz4)? "lz4":"zlib"));
 		
 		if (!m_uselz4)
-			inflateReset(&m_z_stream);
+			inflateReset(zs);
 
 		return success ? m_frameSize : 0;
 	}
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "ThreadedFileReader.h"
+#include <vector>
 #include <zlib.h>
 
 struct CsoHeader;
@@ -23,14 +24,27 @@ public:
 	Chunk ChunkForOffset(u64 offset) override;
 	int ReadChunk(void* dst, s64 chunkID) override;
 
+	bool OpenWorkerContexts(u32 count) override;
+	void CloseWorkerContexts() override;
+	int ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker) override;
+
 	void Close2() override;
 
 	u32 GetBlockCount() const override;
 
 private:
+	struct WorkerContext
+	{
+		std::FILE* src = nullptr;
+		std::unique_ptr<u8[]> readBuffer;
+		z_stream zstream = {};
+	};
+
 	static bool ValidateHeader(const CsoHeader& hdr, Error* error);
 	bool ReadFileHeader(Error* error);
 	bool InitializeBuffers(Error* error);
+	u32 GetReadBufferSize() const;
+	int ReadFrame(void* dst, u32 frame, std::FILE* src, u8* readBuffer, z_stream* zs);
 	int ReadFromFrame(u8* dest, u64 pos, int maxBytes);
 	bool DecompressFrame(Bytef* dst, u32 frame, u32 readBufferSize);
 	bool DecompressFrame(u32 frame, u32 readBufferSize);
@@ -48,4 +62,5 @@ private:
 	std::unique_ptr<u8[]> m_file_cache;
 	size_t m_file_cache_size = 0;
 	z_stream m_z_stream = {};
+	std::vector<WorkerContext> m_workers;
 };
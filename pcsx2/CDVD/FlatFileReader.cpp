@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0+
 
 #include "FlatFileReader.h"
+#include "Config.h"
 
 #include "common/Assertions.h"
 #include "common/Console.h"
@@ -13,6 +14,12 @@
 
 static constexpr size_t CHUNK_SIZE = 128 * 1024;
 
+// CDVD reads a sector or two at a time, this many reads in a row means the drive is streaming (FMVs, audio, level loads)
+static constexpr u32 STREAM_THRESHOLD = 8;
+
+// While streaming, keep this much of the image ahead of the read position on its way into the page cache
+static constexpr u64 STREAM_READAHEAD = 4 * 1024 * 1024;
+
 FlatFileReader::FlatFileReader() = default;
 
 FlatFileReader::~FlatFileReader()
@@ -35,6 +42,27 @@ bool FlatFileReader::Open2(std::string filename, Error* error)
 	}
 
 	m_file_size = static_cast<u64>(filesize);
+
+	// Reads can then be copied straight out of the page cache, without a seek+read per chunk or the chunk cache
+	if (EmuConfig.CdvdMapFiles)
+	{
+		Error map_error;
+		if (m_mapping.Open(m_filename.c_str(), &map_error) && m_mapping.GetSize() == m_file_size)
+		{
+			m_directData = m_mapping.GetData();
+			m_directSize = m_file_size;
+		}
+		else
+		{
+			WARNING_LOG("Failed to map '{}', falling back to file reads: {}", m_filename, map_error.GetDescription());
+			m_mapping.Close();
+		}
+	}
+
+	m_last_read_end = 0;
+	m_sequential_reads = 0;
+	m_advised_end = 0;
+	m_streaming = false;
 	return true;
 }
 
@@ -54,6 +82,11 @@ bool FlatFileReader::Precache2(ProgressCallback* progress, Error* error)
 
 	std::fclose(m_file);
 	m_file = nullptr;
+
+	// Everything's in memory now, the mapping isn't needed anymore
+	m_mapping.Close();
+	m_directData = m_file_cache.get();
+	m_directSize = m_file_size;
 	return true;
 }
 
@@ -98,14 +131,61 @@ int FlatFileReader::ReadChunk(void* dst, s64 blockID)
 	return (std::fread(dst, read_size, 1, m_file) == 1) ? static_cast<int>(read_size) : 0;
 }
 
+void FlatFileReader::OnDirectRead(u64 offset, u32 size)
+{
+	if (!m_mapping.IsOpen())
+		return;
+
+	if (offset == m_last_read_end)
+	{
+		if (m_sequential_reads < STREAM_THRESHOLD)
+			m_sequential_reads++;
+	}
+	else
+	{
+		// Seeked elsewhere, stop reading ahead and let the OS go back to its usual heuristics
+		if (m_streaming)
+		{
+			m_mapping.Advise(0, m_file_size, FileSystem::MappedFile::AccessPattern::Normal);
+			m_streaming = false;
+		}
+		m_sequential_reads = 0;
+		m_advised_end = 0;
+	}
+
+	m_last_read_end = offset + size;
+	if (m_sequential_reads < STREAM_THRESHOLD)
+		return;
+
+	if (!m_streaming)
+	{
+		m_mapping.Advise(0, m_file_size, FileSystem::MappedFile::AccessPattern::Sequential);
+		m_streaming = true;
+	}
+
+	// Top the readahead up every half window, rather than making a call per sector
+	if (m_last_read_end + STREAM_READAHEAD / 2 >= m_advised_end && m_advised_end < m_file_size)
+	{
+		const u64 start = std::max(m_advised_end, m_last_read_end);
+		const u64 end = std::min(m_last_read_end + STREAM_READAHEAD, m_file_size);
+		m_mapping.Advise(start, end - start, FileSystem::MappedFile::AccessPattern::WillNeed);
+		m_advised_end = end;
+	}
+}
+
 void FlatFileReader::Close2()
 {
+	m_directData = nullptr;
+	m_directSize = 0;
+	m_mapping.Close();
+	m_file_cache.reset();
+	m_file_size = 0;
+
 	if (!m_file)
 		return;
 
 	std::fclose(m_file);
 	m_file = nullptr;
-	m_file_size = 0;
 }
 
 u32 FlatFileReader::GetBlockCount() const
@@ -5,6 +5,8 @@
 
 #include "CDVD/ThreadedFileReader.h"
 
+#include "common/FileSystem.h"
+
 #include <cstdio>
 
 class FlatFileReader final : public ThreadedFileReader
@@ -15,6 +17,14 @@ class FlatFileReader final : public ThreadedFileReader
 	std::unique_ptr<u8[]> m_file_cache;
 	u64 m_file_size = 0;
 
+	FileSystem::MappedFile m_mapping;
+	/// End of the previous read and how many reads in a row have carried on from it
+	u64 m_last_read_end = 0;
+	u32 m_sequential_reads = 0;
+	/// How far ahead of the read position we've already asked the OS to read in
+	u64 m_advised_end = 0;
+	bool m_streaming = false;
+
 public:
 	FlatFileReader();
 	~FlatFileReader() override;
@@ -25,6 +35,7 @@ public:
 
 	Chunk ChunkForOffset(u64 offset) override;
 	int ReadChunk(void* dst, s64 blockID) override;
+	void OnDirectRead(u64 offset, u32 size) override;
 
 	void Close2() override;
 
@@ -6,86 +6,44 @@
 #include "Host.h"
 #include "CDVD/zlib_indexed.h"
 
+#include "common/Assertions.h"
 #include "common/Console.h"
 #include "common/FileSystem.h"
 #include "common/Error.h"
 #include "common/Path.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
 #include "common/Timer.h"
 
 #include "fmt/format.h"
 
-#define GZIP_ID "PCSX2.index.gzip.v1|"
-#define GZIP_ID_LEN (sizeof(GZIP_ID) - 1) /* sizeof includes the \0 terminator */
+#include <algorithm>
 
-// File format is:
-// - [GZIP_ID_LEN] GZIP_ID (no \0)
-// - [sizeof(Access)] index (should be allocated, contains various sizes)
-// - [rest] the indexed data points (should be allocated, index->list should then point to it)
-static Access* ReadIndexFromFile(const char* filename)
-{
-	auto fp = FileSystem::OpenManagedCFile(filename, "rb");
-	if (!fp)
-		return nullptr;
-
-	s64 size;
-	if ((size = FileSystem::FSize64(fp.get())) <= 0)
-	{
-		ERROR_LOG("Invalid gzip index size: {}", size);
-		return nullptr;
-	}
-
-	char fileId[GZIP_ID_LEN + 1] = {0};
-	if (std::fread(fileId, GZIP_ID_LEN, 1, fp.get()) != 1 || std::memcmp(fileId, GZIP_ID, 4) != 0)
-	{
-		ERROR_LOG("Incompatible gzip index: '{}'", filename);
-		return nullptr;
-	}
-
-	Access* const index = static_cast<Access*>(std::malloc(sizeof(Access)));
-	const s64 datasize = size - GZIP_ID_LEN - sizeof(Access);
-	if (std::fread(index, sizeof(Access), 1, fp.get()) != 1 ||
-		datasize != static_cast<s64>(index->have) * static_cast<s64>(sizeof(Point)))
-	{
-		ERROR_LOG("Unexpected size of gzip index: '{}'.", filename);
-		std::free(index);
-		return 0;
-	}
+// Index file format is:
+// - [sizeof(GzipIndexHeader)] header, including the size and timestamp of the .gz it was built from
+// - [num_points * sizeof(IndexPoint)] access points
+// - [windows_size] access point windows, each one deflated on its own
+// It's used straight out of a read-only mapping, windows are only inflated when a read starts from that point.
+static constexpr char GZIP_INDEX_MAGIC[8] = {'P', 'C', 'S', 'X', '2', 'G', 'Z', 'I'};
+static constexpr u32 GZIP_INDEX_VERSION = 2;
 
-	char* buffer = static_cast<char*>(std::malloc(datasize));
-	if (std::fread(buffer, datasize, 1, fp.get()) != 1)
-	{
-		ERROR_LOG("Failed read of gzip index: '{}'.");
-		std::free(buffer);
-		std::free(index);
-		return 0;
-	}
+// Returned from the build callbacks when the reader is closed before the index is finished.
+static constexpr int GZIP_INDEX_CANCELLED = -100;
 
-	index->list = reinterpret_cast<Point*>(buffer); // adjust list pointer
-	return index;
-}
+// compressBound(WINSIZE), which isn't constexpr.
+static constexpr uLong GZIP_INDEX_WINDOW_BOUND = WINSIZE + (WINSIZE >> 12) + (WINSIZE >> 14) + (WINSIZE >> 25) + 13;
 
-static void WriteIndexToFile(Access* index, const char* filename)
+struct GzipIndexHeader
 {
-	auto fp = FileSystem::OpenManagedCFile(filename, "wb");
-	if (!fp)
-		return;
-
-	bool success = (std::fwrite(GZIP_ID, GZIP_ID_LEN, 1, fp.get()) == 1);
-
-	Point* tmp = index->list;
-	index->list = 0; // current pointer is useless on disk, normalize it as 0.
-	std::fwrite((char*)index, sizeof(Access), 1, fp.get());
-	index->list = tmp;
-
-	success = success && (std::fwrite((char*)index->list, sizeof(Point) * index->have, 1, fp.get()) == 1);
-
-	// Verify
-	if (!success)
-		ERROR_LOG("Warning: Can't write index file to disk: '{}'", filename);
-	else
-		INFO_LOG("Gzip quick access index file saved to disk: '{}'", filename);
-}
+	char magic[8];
+	u32 version;
+	u32 num_points;
+	s64 span;
+	s64 uncompressed_size;
+	s64 compressed_size;
+	s64 compressed_mtime;
+	u64 windows_size;
+};
 
 static const char* INDEX_TEMPLATE_KEY = "$(f)";
 
@@ -136,7 +94,223 @@ static std::string iso2indexname(const std::string& isoname, Error* error)
 
 GzippedFileReader::GzippedFileReader() = default;
 
-GzippedFileReader::~GzippedFileReader() = default;
+GzippedFileReader::~GzippedFileReader()
+{
+	pxAssert(!m_index_thread.joinable());
+}
+
+bool GzippedFileReader::LoadIndexFile(const std::string& indexfile)
+{
+	FileSystem::MappedFile file;
+	if (!file.Open(indexfile.c_str()))
+		return false;
+
+	GzipIndexHeader header;
+	if (file.GetSize() < sizeof(header))
+	{
+		ERROR_LOG("Invalid gzip index size: {}", file.GetSize());
+		return false;
+	}
+
+	std::memcpy(&header, file.GetData(), sizeof(header));
+	if (std::memcmp(header.magic, GZIP_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != GZIP_INDEX_VERSION)
+	{
+		WARNING_LOG("Incompatible gzip index, it will be rebuilt: '{}'", indexfile);
+		return false;
+	}
+
+	if (header.compressed_size != m_compressed_size || header.compressed_mtime != m_compressed_mtime)
+	{
+		WARNING_LOG("Gzip index is out of date, it will be rebuilt: '{}'", indexfile);
+		return false;
+	}
+
+	const u64 points_size = static_cast<u64>(header.num_points) * sizeof(IndexPoint);
+	if (header.num_points == 0 || sizeof(header) + points_size + header.windows_size != file.GetSize())
+	{
+		ERROR_LOG("Unexpected size of gzip index: '{}'.", indexfile);
+		return false;
+	}
+
+	const IndexPoint* points = reinterpret_cast<const IndexPoint*>(file.GetData() + sizeof(header));
+	for (u32 i = 0; i < header.num_points; i++)
+	{
+		if (points[i].window_offset + points[i].window_size > header.windows_size || (i > 0 && points[i].out <= points[i - 1].out))
+		{
+			ERROR_LOG("Corrupted gzip index: '{}'.", indexfile);
+			return false;
+		}
+	}
+
+	m_points = points;
+	m_windows = file.GetData() + sizeof(header) + points_size;
+	m_num_points = header.num_points;
+	m_index_uncompressed_size = header.uncompressed_size;
+	m_uncompressed_size = header.uncompressed_size;
+	m_index_complete = true;
+	m_index_file = std::move(file);
+	return true;
+}
+
+void GzippedFileReader::WriteIndexFile(const std::string& indexfile)
+{
+	GzipIndexHeader header = {};
+	std::memcpy(header.magic, GZIP_INDEX_MAGIC, sizeof(header.magic));
+	header.version = GZIP_INDEX_VERSION;
+	header.num_points = m_num_points;
+	header.span = GZFILE_SPAN_DEFAULT;
+	header.uncompressed_size = m_index_uncompressed_size;
+	header.compressed_size = m_compressed_size;
+	header.compressed_mtime = m_compressed_mtime;
+	header.windows_size = m_built_windows.size();
+
+	auto fp = FileSystem::OpenManagedCFile(indexfile.c_str(), "wb");
+	const bool success = fp &&
+						 std::fwrite(&header, sizeof(header), 1, fp.get()) == 1 &&
+						 std::fwrite(m_built_points.data(), sizeof(IndexPoint), m_built_points.size(), fp.get()) == m_built_points.size() &&
+						 std::fwrite(m_built_windows.data(), m_built_windows.size(), 1, fp.get()) == 1 &&
+						 std::fflush(fp.get()) == 0;
+
+	// Verify
+	if (!success)
+	{
+		ERROR_LOG("Warning: Can't write index file to disk: '{}'", indexfile);
+		fp.reset();
+		FileSystem::DeleteFilePath(indexfile.c_str());
+	}
+	else
+	{
+		INFO_LOG("Gzip quick access index file saved to disk: '{}'", indexfile);
+	}
+}
+
+bool GzippedFileReader::EstimateUncompressedSize(s64* size)
+{
+	// The gzip trailer only has the size modulo 4GB, which isn't enough for DVDs.
+	// So get a rough size from the ISO9660 volume descriptor, and use that to pick the right multiple.
+	u8 trailer[4];
+	if (m_compressed_size < 18 || FileSystem::FSeek64(m_src, m_compressed_size - 4, SEEK_SET) != 0 ||
+		std::fread(trailer, sizeof(trailer), 1, m_src) != 1)
+	{
+		return false;
+	}
+	const u32 isize = static_cast<u32>(trailer[0]) | (static_cast<u32>(trailer[1]) << 8) |
+					  (static_cast<u32>(trailer[2]) << 16) | (static_cast<u32>(trailer[3]) << 24);
+
+	// Sector 16 of the largest sector size we detect, plus the descriptor itself.
+	static constexpr u32 HEAD_SIZE = 17 * 2448;
+	std::unique_ptr<u8[]> head = std::make_unique<u8[]>(HEAD_SIZE);
+	std::unique_ptr<u8[]> input = std::make_unique<u8[]>(CHUNK);
+	if (FileSystem::FSeek64(m_src, 0, SEEK_SET) != 0)
+		return false;
+
+	z_stream strm = {};
+	if (inflateInit2(&strm, 47) != Z_OK)
+		return false;
+	strm.next_out = head.get();
+	strm.avail_out = HEAD_SIZE;
+	int ret = Z_OK;
+	while (strm.avail_out > 0 && ret == Z_OK)
+	{
+		if (strm.avail_in == 0)
+		{
+			strm.avail_in = static_cast<uInt>(std::fread(input.get(), 1, CHUNK, m_src));
+			strm.next_in = input.get();
+			if (strm.avail_in == 0)
+				break;
+		}
+		ret = inflate(&strm, Z_NO_FLUSH);
+	}
+	const u32 head_size = HEAD_SIZE - strm.avail_out;
+	inflateEnd(&strm);
+
+	// Same layouts as InputIsoFile::Detect(), as (sector size, offset of user data in the sector).
+	static constexpr std::pair<u32, u32> layouts[] = {{2048, 0}, {2336, 8}, {2352, 24}, {2448, 24}};
+	for (const auto& [sector_size, data_offset] : layouts)
+	{
+		const u32 pvd = 16 * sector_size + data_offset;
+		if (pvd + 84 > head_size || head[pvd] != 1 || std::memcmp(&head[pvd + 1], "CD001", 5) != 0)
+			continue;
+
+		u32 volume_blocks;
+		std::memcpy(&volume_blocks, &head[pvd + 80], sizeof(volume_blocks));
+		const s64 estimate = static_cast<s64>(volume_blocks) * sector_size;
+		const s64 multiple = std::max<s64>((estimate - static_cast<s64>(isize) + (1LL << 31)) >> 32, 0);
+		*size = static_cast<s64>(isize) + (multiple << 32);
+		return true;
+	}
+
+	return false;
+}
+
+int GzippedFileReader::AddIndexPoint(void* ctx, int bits, s64 in, s64 out, unsigned left, unsigned char* window)
+{
+	GzippedFileReader* reader = static_cast<GzippedFileReader*>(ctx);
+
+	u8 linear_window[WINSIZE];
+	copy_window(linear_window, left, window);
+
+	uLongf compressed_size = GZIP_INDEX_WINDOW_BOUND;
+	u8 compressed_window[GZIP_INDEX_WINDOW_BOUND];
+	if (compress2(compressed_window, &compressed_size, linear_window, WINSIZE, Z_BEST_SPEED) != Z_OK)
+		return Z_MEM_ERROR;
+
+	std::unique_lock lock(reader->m_index_mutex);
+	IndexPoint& point = reader->m_built_points.emplace_back();
+	point.out = out;
+	point.in = in;
+	point.window_offset = reader->m_built_windows.size();
+	point.window_size = static_cast<u32>(compressed_size);
+	point.bits = static_cast<u32>(bits);
+	reader->m_built_windows.insert(reader->m_built_windows.end(), compressed_window, compressed_window + compressed_size);
+
+	reader->m_points = reader->m_built_points.data();
+	reader->m_windows = reader->m_built_windows.data();
+	reader->m_num_points = static_cast<u32>(reader->m_built_points.size());
+	lock.unlock();
+
+	reader->m_index_cv.notify_all();
+	return 0;
+}
+
+int GzippedFileReader::CheckIndexCancelled(void* ctx, s64 in, s64 out)
+{
+	return static_cast<GzippedFileReader*>(ctx)->m_index_cancel.load(std::memory_order_relaxed) ? GZIP_INDEX_CANCELLED : 0;
+}
+
+bool GzippedFileReader::BuildIndex(std::FILE* fp, const std::string& indexfile)
+{
+	Common::Timer timer;
+	s64 uncompressed_size = 0;
+	const int ret = build_index_with(fp, GZFILE_SPAN_DEFAULT, &GzippedFileReader::AddIndexPoint,
+		&GzippedFileReader::CheckIndexCancelled, this, &uncompressed_size);
+
+	{
+		std::unique_lock lock(m_index_mutex);
+		m_index_uncompressed_size = (ret > 0) ? uncompressed_size : 0;
+		m_index_complete = true;
+	}
+	m_index_cv.notify_all();
+
+	if (ret == GZIP_INDEX_CANCELLED)
+		return false;
+
+	if (ret <= 0)
+	{
+		ERROR_LOG("ERROR ({}): Index could not be generated for file '{}'", ret, m_filename);
+		return false;
+	}
+
+	INFO_LOG("Gzip quick access index with {} points built in {:.2f} seconds.", ret, timer.GetTimeSeconds());
+	if (uncompressed_size != m_uncompressed_size)
+	{
+		WARNING_LOG("Gzip uncompressed size {} doesn't match the estimate of {}, disc size may be incorrect.",
+			uncompressed_size, m_uncompressed_size);
+	}
+
+	WriteIndexFile(indexfile);
+	return true;
+}
 
 bool GzippedFileReader::LoadOrCreateIndex(Error* error)
 {
@@ -148,33 +322,50 @@ bool GzippedFileReader::LoadOrCreateIndex(Error* error)
 		return false;
 	}
 
-	if ((m_index = ReadIndexFromFile(indexfile.c_str())) != nullptr)
+	FILESYSTEM_STAT_DATA sd;
+	if (!FileSystem::StatFile(m_src, &sd))
+	{
+		Error::SetStringFmt(error, "Failed to stat '{}'", m_filename);
+		return false;
+	}
+	m_compressed_size = sd.Size;
+	m_compressed_mtime = static_cast<s64>(sd.ModificationTime);
+
+	if (LoadIndexFile(indexfile))
 	{
 		INFO_LOG("Gzip quick access index read from disk: '{}'", indexfile);
 		return true;
 	}
 
-	// No valid index file. Generate an index
-	Console.Warning("This may take a while (but only once). Scanning compressed file to generate a quick access index...");
-
-	const s64 prevoffset = FileSystem::FTell64(m_src);
-	Access* index = nullptr;
-	int len = build_index(m_src, GZFILE_SPAN_DEFAULT, &index);
-	printf("\n"); // build_index prints progress without \n's
-	FileSystem::FSeek64(m_src, prevoffset, SEEK_SET);
+	// No valid index file. Generate one, using a separate handle since the read thread owns m_src.
+	std::FILE* fp = FileSystem::OpenCFile(m_filename.c_str(), "rb", error);
+	if (!fp)
+		return false;
 
-	if (len >= 0)
+	m_index_cancel.store(false, std::memory_order_relaxed);
+	if (EstimateUncompressedSize(&m_uncompressed_size))
 	{
-		m_index = index;
-		WriteIndexToFile(m_index, indexfile.c_str());
+		// Reads wait for the builder to get past them, so the game can boot while the rest of the file is scanned.
+		INFO_LOG("Building gzip quick access index in the background...");
+		m_index_thread = std::thread([this, fp, indexfile]() {
+			Threading::SetNameOfCurrentThread("Gzip Indexer");
+			BuildIndex(fp, indexfile);
+			std::fclose(fp);
+		});
+		return true;
 	}
-	else
+
+	// Not an ISO we recognise, so we can't know the size until we've been through the whole thing.
+	Console.Warning("This may take a while (but only once). Scanning compressed file to generate a quick access index...");
+	const bool result = BuildIndex(fp, indexfile);
+	std::fclose(fp);
+	if (!result)
 	{
-		Error::SetStringFmt(error, "ERROR ({}): Index could not be generated for file '{}'", len, m_filename);
-		free_index(index);
+		Error::SetStringFmt(error, "Index could not be generated for file '{}'", m_filename);
 		return false;
 	}
 
+	m_uncompressed_size = m_index_uncompressed_size;
 	return true;
 }
 
@@ -194,6 +385,12 @@ bool GzippedFileReader::Open2(std::string filename, Error* error)
 
 void GzippedFileReader::Close2()
 {
+	if (m_index_thread.joinable())
+	{
+		m_index_cancel.store(true, std::memory_order_relaxed);
+		m_index_thread.join();
+	}
+
 	if (m_z_state.isValid)
 	{
 		inflateEnd(&m_z_state.strm);
@@ -206,41 +403,143 @@ void GzippedFileReader::Close2()
 		m_src = nullptr;
 	}
 
-	if (m_index)
-	{
-		free_index(m_index);
-		m_index = nullptr;
-	}
+	m_index_file.Close();
+	m_built_points = {};
+	m_built_windows = {};
+	m_points = nullptr;
+	m_windows = nullptr;
+	m_num_points = 0;
+	m_index_uncompressed_size = 0;
+	m_index_complete = false;
+	m_uncompressed_size = 0;
+}
+
+s64 GzippedFileReader::GetChunkEnd(u32 chunkID, std::unique_lock<std::mutex>& lock)
+{
+	// Chunks run from one access point to the next, so wait until the builder has found the next one.
+	while (!m_index_complete && chunkID + 1 >= m_num_points)
+		m_index_cv.wait(lock);
+
+	return (chunkID + 1 < m_num_points) ? m_points[chunkID + 1].out : m_index_uncompressed_size;
 }
 
 ThreadedFileReader::Chunk GzippedFileReader::ChunkForOffset(u64 offset)
 {
 	ThreadedFileReader::Chunk chunk = {};
-	if (static_cast<s64>(offset) >= m_index->uncompressed_size)
+	if (static_cast<s64>(offset) >= m_uncompressed_size)
 	{
 		chunk.chunkID = -1;
+		return chunk;
 	}
-	else
+
+	std::unique_lock lock(m_index_mutex);
+
+	// Don't pick a point until the builder is past the offset, a closer one may still turn up.
+	while (!m_index_complete && (m_num_points == 0 || m_points[m_num_points - 1].out <= static_cast<s64>(offset)))
+		m_index_cv.wait(lock);
+
+	const IndexPoint* it = std::upper_bound(m_points, m_points + m_num_points, static_cast<s64>(offset),
+		[](s64 value, const IndexPoint& point) { return value < point.out; });
+	if (it == m_points)
+	{
+		chunk.chunkID = -1;
+		return chunk;
+	}
+
+	const u32 index = static_cast<u32>(it - m_points) - 1;
+	const s64 end = GetChunkEnd(index, lock);
+	if (end <= m_points[index].out)
 	{
-		chunk.chunkID = static_cast<s64>(offset) / m_index->span;
-		chunk.length = m_index->span;
-		chunk.offset = static_cast<u64>(chunk.chunkID) * m_index->span;
+		// The last chunk has no known end when a background index build failed part way through.
+		chunk.chunkID = -1;
+		return chunk;
 	}
 
+	chunk.chunkID = index;
+	chunk.offset = static_cast<u64>(m_points[index].out);
+	chunk.length = static_cast<u32>(end - m_points[index].out);
 	return chunk;
 }
 
-int GzippedFileReader::ReadChunk(void* dst, s64 chunkID)
+int GzippedFileReader::ExtractChunk(void* dst, s64 chunkID, std::FILE* src, zstate* state)
 {
 	if (chunkID < 0)
 		return -1;
 
-	const s64 file_offset = chunkID * m_index->span;
-	const u32 read_len = static_cast<u32>(std::min<s64>(m_index->uncompressed_size - file_offset, m_index->span));
-	return extract(m_src, m_index, file_offset, static_cast<unsigned char*>(dst), read_len, &m_z_state);
+	IndexPoint point;
+	s64 end;
+	std::vector<u8> compressed_window;
+	{
+		std::unique_lock lock(m_index_mutex);
+		if (static_cast<u64>(chunkID) >= m_num_points)
+			return -1;
+
+		point = m_points[chunkID];
+		end = GetChunkEnd(static_cast<u32>(chunkID), lock);
+
+		// Sequential reads carry on from the previous chunk without needing the window.
+		if (!state->isValid || state->out_offset != point.out)
+			compressed_window.assign(m_windows + point.window_offset, m_windows + point.window_offset + point.window_size);
+	}
+
+	u8 window[WINSIZE];
+	if (!compressed_window.empty())
+	{
+		uLongf window_size = WINSIZE;
+		if (uncompress(window, &window_size, compressed_window.data(), static_cast<uLong>(compressed_window.size())) != Z_OK ||
+			window_size != WINSIZE)
+		{
+			ERROR_LOG("Failed to decompress gzip index window for chunk {}", chunkID);
+			return -1;
+		}
+	}
+
+	const int len = static_cast<int>(end - point.out);
+	return extract_from(src, point.out, point.in, static_cast<int>(point.bits), window, point.out,
+		static_cast<unsigned char*>(dst), len, state);
+}
+
+int GzippedFileReader::ReadChunk(void* dst, s64 chunkID)
+{
+	return ExtractChunk(dst, chunkID, m_src, &m_z_state);
+}
+
+bool GzippedFileReader::OpenWorkerContexts(u32 count)
+{
+	// The index is shared, so workers only need their own file handle and inflate state.
+	// Each chunk starts at an access point, so random seeks inflate in parallel without skipping any data.
+	m_workers.resize(count);
+	for (WorkerContext& ctx : m_workers)
+	{
+		if (!(ctx.src = FileSystem::OpenCFile(m_filename.c_str(), "rb")))
+		{
+			CloseWorkerContexts();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void GzippedFileReader::CloseWorkerContexts()
+{
+	for (WorkerContext& ctx : m_workers)
+	{
+		if (ctx.z_state.isValid)
+			inflateEnd(&ctx.z_state.strm);
+		if (ctx.src)
+			std::fclose(ctx.src);
+	}
+	m_workers.clear();
+}
+
+int GzippedFileReader::ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker)
+{
+	WorkerContext& ctx = m_workers[worker];
+	return ExtractChunk(dst, chunkID, ctx.src, &ctx.z_state);
 }
 
 u32 GzippedFileReader::GetBlockCount() const
 {
-	return (m_index->uncompressed_size + (m_blocksize - 1)) / m_blocksize;
+	return (m_uncompressed_size + (m_blocksize - 1)) / m_blocksize;
 }
@@ -6,6 +6,10 @@
 #include "CDVD/ThreadedFileReader.h"
 #include "zlib_indexed.h"
 
+#include "common/FileSystem.h"
+
+#include <vector>
+
 class GzippedFileReader final : public ThreadedFileReader
 {
 	DeclareNoncopyableObject(GzippedFileReader);
@@ -19,21 +23,74 @@ public:
 	Chunk ChunkForOffset(u64 offset) override;
 	int ReadChunk(void* dst, s64 chunkID) override;
 
+	bool OpenWorkerContexts(u32 count) override;
+	void CloseWorkerContexts() override;
+	int ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker) override;
+
 	void Close2() override;
 
 	u32 GetBlockCount() const override;
 
 private:
 	static constexpr int GZFILE_SPAN_DEFAULT = (1048576 * 4); /* distance between direct access points when creating a new index */
-	static constexpr int GZFILE_READ_CHUNK_SIZE = (256 * 1024); /* zlib extraction chunks size (at 0-based boundaries) */
-	static constexpr int GZFILE_CACHE_SIZE_MB = 200; /* cache size for extracted data. must be at least GZFILE_READ_CHUNK_SIZE (in MB)*/
+
+	// Access point as stored in the index file, windows are kept deflated in a separate blob.
+	struct IndexPoint
+	{
+		s64 out;
+		s64 in;
+		u64 window_offset;
+		u32 window_size;
+		u32 bits;
+	};
+
+	struct WorkerContext
+	{
+		std::FILE* src = nullptr;
+		zstate z_state = {};
+	};
 
 	// Verifies that we have an index, or try to create one
 	bool LoadOrCreateIndex(Error* error);
+	bool LoadIndexFile(const std::string& indexfile);
+	void WriteIndexFile(const std::string& indexfile);
+
+	// Works out the uncompressed size without inflating the whole file, so the index can be built in the background.
+	bool EstimateUncompressedSize(s64* size);
 
-	Access* m_index = nullptr; // Quick access index
+	// Runs build_index_with() over fp, publishing access points as they're found.
+	bool BuildIndex(std::FILE* fp, const std::string& indexfile);
+	static int AddIndexPoint(void* ctx, int bits, s64 in, s64 out, unsigned left, unsigned char* window);
+	static int CheckIndexCancelled(void* ctx, s64 in, s64 out);
+
+	// Returns the end of chunk `chunkID`, waiting for the index builder if it isn't known yet. Call with m_index_mutex held.
+	s64 GetChunkEnd(u32 chunkID, std::unique_lock<std::mutex>& lock);
+
+	int ExtractChunk(void* dst, s64 chunkID, std::FILE* src, zstate* state);
 
 	std::FILE* m_src = nullptr;
 
 	zstate m_z_state = {};
+	std::vector<WorkerContext> m_workers;
+
+	// Uncompressed size reported to the CDVD code, may be estimated while the index is being built.
+	s64 m_uncompressed_size = 0;
+	s64 m_compressed_size = 0;
+	s64 m_compressed_mtime = 0;
+
+	// Quick access index, either mapped from disk or built by m_index_thread.
+	// Everything below is protected by m_index_mutex while the index is incomplete.
+	FileSystem::MappedFile m_index_file;
+	std::vector<IndexPoint> m_built_points;
+	std::vector<u8> m_built_windows;
+	const IndexPoint* m_points = nullptr;
+	const u8* m_windows = nullptr;
+	u32 m_num_points = 0;
+	s64 m_index_uncompressed_size = 0;
+	bool m_index_complete = false;
+
+	std::mutex m_index_mutex;
+	std::condition_variable m_index_cv;
+	std::thread m_index_thread;
+	std::atomic<bool> m_index_cancel{false};
 };
@@ -2,16 +2,146 @@
 // SPDX-License-Identifier: GPL-3.0+
 
 #include "CDVD/CDVDcommon.h"
+#include "CDVD/ChdFileReader.h"
 #include "CDVD/IsoHasher.h"
+#include "GS/GSXXH.h"
+#include "Config.h"
 #include "Host.h"
 
+#include "common/Console.h"
 #include "common/Error.h"
+#include "common/FileSystem.h"
 #include "common/MD5Digest.h"
+#include "common/Path.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
+#include "common/Timer.h"
 
 #include "fmt/core.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Sectors handed to the hash threads at a time.
+static constexpr u32 BLOCK_SECTORS = 256;
+
+// Blocks which can be waiting for a hash thread before the reader has to wait for it.
+static constexpr u32 MAX_QUEUED_BLOCKS = 8;
+
+// Tracks which can be hashed at once. The reader is sequential, so this only helps when hashing can't keep up.
+static constexpr u32 MAX_HASH_JOBS = 4;
+
+// Limit on remembered track hashes, oldest are dropped first.
+static constexpr u32 MAX_CACHED_HASHES = 4096;
+
+class IsoHasher::HashJob
+{
+public:
+	HashJob(Track& track, bool xxhash_only);
+	~HashJob();
+
+	Track& GetTrack() const { return m_track; }
+	bool IsXXHashOnly() const { return m_xxhash_only; }
+	bool IsFinished() const { return m_finished; }
+
+	/// Queues sectors for hashing, waits if the hash thread has fallen too far behind
+	void Push(std::vector<u8> data);
+
+	/// Waits for everything queued to be hashed, then stores the results in the track if `complete`
+	void Finish(bool complete);
+
+private:
+	void Run();
+
+	XXH3_state_t m_xxhash_state;
+	MD5Digest m_md5;
+
+	Track& m_track;
+	bool m_xxhash_only;
+	bool m_finished = false;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<std::vector<u8>> m_queue;
+	bool m_done = false;
+};
+
+IsoHasher::HashJob::HashJob(Track& track, bool xxhash_only)
+	: m_track(track)
+	, m_xxhash_only(xxhash_only)
+{
+	XXH3_64bits_reset(&m_xxhash_state);
+	m_thread = std::thread(&HashJob::Run, this);
+}
+
+IsoHasher::HashJob::~HashJob()
+{
+	Finish(false);
+}
+
+void IsoHasher::HashJob::Push(std::vector<u8> data)
+{
+	std::unique_lock lock(m_mutex);
+	m_cv.wait(lock, [this]() { return m_queue.size() < MAX_QUEUED_BLOCKS; });
+	m_queue.push_back(std::move(data));
+	m_cv.notify_all();
+}
+
+void IsoHasher::HashJob::Finish(bool complete)
+{
+	if (m_finished)
+		return;
+
+	{
+		std::unique_lock lock(m_mutex);
+		m_done = true;
+		m_cv.notify_all();
+	}
+	m_thread.join();
+	m_finished = true;
+
+	if (!complete)
+		return;
+
+	m_track.xxhash = GSXXH3_64bits_digest(&m_xxhash_state);
+	if (m_xxhash_only)
+		return;
+
+	u8 digest[16];
+	m_md5.Final(digest);
+	m_track.hash =
+		fmt::format("{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
+			digest[0], digest[1], digest[2], digest[3], digest[4], digest[5], digest[6], digest[7], digest[8],
+			digest[9], digest[10], digest[11], digest[12], digest[13], digest[14], digest[15]);
+}
+
+void IsoHasher::HashJob::Run()
+{
+	Threading::SetNameOfCurrentThread("ISO Hasher");
+
+	std::unique_lock lock(m_mutex);
+	for (;;)
+	{
+		m_cv.wait(lock, [this]() { return !m_queue.empty() || m_done; });
+		if (m_queue.empty())
+			return;
+
+		std::vector<u8> data = std::move(m_queue.front());
+		m_queue.pop_front();
+		m_cv.notify_all();
+		lock.unlock();
+
+		GSXXH3_64bits_update(&m_xxhash_state, data.data(), data.size());
+		if (!m_xxhash_only)
+			m_md5.Update(data.data(), static_cast<u32>(data.size()));
+
+		lock.lock();
+	}
+}
 
 IsoHasher::IsoHasher() = default;
 
@@ -39,10 +169,22 @@ bool IsoHasher::Open(std::string iso_path, Error* error)
 {
 	Close();
 
+	FILESYSTEM_STAT_DATA sd;
+	if (FileSystem::StatFile(iso_path.c_str(), &sd))
+	{
+		m_file_size = sd.Size;
+		m_file_mtime = static_cast<s64>(sd.ModificationTime);
+	}
+	m_path = iso_path;
+
 	CDVDsys_SetFile(CDVD_SourceType::Iso, std::move(iso_path));
 	CDVDsys_ChangeSource(CDVD_SourceType::Iso);
 
-	m_is_open = DoCDVDopen(error);
+	// Hashes are used to verify dumps, so they have to come from the file, not hunks cached by the CHD's SHA1.
+	{
+		ChdFileReader::ScopedHunkCacheBypass no_hunk_cache;
+		m_is_open = DoCDVDopen(error);
+	}
 	if (!m_is_open)
 		return false;
 
@@ -95,6 +237,8 @@ bool IsoHasher::Open(std::string iso_path, Error* error)
 		strack.start_lsn = td.lsn;
 		strack.sectors = next_td.lsn - td.lsn;
 		strack.size = static_cast<u64>(strack.sectors) * (m_is_cd ? 2352 : 2048);
+		strack.xxhash = 0;
+		strack.prechecked = false;
 		m_tracks.push_back(std::move(strack));
 	}
 
@@ -108,16 +252,27 @@ void IsoHasher::Close()
 
 	DoCDVDclose();
 	m_tracks.clear();
+	m_path = {};
+	m_file_size = 0;
+	m_file_mtime = 0;
 	m_is_cd = false;
 	m_is_open = false;
 }
 
-void IsoHasher::ComputeHashes(ProgressCallback* callback)
+void IsoHasher::ComputeHashes(ProgressCallback* callback, bool precheck)
 {
 	callback->SetProgressRange(GetTrackCount());
 	callback->SetProgressValue(0);
 	callback->SetCancellable(true);
 
+	const std::vector<CachedHash> cached = precheck ? LoadCachedHashes() : std::vector<CachedHash>();
+	std::vector<std::pair<Track*, const CachedHash*>> prechecks;
+	std::vector<std::unique_ptr<HashJob>> jobs;
+	Common::Timer timer;
+	u64 bytes_read = 0;
+	bool hashed = false;
+	bool result = true;
+
 	for (u32 index = 0; index < GetTrackCount(); index++)
 	{
 		Track& track = m_tracks[index];
@@ -127,57 +282,204 @@ void IsoHasher::ComputeHashes(ProgressCallback* callback)
 			continue;
 		}
 
+		const auto cit = std::find_if(cached.begin(), cached.end(),
+			[&track](const CachedHash& ch) { return (ch.number == track.number && ch.size == track.size); });
+		const bool xxhash_only = (cit != cached.end());
+
 		callback->PushState();
-		const bool result = ComputeTrackHash(track, callback);
+		result = ReadTrack(track, xxhash_only, jobs, timer, bytes_read, callback);
 		callback->PopState();
 
 		if (!result)
 			break;
 
+		if (xxhash_only)
+			prechecks.emplace_back(&track, &*cit);
+		else
+			hashed = true;
+
 		callback->SetProgressValue(index + 1);
 		callback->IncrementProgressValue();
 	}
 
+	for (const std::unique_ptr<HashJob>& job : jobs)
+		job->Finish(true);
+	jobs.clear();
+
+	// Anything which doesn't match what it was last time has changed, so it needs a real hash.
+	for (auto& [track, ch] : prechecks)
+	{
+		if (!result)
+			break;
+
+		if (track->xxhash == ch->xxhash)
+		{
+			track->hash = ch->hash;
+			track->prechecked = true;
+			continue;
+		}
+
+		Console.Warning(fmt::format("Track {} of '{}' changed since it was last verified.", track->number, m_path));
+		callback->PushState();
+		result = ReadTrack(*track, false, jobs, timer, bytes_read, callback);
+		callback->PopState();
+		hashed = true;
+	}
+
+	for (const std::unique_ptr<HashJob>& job : jobs)
+		job->Finish(result);
+	jobs.clear();
+
+	if (hashed)
+		SaveCachedHashes();
+
+	const double elapsed = timer.GetTimeSeconds();
+	if (bytes_read > 0 && elapsed > 0.0)
+	{
+		DevCon.WriteLn(fmt::format("Hashed {} MB in {:.2f} seconds ({:.1f} MB/s)", bytes_read / _1mb, elapsed,
+			static_cast<double>(bytes_read) / _1mb / elapsed));
+	}
+
 	callback->SetProgressValue(GetTrackCount());
 }
 
-bool IsoHasher::ComputeTrackHash(Track& track, ProgressCallback* callback)
+bool IsoHasher::ReadTrack(Track& track, bool xxhash_only, std::vector<std::unique_ptr<HashJob>>& jobs,
+	const Common::Timer& timer, u64& bytes_read, ProgressCallback* callback)
 {
 	// use 2048 byte reads for DVDs, otherwise 2352 raw.
 	const int read_mode = m_is_cd ? CDVD_MODE_2352 : CDVD_MODE_2048;
 	const u32 sector_size = m_is_cd ? 2352 : 2048;
-	std::vector<u8> sector_buffer(sector_size);
+
+	// The oldest job is the one which is closest to being done, so wait for that if we've got too many.
+	if (std::count_if(jobs.begin(), jobs.end(), [](const auto& job) { return !job->IsFinished(); }) >= MAX_HASH_JOBS)
+		(*std::find_if(jobs.begin(), jobs.end(), [](const auto& job) { return !job->IsFinished(); }))->Finish(true);
+
+	HashJob* job = jobs.emplace_back(std::make_unique<HashJob>(track, xxhash_only)).get();
+
+	const char* status = xxhash_only ? "Checking track %u (%.1f MB/s)..." : "Computing hash for track %u (%.1f MB/s)...";
+	const auto update_status = [&]() {
+		const double elapsed = timer.GetTimeSeconds();
+		const double speed = (elapsed > 0.0) ? (static_cast<double>(bytes_read) / _1mb / elapsed) : 0.0;
+		callback->SetFormattedStatusText(status, track.number, speed);
+	};
 
 	const u32 update_interval = std::max<u32>(track.sectors / 100u, 1u);
-	callback->SetFormattedStatusText("Computing hash for track %u...", track.number);
+	update_status();
 	callback->SetProgressRange(track.sectors);
 
-	MD5Digest md5;
+	std::vector<u8> block;
 	for (u32 i = 0; i < track.sectors; i++)
 	{
 		if (callback->IsCancelled())
+		{
+			job->Finish(false);
 			return false;
+		}
+
+		if (block.empty())
+			block.reserve(BLOCK_SECTORS * sector_size);
 
 		const u32 lsn = track.start_lsn + i;
-		if (DoCDVDreadSector(sector_buffer.data(), lsn, read_mode) != 0)
+		const size_t pos = block.size();
+		block.resize(pos + sector_size);
+		if (DoCDVDreadSector(block.data() + pos, lsn, read_mode) != 0)
 		{
+			job->Finish(false);
 			callback->DisplayFormattedModalError("Read error at LSN %u", lsn);
 			return false;
 		}
 
-		md5.Update(sector_buffer.data(), sector_size);
+		bytes_read += sector_size;
+		if (block.size() >= BLOCK_SECTORS * sector_size)
+		{
+			job->Push(std::move(block));
+			block.clear();
+		}
 
 		if ((i % update_interval) == 0)
+		{
 			callback->SetProgressValue(i);
+			update_status();
+		}
 	}
 
-	u8 digest[16];
-	md5.Final(digest);
-	track.hash =
-		fmt::format("{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
-			digest[0], digest[1], digest[2], digest[3], digest[4], digest[5], digest[6], digest[7], digest[8],
-			digest[9], digest[10], digest[11], digest[12], digest[13], digest[14], digest[15]);
+	if (!block.empty())
+		job->Push(std::move(block));
 
 	callback->SetProgressValue(track.sectors);
 	return true;
 }
+
+std::string IsoHasher::GetHashCachePath()
+{
+	return Path::Combine(EmuFolders::Cache, "isohashes.cache");
+}
+
+std::vector<IsoHasher::CachedHash> IsoHasher::LoadCachedHashes() const
+{
+	// One line per track: path, image size, image mtime, track number, track size, xxhash, md5.
+	std::vector<CachedHash> ret;
+	const std::optional<std::string> data = FileSystem::ReadFileToString(GetHashCachePath().c_str());
+	if (!data.has_value())
+		return ret;
+
+	for (const std::string_view line : StringUtil::SplitString(data.value(), '\n'))
+	{
+		const std::vector<std::string_view> fields = StringUtil::SplitString(line, '\t', false);
+		if (fields.size() != 7 || fields[0] != m_path ||
+			StringUtil::FromChars<s64>(fields[1]).value_or(-1) != m_file_size ||
+			StringUtil::FromChars<s64>(fields[2]).value_or(-1) != m_file_mtime)
+		{
+			continue;
+		}
+
+		const std::optional<u32> number = StringUtil::FromChars<u32>(fields[3]);
+		const std::optional<u64> size = StringUtil::FromChars<u64>(fields[4]);
+		const std::optional<u64> xxhash = StringUtil::FromChars<u64>(fields[5], 16);
+		if (!number.has_value() || !size.has_value() || !xxhash.has_value() || fields[6].size() != 32)
+			continue;
+
+		ret.push_back(CachedHash{number.value(), size.value(), xxhash.value(), std::string(fields[6])});
+	}
+
+	return ret;
+}
+
+void IsoHasher::SaveCachedHashes() const
+{
+	const std::string path = GetHashCachePath();
+	const std::optional<std::string> data = FileSystem::ReadFileToString(path.c_str());
+
+	// Keep everything for other images, entries for this one get replaced.
+	std::vector<std::string_view> lines;
+	if (data.has_value())
+	{
+		for (const std::string_view line : StringUtil::SplitString(data.value(), '\n'))
+		{
+			const std::string_view::size_type tab = line.find('\t');
+			if (tab != std::string_view::npos && line.substr(0, tab) != m_path)
+				lines.push_back(line);
+		}
+	}
+
+	const size_t new_lines = std::count_if(m_tracks.begin(), m_tracks.end(), [](const Track& t) { return !t.hash.empty(); });
+	const size_t keep = (lines.size() + new_lines > MAX_CACHED_HASHES) ? (MAX_CACHED_HASHES - std::min<size_t>(new_lines, MAX_CACHED_HASHES)) : lines.size();
+
+	std::string out;
+	for (size_t i = lines.size() - keep; i < lines.size(); i++)
+	{
+		out.append(lines[i]);
+		out.push_back('\n');
+	}
+	for (const Track& track : m_tracks)
+	{
+		if (track.hash.empty())
+			continue;
+
+		fmt::format_to(std::back_inserter(out), "{}\t{}\t{}\t{}\t{}\t{:016x}\t{}\n", m_path, m_file_size, m_file_mtime,
+			track.number, track.size, track.xxhash, track.hash);
+	}
+
+	if (!FileSystem::WriteStringToFile(path.c_str(), out))
+		Console.Error(fmt::format("Failed to write hash cache to '{}'", path));
+}
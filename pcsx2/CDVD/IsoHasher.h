@@ -6,11 +6,17 @@
 #include "common/Pcsx2Defs.h"
 #include "common/ProgressCallback.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
 class Error;
 
+namespace Common
+{
+	class Timer;
+}
+
 class IsoHasher
 {
 public:
@@ -22,6 +28,11 @@ public:
 		u32 sectors;
 		u64 size;
 		std::string hash;
+
+		/// XXH3 of the track contents, used to skip MD5 when the image was verified before
+		u64 xxhash;
+		/// True if the hash was taken from a previous verification after the XXH3 pre-check matched
+		bool prechecked;
 	};
 
 public:
@@ -38,12 +49,36 @@ public:
 	bool Open(std::string iso_path, Error* error = nullptr);
 	void Close();
 
-	void ComputeHashes(ProgressCallback* callback = ProgressCallback::NullProgressCallback);
+	/// Hashes every track which doesn't have a hash yet
+	/// Sectors are read on this thread while each track is hashed on its own thread, so several tracks can be
+	/// in flight at once. With `precheck`, tracks which were hashed before are only checked with XXH3 and keep
+	/// their previous MD5 if that matches, which is much cheaper than recomputing it. Callers have to opt in,
+	/// since a cached MD5 is only as trustworthy as the XXH3 match it's reused on.
+	void ComputeHashes(ProgressCallback* callback = ProgressCallback::NullProgressCallback, bool precheck = false);
 
 private:
-	bool ComputeTrackHash(Track& track, ProgressCallback* callback);
+	class HashJob;
+
+	struct CachedHash
+	{
+		u32 number;
+		u64 size;
+		u64 xxhash;
+		std::string hash;
+	};
+
+	/// Reads a track on the calling thread, handing the sectors to a new hash job which is added to `jobs`
+	bool ReadTrack(Track& track, bool xxhash_only, std::vector<std::unique_ptr<HashJob>>& jobs,
+		const Common::Timer& timer, u64& bytes_read, ProgressCallback* callback);
+
+	static std::string GetHashCachePath();
+	std::vector<CachedHash> LoadCachedHashes() const;
+	void SaveCachedHashes() const;
 
 	std::vector<Track> m_tracks;
+	std::string m_path;
+	s64 m_file_size = 0;
+	s64 m_file_mtime = 0;
 	bool m_is_open = false;
 	bool m_is_cd = false;
 };
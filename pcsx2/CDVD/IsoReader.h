@@ -11,6 +11,7 @@
 #include <vector>
 
 class Error;
+class InputIsoFile;
 
 class IsoReader
 {
@@ -144,6 +145,9 @@ public:
 	// ... once I have the energy to make CDVD not depend on a global object.
 	bool Open(Error* error = nullptr);
 
+	/// Reads from the given image instead of the global CDVD object, so it can be used from any thread.
+	bool Open(InputIsoFile* iso, Error* error = nullptr);
+
 	std::vector<std::string> GetFilesInDirectory(const std::string_view path, Error* error = nullptr);
 
 	std::optional<ISODirectoryEntry> LocateFile(const std::string_view path, Error* error);
@@ -163,4 +167,5 @@ private:
 		u32 directory_record_lba, u32 directory_record_size, Error* error);
 
 	ISOPrimaryVolumeDescriptor m_pvd = {};
+	InputIsoFile* m_iso = nullptr;
 };
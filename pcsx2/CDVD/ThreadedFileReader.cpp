@@ -2,14 +2,18 @@
 // SPDX-License-Identifier: GPL-3.0+
 
 #include "ThreadedFileReader.h"
+#include "Config.h"
 #include "Host.h"
 
+#include "common/Assertions.h"
+#include "common/Console.h"
 #include "common/Error.h"
 #include "common/HostSys.h"
 #include "common/Path.h"
 #include "common/ProgressCallback.h"
 #include "common/SmallString.h"
 #include "common/Threading.h"
+#include "common/Timer.h"
 
 #include <cstring>
 
@@ -17,20 +21,58 @@
 // If buffers are smaller than that, we can't keep up with linear reads
 static constexpr u32 MINIMUM_SIZE = 128 * 1024;
 
+// Limits for the user-configurable cache size and worker count
+static constexpr u32 MAX_BUFFERS = 64;
+static constexpr u32 MAX_WORKERS = 8;
+
+// Number of back-to-back sequential requests before we start prefetching deeper than one buffer
+static constexpr u32 SEQUENTIAL_THRESHOLD = 2;
+
 ThreadedFileReader::ThreadedFileReader()
 {
+	AllocateBuffers(2);
 	m_readThread = std::thread([](ThreadedFileReader* r){ r->Loop(); }, this);
 }
 
 ThreadedFileReader::~ThreadedFileReader()
 {
+	pxAssertMsg(m_workers.empty(), "Prefetch workers should be stopped by Close()");
 	m_quit = true;
 	(void)std::lock_guard<std::mutex>{m_mtx};
 	m_condition.notify_one();
 	m_readThread.join();
-	for (auto& buffer : m_buffer)
-		if (buffer.ptr)
-			free(buffer.ptr);
+	AllocateBuffers(0);
+}
+
+void ThreadedFileReader::AllocateBuffers(u32 count)
+{
+	for (u32 i = 0; i < m_bufferCount; i++)
+	{
+		if (m_buffer[i].ptr)
+			free(m_buffer[i].ptr);
+	}
+
+	m_buffer = count ? std::make_unique<Buffer[]>(count) : nullptr;
+	m_bufferCount = count;
+	m_useCounter = 0;
+}
+
+bool ThreadedFileReader::OpenWorkerContexts(u32 count)
+{
+	return false;
+}
+
+void ThreadedFileReader::CloseWorkerContexts()
+{
+}
+
+int ThreadedFileReader::ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker)
+{
+	return -1;
+}
+
+void ThreadedFileReader::OnDirectRead(u64 offset, u32 size)
+{
 }
 
 size_t ThreadedFileReader::CopyBlocks(void* dst, const void* src, size_t size) const
@@ -73,6 +115,19 @@ void ThreadedFileReader::Loop()
 		bool ok = true;
 		m_running = true;
 
+		// Requests which pick up close to where the last one finished mean the game is streaming, so prefetch further ahead
+		// Readahead-only requests point at the last byte that was read, and cache hits in between don't reach us at all
+		if (m_requestOffset + 1 >= m_lastRequestEnd &&
+			m_requestOffset + 1 - m_lastRequestEnd <= static_cast<u64>(m_bufferCount) * MINIMUM_SIZE)
+		{
+			m_sequentialRequests++;
+		}
+		else
+		{
+			m_sequentialRequests = 0;
+		}
+		m_lastRequestEnd = m_requestOffset + m_requestSize;
+
 		for (;;)
 		{
 			void* ptr = m_requestPtr.load(std::memory_order_acquire);
@@ -96,7 +151,12 @@ void ThreadedFileReader::Loop()
 			break;
 		}
 
-		if (ok)
+		if (ok && m_workerCount > 0 && StartWorkers())
+		{
+			// Let the workers decompress ahead of the request, we'll pick the results up from the cache
+			QueuePrefetch(requestOffset + requestSize - 1);
+		}
+		else if (ok)
 		{
 			// Readahead
 			Chunk chunk = ChunkForOffset(requestOffset + requestSize);
@@ -143,25 +203,40 @@ void ThreadedFileReader::Loop()
 
 ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 {
-	for (int i = 0; i < static_cast<int>(std::size(m_buffer)); i++)
+	// This can be called from both the read thread threads in ReadSync
+	// Calls from ReadSync are done with the lock already held to keep the read thread out
+	// Therefore we should only lock on the read thread
+	std::unique_lock<std::mutex> lock(m_mtx, std::defer_lock);
+	const bool onReadThread = std::this_thread::get_id() == m_readThread.get_id();
+	if (onReadThread)
+		lock.lock();
+
+	for (;;)
 	{
-		u32 size = m_buffer[i].size.load(std::memory_order_relaxed);
-		u64 offset = m_buffer[i].offset;
-		if (size && offset <= block.offset && offset + size >= block.offset + block.length)
+		bool pending = false;
+		for (u32 i = 0; i < m_bufferCount; i++)
 		{
-			m_nextBuffer = (i + 1) % std::size(m_buffer);
-			return m_buffer + i;
+			Buffer& buf = m_buffer[i];
+			u32 size = buf.size.load(std::memory_order_acquire);
+			u64 offset = buf.offset;
+			if (size && offset <= block.offset && offset + size >= block.offset + block.length)
+			{
+				buf.lastUse = ++m_useCounter;
+				return &buf;
+			}
+			if (buf.pending && offset <= block.offset && buf.fillEnd >= block.offset + block.length)
+				pending = true;
 		}
+
+		// A worker is already decompressing this chunk, wait for it rather than doing the work twice
+		// ReadSync can't wait here, but it doesn't decompress itself when a prefetch is pending
+		if (!pending || !onReadThread || m_requestCancelled.load(std::memory_order_relaxed))
+			break;
+		m_condition.wait(lock);
 	}
 
-	Buffer& buf = m_buffer[m_nextBuffer];
+	Buffer& buf = *FindVictimBuffer();
 	{
-		// This can be called from both the read thread threads in ReadSync
-		// Calls from ReadSync are done with the lock already held to keep the read thread out
-		// Therefore we should only lock on the read thread
-		std::unique_lock<std::mutex> lock(m_mtx, std::defer_lock);
-		if (std::this_thread::get_id() == m_readThread.get_id())
-			lock.lock();
 		u32 size = std::max(block.length, MINIMUM_SIZE);
 		if (buf.cap < size)
 		{
@@ -169,18 +244,251 @@ ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 			buf.cap = size;
 		}
 		buf.size.store(0, std::memory_order_relaxed);
+		buf.offset = block.offset;
+		buf.lastUse = ++m_useCounter;
+		if (onReadThread)
+			lock.unlock();
 	}
 	int size = ReadChunk(buf.ptr, block.chunkID);
 	if (size > 0)
 	{
-		buf.offset = block.offset;
 		buf.size.store(size, std::memory_order_release);
-		m_nextBuffer = (m_nextBuffer + 1) % std::size(m_buffer);
 		return &buf;
 	}
 	return nullptr;
 }
 
+ThreadedFileReader::Buffer* ThreadedFileReader::FindVictimBuffer()
+{
+	Buffer* victim = nullptr;
+	for (u32 i = 0; i < m_bufferCount; i++)
+	{
+		Buffer& buf = m_buffer[i];
+		if (!buf.pending && (!victim || buf.lastUse < victim->lastUse))
+			victim = &buf;
+	}
+
+	// QueuePrefetch always leaves some buffers for the read thread
+	pxAssert(victim);
+	return victim;
+}
+
+bool ThreadedFileReader::IsPrefetchPending(u64 offset) const
+{
+	for (u32 i = 0; i < m_bufferCount; i++)
+	{
+		const Buffer& buf = m_buffer[i];
+		if (buf.pending && buf.offset <= offset && buf.fillEnd > offset)
+			return true;
+	}
+	return false;
+}
+
+ThreadedFileReader::Buffer* ThreadedFileReader::FindBufferContaining(u64 offset, u64* end)
+{
+	for (u32 i = 0; i < m_bufferCount; i++)
+	{
+		Buffer& buf = m_buffer[i];
+		const u64 bufend = buf.pending ? buf.fillEnd : buf.offset + buf.size.load(std::memory_order_acquire);
+		if (bufend > buf.offset && buf.offset <= offset && bufend > offset)
+		{
+			*end = bufend;
+			return &buf;
+		}
+	}
+	return nullptr;
+}
+
+u32 ThreadedFileReader::CountBuffersFrom(u64 offset, u32 limit)
+{
+	u32 count = 0;
+	u64 end;
+	while (count < limit && FindBufferContaining(offset, &end))
+	{
+		offset = end;
+		count++;
+	}
+	return count;
+}
+
+u32 ThreadedFileReader::GetReadaheadDepth() const
+{
+	// Keep two buffers free for the read thread, the one being read from and the one it's filling
+	if (m_workerCount == 0 || m_sequentialRequests < SEQUENTIAL_THRESHOLD)
+		return 1;
+	return std::max(m_bufferCount - 2, 1u);
+}
+
+bool ThreadedFileReader::StartWorkers()
+{
+	if (m_workersStarted)
+		return true;
+	if (m_workersUnavailable)
+		return false;
+
+	// Contexts can be slow to open (e.g. CHD parent lookups), don't hold the lock for it
+	if (!OpenWorkerContexts(m_workerCount))
+	{
+		m_workersUnavailable = true;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mtx);
+	m_workersQuit = false;
+	for (u32 i = 0; i < m_workerCount; i++)
+		m_workers.emplace_back([](ThreadedFileReader* r, u32 worker) { r->WorkerLoop(worker); }, this, i);
+	m_workersStarted = true;
+	return true;
+}
+
+void ThreadedFileReader::StopWorkers()
+{
+	m_workersUnavailable = false;
+	if (!m_workersStarted)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_workersQuit = true;
+	}
+	m_workerCondition.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+	m_workers.clear();
+	m_workersStarted = false;
+
+	CloseWorkerContexts();
+}
+
+void ThreadedFileReader::WorkerLoop(u32 worker)
+{
+	Threading::SetNameOfCurrentThread("ISO Prefetch");
+
+	std::unique_lock<std::mutex> lock(m_mtx);
+
+	for (;;)
+	{
+		while (m_prefetchQueue.empty() && !m_workersQuit)
+			m_workerCondition.wait(lock);
+
+		if (m_workersQuit)
+			return;
+
+		const PrefetchJob job = m_prefetchQueue.front();
+		m_prefetchQueue.pop_front();
+		m_workersBusy++;
+		lock.unlock();
+
+		// Fill the buffer with as many consecutive chunks as will fit, publishing each one as it completes
+		Buffer* buf = job.buf;
+		Chunk chunk = job.chunk;
+		u32 filled = 0;
+		while (!m_prefetchCancelled.load(std::memory_order_relaxed))
+		{
+			const int amt = ReadChunkOnWorker(static_cast<char*>(buf->ptr) + filled, chunk.chunkID, worker);
+			if (amt <= 0)
+				break;
+			filled += amt;
+			buf->size.store(filled, std::memory_order_release);
+
+			// Stop where QueuePrefetch expected us to, it's already planned the next buffer from there
+			if (buf->offset + filled >= buf->fillEnd)
+				break;
+			chunk = ChunkForOffset(buf->offset + filled);
+			if (chunk.chunkID < 0 || chunk.offset != buf->offset + filled || filled + chunk.length > buf->cap)
+				break;
+		}
+
+		lock.lock();
+		buf->pending = false;
+		m_workersBusy--;
+		m_statPrefetches.fetch_add(1, std::memory_order_relaxed);
+
+		// Wakes the read thread if it's waiting on this buffer, and anyone waiting for the workers to go idle
+		m_condition.notify_all();
+	}
+}
+
+void ThreadedFileReader::QueuePrefetch(u64 offset)
+{
+	std::unique_lock<std::mutex> lock(m_mtx);
+
+	// Same count as TryCachedRead checks for: the buffer containing `offset` plus the readahead depth
+	const u32 wanted = GetReadaheadDepth() + 1;
+	u32 inflight = 0;
+	for (u32 i = 0; i < m_bufferCount; i++)
+		inflight += m_buffer[i].pending ? 1 : 0;
+
+	u64 pos = offset;
+	u32 queued = 0;
+	for (u32 ahead = 0; ahead < wanted && !m_requestPtr.load(std::memory_order_acquire); ahead++)
+	{
+		// Skip over anything which is already cached or on its way
+		// Touch it too, so data we're about to need is never older than data we've already read past
+		u64 end;
+		if (Buffer* buf = FindBufferContaining(pos, &end))
+		{
+			buf->lastUse = ++m_useCounter;
+			pos = end;
+			continue;
+		}
+
+		if (inflight + 2 >= m_bufferCount)
+			break;
+
+		// ChunkForOffset may block (e.g. gzip waiting on its index), so work out the buffer's range without the lock
+		lock.unlock();
+		const Chunk chunk = ChunkForOffset(pos);
+		const u32 size = std::max(chunk.length, MINIMUM_SIZE);
+		end = chunk.offset + chunk.length;
+		for (;;)
+		{
+			if (chunk.chunkID < 0)
+				break;
+			const Chunk next = ChunkForOffset(end);
+			if (next.chunkID < 0 || next.length == 0 || next.offset != end || (end - chunk.offset) + next.length > size)
+				break;
+			end += next.length;
+		}
+		lock.lock();
+		if (chunk.chunkID < 0 || m_requestPtr.load(std::memory_order_acquire))
+			break;
+
+		Buffer& buf = *FindVictimBuffer();
+		if (buf.cap < size)
+		{
+			buf.ptr = realloc(buf.ptr, size);
+			buf.cap = size;
+		}
+
+		buf.size.store(0, std::memory_order_relaxed);
+		buf.offset = chunk.offset;
+		buf.fillEnd = end;
+		buf.lastUse = ++m_useCounter;
+		buf.pending = true;
+		m_prefetchQueue.push_back({&buf, chunk});
+		inflight++;
+		queued++;
+		pos = end;
+	}
+
+	lock.unlock();
+	if (queued > 0)
+		m_workerCondition.notify_all();
+}
+
+void ThreadedFileReader::CancelPrefetch(std::unique_lock<std::mutex>& lock)
+{
+	for (const PrefetchJob& job : m_prefetchQueue)
+		job.buf->pending = false;
+	m_prefetchQueue.clear();
+
+	m_prefetchCancelled.store(true, std::memory_order_relaxed);
+	while (m_workersBusy > 0)
+		m_condition.wait(lock);
+	m_prefetchCancelled.store(false, std::memory_order_relaxed);
+}
+
 bool ThreadedFileReader::Decompress(void* target, u64 begin, u32 size)
 {
 	char* write = static_cast<char*>(target);
@@ -222,18 +530,21 @@ bool ThreadedFileReader::Decompress(void* target, u64 begin, u32 size)
 
 bool ThreadedFileReader::TryCachedRead(void*& buffer, u64& offset, u32& size, const std::lock_guard<std::mutex>&)
 {
-	// Run through twice so that if m_buffer[1] contains the first half and m_buffer[0] contains the second half it still works
 	m_amtRead = 0;
-	u64 end = 0;
-	bool allDone = false;
-	for (int i = 0; i < static_cast<int>(std::size(m_buffer) * 2); i++)
+	m_statReads.fetch_add(1, std::memory_order_relaxed);
+
+	// Keep sweeping while we make progress, so it still works if later buffers contain earlier parts of the request
+	bool progress = true;
+	while (size && progress)
 	{
-		Buffer& buf = m_buffer[i % std::size(m_buffer)];
-		u32 bufsize = buf.size.load(std::memory_order_acquire);
-		if (!bufsize)
-			continue;
-		if (buf.offset <= offset && buf.offset + bufsize > offset)
+		progress = false;
+		for (u32 i = 0; i < m_bufferCount && size; i++)
 		{
+			Buffer& buf = m_buffer[i];
+			u32 bufsize = buf.size.load(std::memory_order_acquire);
+			if (!bufsize || buf.offset > offset || buf.offset + bufsize <= offset)
+				continue;
+
 			u32 off = offset - buf.offset;
 			u32 cpysize = std::min(size, bufsize - off);
 			size_t read = CopyBlocks(buffer, static_cast<char*>(buf.ptr) + off, cpysize);
@@ -241,19 +552,44 @@ bool ThreadedFileReader::TryCachedRead(void*& buffer, u64& offset, u32& size, co
 			size -= cpysize;
 			offset += cpysize;
 			buffer = static_cast<char*>(buffer) + read;
-			if (size == 0)
-				end = buf.offset + bufsize;
+			buf.lastUse = ++m_useCounter;
+			progress = true;
 		}
-		// Do buffers contain the current and next block?
-		if (end > 0 && buf.offset == end)
-			allDone = true;
 	}
-	return allDone;
+
+	if (size)
+		return false;
+
+	m_statCacheHits.fetch_add(1, std::memory_order_relaxed);
+
+	// Do buffers contain the current block and enough following ones?
+	// If not, the caller wakes the read thread to top them up
+	const u32 wanted = GetReadaheadDepth() + 1;
+	return CountBuffersFrom(offset - 1, wanted) >= wanted;
+}
+
+int ThreadedFileReader::DirectRead(void* dst, u64 offset, u32 size)
+{
+	m_statReads.fetch_add(1, std::memory_order_relaxed);
+	m_statCacheHits.fetch_add(1, std::memory_order_relaxed);
+
+	m_amtRead = 0;
+	if (offset >= m_directSize)
+		return m_amtRead;
+
+	// Only whole internal blocks, CopyBlocks can't deal with a partial one at the end of the image
+	const u32 blocksize = InternalBlockSize();
+	const u32 avail = static_cast<u32>(std::min<u64>(size, m_directSize - offset) / blocksize * blocksize);
+	m_amtRead = static_cast<int>(CopyBlocks(dst, m_directData + offset, avail));
+	OnDirectRead(offset, avail);
+	return m_amtRead;
 }
 
 bool ThreadedFileReader::Precache(ProgressCallback* progress, Error* error)
 {
+	// Worker contexts may read from the file directly, reopen them after precaching
 	CancelAndWaitUntilStopped();
+	StopWorkers();
 	progress->SetStatusText(SmallString::from_format(TRANSLATE_FS("CDVD", "Precaching {}..."), Path::GetFileName(m_filename)).c_str());
 	return Precache2(progress, error);
 }
@@ -284,6 +620,23 @@ bool ThreadedFileReader::CheckAvailableMemoryForPrecaching(u64 required_size, Er
 bool ThreadedFileReader::Open(std::string filename, Error* error)
 {
 	CancelAndWaitUntilStopped();
+	StopWorkers();
+
+	const u32 bufferCount = std::clamp(EmuConfig.CdvdReadCacheBuffers, 2u, MAX_BUFFERS);
+	if (bufferCount != m_bufferCount)
+		AllocateBuffers(bufferCount);
+
+	// Prefetching needs room for a few buffers ahead on top of the ones the read thread uses
+	m_workerCount = (m_bufferCount >= 4) ? std::min(EmuConfig.CdvdDecompressThreads, MAX_WORKERS) : 0;
+	m_sequentialRequests = 0;
+	m_lastRequestEnd = 0;
+
+	m_statReads.store(0, std::memory_order_relaxed);
+	m_statCacheHits.store(0, std::memory_order_relaxed);
+	m_statPrefetches.store(0, std::memory_order_relaxed);
+	m_statStalls.store(0, std::memory_order_relaxed);
+	m_statStallTime.store(0, std::memory_order_relaxed);
+
 	return Open2(std::move(filename), error);
 }
 
@@ -292,12 +645,19 @@ int ThreadedFileReader::ReadSync(void* pBuffer, u32 sector, u32 count)
 	u32 blocksize = InternalBlockSize();
 	u64 offset = (u64)sector * (u64)blocksize + m_dataoffset;
 	u32 size = count * blocksize;
+	if (m_directData)
+		return DirectRead(pBuffer, offset, size);
+
+	Common::Timer stallTimer;
+	bool miss;
 	{
 		std::lock_guard<std::mutex> l(m_mtx);
 		if (TryCachedRead(pBuffer, offset, size, l))
 			return m_amtRead;
 
-		if (size > 0 && !m_running)
+		miss = (size > 0);
+
+		if (size > 0 && !m_running && !IsPrefetchPending(offset))
 		{
 			// Don't wait for read thread to start back up
 			if (Decompress(pBuffer, offset, size))
@@ -323,9 +683,15 @@ int ThreadedFileReader::ReadSync(void* pBuffer, u32 sector, u32 count)
 		m_requestCancelled.store(false, std::memory_order_relaxed);
 	}
 	m_condition.notify_one();
-	if (size == 0)
-		return m_amtRead;
-	return FinishRead();
+	if (size > 0)
+		WaitForRequest();
+
+	if (miss)
+	{
+		m_statStalls.fetch_add(1, std::memory_order_relaxed);
+		m_statStallTime.fetch_add(static_cast<u64>(stallTimer.GetTimeNanoseconds()), std::memory_order_relaxed);
+	}
+	return m_amtRead;
 }
 
 void ThreadedFileReader::CancelAndWaitUntilStopped(void)
@@ -339,6 +705,9 @@ void ThreadedFileReader::CancelAndWaitUntilStopped(void)
 
 	while (m_running)
 		m_condition.wait(lock);
+
+	// The read thread is idle now, so it can't queue any more prefetches behind our back
+	CancelPrefetch(lock);
 }
 
 void ThreadedFileReader::BeginRead(void* pBuffer, u32 sector, u32 count)
@@ -346,6 +715,13 @@ void ThreadedFileReader::BeginRead(void* pBuffer, u32 sector, u32 count)
 	s32 blocksize = InternalBlockSize();
 	u64 offset = (u64)sector * (u64)blocksize + m_dataoffset;
 	u32 size = count * blocksize;
+	if (m_directData)
+	{
+		// Nothing to wait for, FinishRead will just return the amount read
+		DirectRead(pBuffer, offset, size);
+		return;
+	}
+
 	{
 		std::lock_guard<std::mutex> l(m_mtx);
 		if (TryCachedRead(pBuffer, offset, size, l))
@@ -372,10 +748,19 @@ int ThreadedFileReader::FinishRead(void)
 {
 	if (m_requestPtr.load(std::memory_order_acquire) == nullptr)
 		return m_amtRead;
+
+	Common::Timer stallTimer;
+	WaitForRequest();
+	m_statStalls.fetch_add(1, std::memory_order_relaxed);
+	m_statStallTime.fetch_add(static_cast<u64>(stallTimer.GetTimeNanoseconds()), std::memory_order_relaxed);
+	return m_amtRead;
+}
+
+void ThreadedFileReader::WaitForRequest()
+{
 	std::unique_lock<std::mutex> lock(m_mtx);
 	while (m_requestPtr.load(std::memory_order_acquire))
 		m_condition.wait(lock);
-	return m_amtRead;
 }
 
 void ThreadedFileReader::CancelRead(void)
@@ -391,11 +776,31 @@ void ThreadedFileReader::CancelRead(void)
 void ThreadedFileReader::Close(void)
 {
 	CancelAndWaitUntilStopped();
-	for (auto& buf : m_buffer)
-		buf.size.store(0, std::memory_order_relaxed);
+	StopWorkers();
+	for (u32 i = 0; i < m_bufferCount; i++)
+		m_buffer[i].size.store(0, std::memory_order_relaxed);
+
+	const Stats stats = GetStats();
+	if (stats.reads > 0)
+	{
+		DEV_LOG("ISO reader: {} reads, {} cache hits, {} prefetched buffers, {} stalls totalling {:.2f} ms",
+			stats.reads, stats.cacheHits, stats.prefetches, stats.stalls, static_cast<double>(stats.stallTimeNs) / 1000000.0);
+	}
+
 	Close2();
 }
 
+ThreadedFileReader::Stats ThreadedFileReader::GetStats() const
+{
+	Stats stats;
+	stats.reads = m_statReads.load(std::memory_order_relaxed);
+	stats.cacheHits = m_statCacheHits.load(std::memory_order_relaxed);
+	stats.prefetches = m_statPrefetches.load(std::memory_order_relaxed);
+	stats.stalls = m_statStalls.load(std::memory_order_relaxed);
+	stats.stallTimeNs = m_statStallTime.load(std::memory_order_relaxed);
+	return stats;
+}
+
 void ThreadedFileReader::SetBlockSize(u32 bytes)
 {
 	m_blocksize = bytes;
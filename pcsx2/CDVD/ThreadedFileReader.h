@@ -9,15 +9,35 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <memory>
+#include <vector>
 
 class Error;
 class ProgressCallback;
 
 /// A file reader for use with compressed formats
 /// Calls decompression code on a separate thread to make a synchronous decompression API async
+/// Formats which can decompress from several contexts at once also get a pool of prefetch workers,
+/// which fill the chunk cache ahead of the read position when the game is streaming sequentially
 class ThreadedFileReader
 {
 	ThreadedFileReader(ThreadedFileReader&&) = delete;
+public:
+	struct Stats
+	{
+		/// Number of ReadSync/BeginRead calls
+		u64 reads;
+		/// Reads which were served entirely from the chunk cache
+		u64 cacheHits;
+		/// Buffers filled by the prefetch workers
+		u64 prefetches;
+		/// Reads which had to wait for decompression
+		u64 stalls;
+		/// Total time spent waiting in those reads
+		u64 stallTimeNs;
+	};
+
 protected:
 	std::string m_filename;
 
@@ -37,6 +57,12 @@ protected:
 	/// Use to avoid overrunning stack because PCSX2 likes to allocate 2448-byte buffers
 	int m_internalBlockSize = 0;
 
+	/// Set by formats which can address the whole image in memory (e.g. memory mapped or precached)
+	/// Reads are then copied straight out of it on the calling thread, without going through the chunk cache or read thread
+	/// Only change while no reads are in flight, i.e. in Open2/Precache2/Close2
+	const u8* m_directData = nullptr;
+	u64 m_directSize = 0;
+
 	/// Get the block containing the given offset
 	virtual Chunk ChunkForOffset(u64 offset) = 0;
 	/// Synchronously read the given block into `dst`
@@ -47,6 +73,16 @@ protected:
 	virtual bool Precache2(ProgressCallback* progress, Error* error);
 	/// AsyncFileReader close but ThreadedFileReader needs prep work first
 	virtual void Close2() = 0;
+	/// Prepare `count` independent decompression contexts for ReadChunkOnWorker
+	/// Return false if the format can only be decompressed from one thread, which disables the prefetch workers
+	virtual bool OpenWorkerContexts(u32 count);
+	/// Release the contexts created by OpenWorkerContexts
+	virtual void CloseWorkerContexts();
+	/// Synchronously read the given block into `dst` using worker context `worker`
+	/// Called concurrently from the prefetch workers (each with its own context) and the read thread (using ReadChunk)
+	virtual int ReadChunkOnWorker(void* dst, s64 chunkID, u32 worker);
+	/// Called after each direct read with the range that was read, so the format can pass access pattern hints on
+	virtual void OnDirectRead(u64 offset, u32 size);
 	/// Checks system memory, to ensure that precaching would not exceed a reasonable amount.
 	bool CheckAvailableMemoryForPrecaching(u64 required_size, Error* error);
 
@@ -71,10 +107,23 @@ private:
 		u64 offset = 0;
 		std::atomic<u32> size{0};
 		u32 cap = 0;
+		/// Value of `m_useCounter` when this buffer was last filled or read from, the lowest is evicted first
+		u64 lastUse = 0;
+		/// End offset this buffer will reach once its prefetch completes, only valid while `pending`
+		u64 fillEnd = 0;
+		/// True while a prefetch worker owns this buffer, it must not be evicted until cleared
+		/// View while holding `m_mtx`
+		bool pending = false;
 	};
-	/// 2 buffers for readahead (current block, next block)
-	Buffer m_buffer[2];
-	u32 m_nextBuffer = 0;
+	struct PrefetchJob
+	{
+		Buffer* buf;
+		Chunk chunk;
+	};
+	/// Chunk cache, at least 2 buffers for readahead (current block, next block)
+	std::unique_ptr<Buffer[]> m_buffer;
+	u32 m_bufferCount = 0;
+	u64 m_useCounter = 0;
 
 	std::thread m_readThread;
 	std::mutex m_mtx;
@@ -85,6 +134,34 @@ private:
 	/// View while holding `m_mtx`.  If false, you may touch decompression functions from other threads
 	bool m_running = false;
 
+	/// End of the last request seen by the read thread, used to detect sequential access
+	u64 m_lastRequestEnd = 0;
+	/// Number of consecutive requests which continued on from the previous one
+	/// View while holding `m_mtx`
+	u32 m_sequentialRequests = 0;
+
+	/// Number of prefetch workers to use, 0 to do all decompression on the read thread
+	u32 m_workerCount = 0;
+	/// Workers are started on the first readahead, so readers which are only opened to look at a few sectors don't pay for them
+	/// Only touched by the read thread, or while it's stopped
+	bool m_workersStarted = false;
+	bool m_workersUnavailable = false;
+	std::vector<std::thread> m_workers;
+	std::condition_variable m_workerCondition;
+	std::deque<PrefetchJob> m_prefetchQueue;
+	/// Number of workers currently filling a buffer, view while holding `m_mtx`
+	u32 m_workersBusy = 0;
+	/// True to tell the workers to exit, view while holding `m_mtx`
+	bool m_workersQuit = false;
+	/// Used to stop in-progress prefetches early
+	std::atomic<bool> m_prefetchCancelled{false};
+
+	std::atomic<u64> m_statReads{0};
+	std::atomic<u64> m_statCacheHits{0};
+	std::atomic<u64> m_statPrefetches{0};
+	std::atomic<u64> m_statStalls{0};
+	std::atomic<u64> m_statStallTime{0};
+
 	/// Get the internal block size
 	u32 InternalBlockSize() const { return m_internalBlockSize ? m_internalBlockSize : m_blocksize; }
 	/// memcpy from internal to external blocks
@@ -92,8 +169,41 @@ private:
 	/// Returns the number of external block bytes copied
 	size_t CopyBlocks(void* dst, const void* src, size_t size) const;
 
+	/// Serve a read from `m_directData`
+	int DirectRead(void* dst, u64 offset, u32 size);
+
 	/// Main loop of read thread
 	void Loop();
+	/// Main loop of prefetch worker threads
+	void WorkerLoop(u32 worker);
+
+	/// Resize the chunk cache, must not be called while the read thread or workers are running
+	void AllocateBuffers(u32 count);
+	/// Pick the least recently used buffer that isn't being prefetched into
+	/// Call while holding `m_mtx`
+	Buffer* FindVictimBuffer();
+	/// Returns true if a prefetch worker is currently filling the chunk at `offset`
+	/// Call while holding `m_mtx`
+	bool IsPrefetchPending(u64 offset) const;
+	/// Find the buffer which contains, or is being prefetched to contain, `offset` and store where its data ends in `end`
+	/// Call while holding `m_mtx`
+	Buffer* FindBufferContaining(u64 offset, u64* end);
+	/// Count buffers containing consecutive data from `offset` onwards, including ones which are still being prefetched
+	/// Call while holding `m_mtx`
+	u32 CountBuffersFrom(u64 offset, u32 limit);
+	/// Number of buffers which should be kept filled past the read position
+	u32 GetReadaheadDepth() const;
+	/// Start the prefetch workers if they haven't been already
+	/// Returns false if this reader can't use them
+	bool StartWorkers();
+	/// Stop and join the prefetch workers, call after CancelAndWaitUntilStopped
+	void StopWorkers();
+	/// Queue prefetches so the buffer containing `offset` and the readahead depth after it are cached
+	void QueuePrefetch(u64 offset);
+	/// Drop any queued prefetches and wait for the workers to go idle
+	void CancelPrefetch(std::unique_lock<std::mutex>& lock);
+	/// Block until the current request has been completed by the read thread
+	void WaitForRequest();
 
 	/// Load the given block into one of the `m_buffer` buffers if necessary and return a pointer to its contents if successful
 	Buffer* GetBlockPtr(const Chunk& block);
@@ -111,6 +221,7 @@ public:
 
 	const std::string& GetFilename() const { return m_filename; }
 	u32 GetBlockSize() const { return m_blocksize; }
+	Stats GetStats() const;
 
 	virtual u32 GetBlockCount() const = 0;
 
@@ -42,13 +42,16 @@ Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
   - zlib include path and included Pcsx2Types.h for windows off_t (s64)
   - fseeko and off_t #define'ed for windows too (on windows off_t is 32b and no fseeko)
   - typedefs for struct access/point (Access/Point) and allocation type casts
-  - access: added members span and uncompressed_size which are filled by build_index.
+  - access: added members span and uncompressed_size, which the caller fills in once the index is built.
   - point and access packed for safety since they go to disk as is (but no endian-ness handling).
       But they're still aligned since each member size is multiple of 4, so no perf issues.
   - extract: added state import/export for instant sequential access regardless of index
       (Thanks to Mark Adler for suggesting the approach)
-  - build_index(...) - added progress prints
   - CHUNK changed from 16k to 512k
+  - build_index(...) replaced by build_index_with(...), which hands the access points and progress to
+      callbacks, so the caller can store them however it likes (and build in the background, cancelling
+      through the callbacks)
+  - extract_from(...) - extract starting from an explicit access point rather than an Access index
  */
 
 /* Illustrate the use of Z_BLOCK, inflatePrime(), and inflateSetDictionary()
@@ -63,11 +66,11 @@ Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
    the starting file offset and bit of that block, and the 32K bytes of
    uncompressed data that precede that block.  Also the uncompressed offset of
    that block is saved to provide a referece for locating a desired starting
-   point in the uncompressed stream.  build_index() works by decompressing the
-   input zlib or gzip stream a block at a time, and at the end of each block
+   point in the uncompressed stream.  build_index_with() works by decompressing
+   the input zlib or gzip stream a block at a time, and at the end of each block
    deciding if enough uncompressed data has gone by to justify the creation of
-   a new access point.  If so, that point is saved in a data structure that
-   grows as needed to accommodate the points.
+   a new access point.  If so, that point is handed to the caller's add_point
+   callback, which stores it however it likes.
 
    To use the index, an offset in the uncompressed data is provided, for which
    the latest accees point at or preceding that offset is located in the index.
@@ -135,7 +138,7 @@ struct access
 	struct point* list; /* allocated list */
 
 	s32 span;                   /* once the index is built, holds the span size used to build it */
-	s64 uncompressed_size; /* filled by build_index */
+	s64 uncompressed_size; /* total from build_index_with() */
 }
 #ifndef _WIN32
 __attribute__((packed))
@@ -148,7 +151,7 @@ typedef struct access Access;
 #pragma pack(pop, indexData)
 #endif
 
-/* Deallocate an index built by build_index() */
+/* Deallocate an index built with addpoint() */
 static inline void free_index(struct access* index)
 {
 	if (index != NULL)
@@ -158,6 +161,16 @@ static inline void free_index(struct access* index)
 	}
 }
 
+/* Copy the circular sliding window into dst so that it ends with the most recent
+   output byte, left is the number of bytes in window that haven't been written yet. */
+static inline void copy_window(unsigned char* dst, unsigned left, const unsigned char* window)
+{
+	if (left)
+		memcpy(dst, window + WINSIZE - left, left);
+	if (left < WINSIZE)
+		memcpy(dst + left, window, WINSIZE - left);
+}
+
 /* Add an entry to the access point list.  If out of memory, deallocate the
    existing list and return NULL. */
 static inline struct access* addpoint(struct access* index, int bits,
@@ -199,30 +212,32 @@ static inline struct access* addpoint(struct access* index, int bits,
 	next->bits = bits;
 	next->in = in;
 	next->out = out;
-	if (left)
-		memcpy(next->window, window + WINSIZE - left, left);
-	if (left < WINSIZE)
-		memcpy(next->window + left, window, WINSIZE - left);
+	copy_window(next->window, left, window);
 	index->have++;
 
 	/* return list, possibly reallocated */
 	return index;
 }
 
-/* Make one entire pass through the compressed stream and build an index, with
-   access points about every span bytes of uncompressed output -- span is
-   chosen to balance the speed of random access against the memory requirements
-   of the list, about 32K bytes per access point.  Note that data after the end
-   of the first zlib or gzip stream in the file is ignored.  build_index()
-   returns the number of access points on success (>= 1), Z_MEM_ERROR for out
-   of memory, Z_DATA_ERROR for an error in the input file, or Z_ERRNO for a
-   file read error.  On success, *built points to the resulting index. */
-static inline int build_index(FILE* in, s64 span, struct access** built)
+/* Callbacks for build_index_with().  add_point receives the same arguments as
+   addpoint(), use copy_window() to get the window out.  progress is called after
+   each CHUNK of input with the totals so far.  Returning nonzero from either one
+   stops the build, and build_index_with() returns that value. */
+typedef int (*index_point_fn)(void* ctx, int bits, s64 in, s64 out, unsigned left, unsigned char* window);
+typedef int (*index_progress_fn)(void* ctx, s64 in, s64 out);
+
+/* Make one entire pass through the compressed stream, calling add_point for
+   access points about every span bytes of uncompressed output.  Returns the
+   number of access points on success (>= 1) with the total uncompressed size in
+   *uncompressed_size, Z_DATA_ERROR for an error in the input file, Z_ERRNO for a
+   file read error, or whatever a callback returned to cancel the build. */
+static inline int build_index_with(FILE* in, s64 span, index_point_fn add_point, index_progress_fn progress,
+	void* ctx, s64* uncompressed_size)
 {
 	int ret;
-	s64 totin, totout, totPrinted; /* our own total counters to avoid 4GB limit */
+	int have;                      /* number of access points added */
+	s64 totin, totout;             /* our own total counters to avoid 4GB limit */
 	s64 last;                      /* totout value of last access point */
-	struct access* index;               /* access points being generated */
 	z_stream strm;
 	unsigned char input[CHUNK];
 	unsigned char window[WINSIZE];
@@ -240,8 +255,8 @@ static inline int build_index(FILE* in, s64 span, struct access** built)
 	/* inflate the input, maintain a sliding window, and build an index -- this
        also validates the integrity of the compressed data using the check
        information at the end of the gzip or zlib stream */
-	totin = totout = last = totPrinted = 0;
-	index = NULL; /* will be allocated by first addpoint() */
+	totin = totout = last = 0;
+	have = 0;
 	strm.avail_out = 0;
 	do
 	{
@@ -250,12 +265,12 @@ static inline int build_index(FILE* in, s64 span, struct access** built)
 		if (ferror(in))
 		{
 			ret = Z_ERRNO;
-			goto build_index_error;
+			goto build_index_with_ret;
 		}
 		if (strm.avail_in == 0)
 		{
 			ret = Z_DATA_ERROR;
-			goto build_index_error;
+			goto build_index_with_ret;
 		}
 		strm.next_in = input;
 
@@ -279,59 +294,38 @@ static inline int build_index(FILE* in, s64 span, struct access** built)
 			if (ret == Z_NEED_DICT)
 				ret = Z_DATA_ERROR;
 			if (ret == Z_MEM_ERROR || ret == Z_DATA_ERROR)
-				goto build_index_error;
+				goto build_index_with_ret;
 			if (ret == Z_STREAM_END)
 				break;
 
-			/* if at end of block, consider adding an index entry (note that if
-               data_type indicates an end-of-block, then all of the
-               uncompressed data from that block has been delivered, and none
-               of the compressed data after that block has been consumed,
-               except for up to seven bits) -- the totout == 0 provides an
-               entry point after the zlib or gzip header, and assures that the
-               index always has at least one access point; we avoid creating an
-               access point after the last block by checking bit 6 of data_type
-             */
+			/* if at end of block, consider adding an index entry (see above) */
 			if ((strm.data_type & 128) && !(strm.data_type & 64) &&
 				(totout == 0 || totout - last > span))
 			{
-				index = addpoint(index, strm.data_type & 7, totin,
-								 totout, strm.avail_out, window);
-				if (index == NULL)
-				{
-					ret = Z_MEM_ERROR;
-					goto build_index_error;
-				}
+				ret = add_point(ctx, strm.data_type & 7, totin, totout, strm.avail_out, window);
+				if (ret != 0)
+					goto build_index_with_ret;
+				have++;
 				last = totout;
 			}
 		} while (strm.avail_in != 0);
-		if (totin / (50 * 1024 * 1024) != totPrinted / (50 * 1024 * 1024))
+
+		if (progress && ret != Z_STREAM_END)
 		{
-			printf("%dMB ", (int)(totin / (1024 * 1024)));
-			totPrinted = totin;
+			const int cancel = progress(ctx, totin, totout);
+			if (cancel != 0)
+			{
+				ret = cancel;
+				goto build_index_with_ret;
+			}
 		}
 	} while (ret != Z_STREAM_END);
 
-	if (index == NULL)
-	{
-		// Could happen if the start of the stream in Z_STREAM_END
-		return 0;
-	}
+	*uncompressed_size = totout;
+	ret = have;
 
-	/* clean up and return index (release unused entries in list) */
-	(void)inflateEnd(&strm);
-	index->list = (Point*)realloc(index->list, sizeof(struct point) * index->have);
-	index->size = index->have;
-	index->span = span;
-	index->uncompressed_size = totout;
-	*built = index;
-	return index->have;
-
-	/* return error */
-build_index_error:
+build_index_with_ret:
 	(void)inflateEnd(&strm);
-	if (index != NULL)
-		free_index(index);
 	return ret;
 }
 
@@ -348,18 +342,16 @@ static inline s64 getInOffset(zstate* state)
 	return state->in_offset;
 }
 
-/* Use the index to read len bytes from offset into buf, return bytes read or
-   negative for error (Z_DATA_ERROR or Z_MEM_ERROR).  If data is requested past
-   the end of the uncompressed data, then extract() will return a value less
-   than len, indicating how much as actually read into buf.  This function
-   should not return a data error unless the file was modified since the index
-   was generated.  extract() may also return Z_ERRNO if there is an error on
-   reading or seeking the input file. */
-static inline int extract(FILE* in, struct access* index, s64 offset,
-				  unsigned char* buf, int len, zstate* state)
+/* Read len bytes from offset into buf, starting from the access point described
+   by point_out, point_in, point_bits and window (the 32K bytes of uncompressed
+   data preceding point_out).  The access point must be at or before offset.
+   window is only read if state can't simply continue from where it left off, so
+   callers that have to produce it on demand can check state first.  Returns the
+   same as extract(). */
+static inline int extract_from(FILE* in, s64 point_out, s64 point_in, int point_bits, const unsigned char* window,
+	s64 offset, unsigned char* buf, int len, zstate* state)
 {
 	int ret, skip;
-	struct point* here;
 	unsigned char input[CHUNK];
 	unsigned char discard[WINSIZE];
 	int isEnd = 0;
@@ -386,13 +378,7 @@ static inline int extract(FILE* in, struct access* index, s64 offset,
 	}
 	else
 	{
-		/* find where in stream to start */
-		here = index->list;
-		ret = index->have;
-		while (--ret && here[1].out <= offset)
-			here++;
-
-		/* initialize file and inflate state to start there */
+		/* initialize file and inflate state to start at the access point */
 		state->strm.zalloc = Z_NULL;
 		state->strm.zfree = Z_NULL;
 		state->strm.opaque = Z_NULL;
@@ -401,10 +387,10 @@ static inline int extract(FILE* in, struct access* index, s64 offset,
 		ret = inflateInit2(&state->strm, -15); /* raw inflate */
 		if (ret != Z_OK)
 			return ret;
-		ret = FileSystem::FSeek64(in, here->in - (here->bits ? 1 : 0), SEEK_SET);
+		ret = FileSystem::FSeek64(in, point_in - (point_bits ? 1 : 0), SEEK_SET);
 		if (ret == -1)
 			goto extract_ret;
-		if (here->bits)
+		if (point_bits)
 		{
 			ret = getc(in);
 			if (ret == -1)
@@ -412,12 +398,12 @@ static inline int extract(FILE* in, struct access* index, s64 offset,
 				ret = ferror(in) ? Z_ERRNO : Z_DATA_ERROR;
 				goto extract_ret;
 			}
-			inflatePrime(&state->strm, here->bits, ret >> (8 - here->bits));
+			inflatePrime(&state->strm, point_bits, ret >> (8 - point_bits));
 		}
-		inflateSetDictionary(&state->strm, here->window, WINSIZE);
+		inflateSetDictionary(&state->strm, window, WINSIZE);
 
 		/* skip uncompressed bytes until offset reached, then satisfy request */
-		offset -= here->out;
+		offset -= point_out;
 		state->strm.avail_in = 0;
 		skip = 1; /* while skipping to offset */
 	}
@@ -497,3 +483,25 @@ extract_ret:
 
 	return ret;
 }
+
+/* Use the index to read len bytes from offset into buf, return bytes read or
+   negative for error (Z_DATA_ERROR or Z_MEM_ERROR).  If data is requested past
+   the end of the uncompressed data, then extract() will return a value less
+   than len, indicating how much as actually read into buf.  This function
+   should not return a data error unless the file was modified since the index
+   was generated.  extract() may also return Z_ERRNO if there is an error on
+   reading or seeking the input file. */
+static inline int extract(FILE* in, struct access* index, s64 offset,
+				  unsigned char* buf, int len, zstate* state)
+{
+	int ret;
+	struct point* here;
+
+	/* find where in stream to start */
+	here = index->list;
+	ret = index->have;
+	while (--ret && here[1].out <= offset)
+		here++;
+
+	return extract_from(in, here->out, here->in, here->bits, here->window, offset, buf, len, state);
+}
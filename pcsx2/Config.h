@@ -478,7 +478,8 @@ struct Pcsx2Config
 			RecBlocks_EE : 1, // Enables per-block profiling for the EE recompiler [unimplemented]
 			RecBlocks_IOP : 1, // Enables per-block profiling for the IOP recompiler [unimplemented]
 			RecBlocks_VU0 : 1, // Enables per-block profiling for the VU0 recompiler [unimplemented]
-			RecBlocks_VU1 : 1; // Enables per-block profiling for the VU1 recompiler [unimplemented]
+			RecBlocks_VU1 : 1, // Enables per-block profiling for the VU1 recompiler [unimplemented]
+			PerfJitDump : 1; // Writes recompiled code to a jitdump for perf inject --jit (Linux only).
 		BITFIELD_END
 
 		// Default is Disabled, with all recs enabled underneath.
@@ -522,6 +523,8 @@ struct Pcsx2Config
 			EnableFastmem : 1;
 		bool
 			PauseOnTLBMiss : 1;
+		bool
+			EnableEETiering : 1;
 		BITFIELD_END
 
 		RecompilerOptions();
@@ -621,11 +624,14 @@ struct Pcsx2Config
 					OsdShowSettings : 1,
 					OsdShowInputs : 1,
 					OsdShowFrameTimes : 1,
+					OsdShowSMCStats : 1,
 					OsdShowVersion : 1,
 					HWSpinGPUForReadbacks : 1,
 					HWSpinCPUForReadbacks : 1,
 					GPUPaletteConversion : 1,
 					AutoFlushSW : 1,
+					SWTileBinning : 1,
+					SWDrawStats : 1,
 					PreloadFrameWithGSData : 1,
 					Mipmap : 1,
 					HWMipmap : 1,
@@ -806,6 +812,9 @@ struct Pcsx2Config
 		u32 OutputVolume = 100;
 		u32 FastForwardVolume = 100;
 		bool OutputMuted = false;
+		// Mixes on a separate thread. SPU2 interrupts raised while mixing are delivered when the CPU thread next
+		// catches up, so when they land in emulated time depends on host timing, and runs aren't deterministic.
+		bool AsyncMixing = false;
 
 		AudioBackend Backend = DEFAULT_BACKEND;
 		SPU2SyncMode SyncMode = DEFAULT_SYNC_MODE;
@@ -1122,6 +1131,7 @@ struct Pcsx2Config
 		CdvdVerboseReads : 1, // enables cdvd read activity verbosely dumped to the console
 		CdvdDumpBlocks : 1, // enables cdvd block dumping
 		CdvdPrecache : 1, // enables cdvd precaching of compressed images
+		CdvdMapFiles : 1, // reads uncompressed images through a memory mapping instead of file reads, off by default since I/O errors become crashes
 		EnablePatches : 1, // enables patch detection and application
 		EnableCheats : 1, // enables cheat detection and application
 		EnablePINE : 1, // enables inter-process communication
@@ -1138,6 +1148,7 @@ struct Pcsx2Config
 		InhibitScreensaver : 1,
 		BackupSavestate : 1,
 		SavestateZstdCompression : 1,
+		EnableRewind : 1, // keeps recent states in memory so the game can be stepped backwards
 		McdFolderAutoManage : 1,
 
 		HostFs : 1,
@@ -1167,6 +1178,10 @@ struct Pcsx2Config
 	// slots (3 each)
 	McdOptions Mcd[8];
 	std::string GzipIsoIndexTemplate; // for quick-access index with gzipped ISO
+	u32 CdvdReadCacheBuffers; // number of decompressed chunk buffers kept by compressed image readers
+	u32 CdvdDecompressThreads; // worker threads decompressing chunks ahead of the read position, 0 disables
+	u32 RewindFrameInterval; // frames between rewind captures
+	u32 RewindBufferSize; // memory for compressed rewind states, in megabytes, three uncompressed states are kept on top
 
 	int PINESlot;
 
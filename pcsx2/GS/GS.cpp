@@ -17,6 +17,7 @@
 #include "Input/InputManager.h"
 #include "MTGS.h"
 #include "pcsx2/GS.h"
+#include "GS/Renderers/Common/GSFunctionMap.h"
 #include "GS/Renderers/Null/GSRendererNull.h"
 #include "GS/Renderers/HW/GSRendererHW.h"
 #include "GS/Renderers/HW/GSTextureReplacements.h"
@@ -507,6 +508,8 @@ void GSGameChanged()
 {
 	if (GSIsHardwareRenderer())
 		GSTextureReplacements::GameChanged();
+	else
+		GSJitKeyCache::SetGame(VMManager::GetDiscCRC());
 
 	if (!VMManager::HasValidVM() && GSCapture::IsCapturing())
 		GSCapture::EndCapture();
@@ -716,6 +719,12 @@ void GSgetTitleStats(std::string& info)
 	info = StringUtil::StdStringFromFormat("%s%s | %s | %s | %s", api_name, hw_sw_name, video_mode, interlace_mode, deinterlace_mode);
 }
 
+void GSgetSWDrawStats(std::vector<GSFunctionMapStats>* stats)
+{
+	if (g_gs_renderer)
+		g_gs_renderer->GetDrawStats(*stats);
+}
+
 void GSUpdateConfig(const Pcsx2Config::GSOptions& new_config)
 {
 	Pcsx2Config::GSOptions old_config(std::move(GSConfig));
@@ -740,7 +749,9 @@ void GSUpdateConfig(const Pcsx2Config::GSOptions& new_config)
 
 	// Options which aren't using the global struct yet, so we need to recreate all GS objects.
 	if (GSConfig.SWExtraThreads != old_config.SWExtraThreads ||
-		GSConfig.SWExtraThreadsHeight != old_config.SWExtraThreadsHeight)
+		GSConfig.SWExtraThreadsHeight != old_config.SWExtraThreadsHeight ||
+		GSConfig.SWTileBinning != old_config.SWTileBinning ||
+		GSConfig.SWDrawStats != old_config.SWDrawStats)
 	{
 		if (!GSreopen(false, true, GSConfig.Renderer, &old_config))
 			pxFailRel("Failed to do quick GS reopen");
@@ -1054,6 +1065,7 @@ static void HotkeyToggleOSD()
 	GSConfig.OsdShowSettings ^= EmuConfig.GS.OsdShowSettings;
 	GSConfig.OsdShowInputs ^= EmuConfig.GS.OsdShowInputs;
 	GSConfig.OsdShowFrameTimes ^= EmuConfig.GS.OsdShowFrameTimes;
+	GSConfig.OsdShowSMCStats ^= EmuConfig.GS.OsdShowSMCStats;
 	GSConfig.OsdShowVersion ^= EmuConfig.GS.OsdShowVersion;
 }
 
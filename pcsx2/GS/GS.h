@@ -50,6 +50,7 @@ struct GSAdapterInfo
 };
 
 class SmallStringBase;
+struct GSFunctionMapStats;
 
 // Returns the ID for the specified function, otherwise -1.
 s16 GSLookupGetSkipCountFunctionId(const std::string_view name);
@@ -99,6 +100,9 @@ void GSgetStats(SmallStringBase& info);
 void GSgetMemoryStats(SmallStringBase& info);
 void GSgetTitleStats(std::string& info);
 
+/// Returns per-selector draw statistics from the software renderer. Only collected when sw_draw_stats is enabled.
+void GSgetSWDrawStats(std::vector<GSFunctionMapStats>* stats);
+
 /// Converts window position to normalized display coordinates (0..1). A value less than 0 or greater than 1 is
 /// returned if the position lies outside the display area.
 void GSTranslateWindowToDisplayCoordinates(float window_x, float window_y, float* display_x, float* display_y);
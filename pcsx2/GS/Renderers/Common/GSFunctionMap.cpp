@@ -2,8 +2,17 @@
 // SPDX-License-Identifier: GPL-3.0+
 
 #include "GS/Renderers/Common/GSFunctionMap.h"
+#include "Config.h"
 #include "Memory.h"
 
+#include "common/Console.h"
+#include "common/FileSystem.h"
+#include "common/Path.h"
+
+#include "fmt/format.h"
+
+#include <unordered_set>
+
 namespace GSCodeReserve
 {
 	static u8* s_memory_base;
@@ -11,6 +20,33 @@ namespace GSCodeReserve
 	static u8* s_memory_ptr;
 }
 
+namespace GSJitKeyCache
+{
+	static constexpr u32 FILE_MAGIC = 0x4B4A5753; // SWJK
+	static constexpr u32 FILE_VERSION = 1;
+
+	struct FileHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 counts[static_cast<u32>(Map::Count)];
+	};
+
+	struct KeyList
+	{
+		std::vector<u64> keys;
+		std::unordered_set<u64> lookup;
+	};
+
+	static std::string GetCachePath(u32 crc);
+	static void Load();
+
+	static KeyList s_keys[static_cast<u32>(Map::Count)];
+	static u32 s_crc = 0;
+	static u32 s_generation = 0;
+	static bool s_dirty = false;
+}
+
 void GSCodeReserve::ResetMemory()
 {
 	s_memory_base = SysMemory::GetSWRec();
@@ -23,6 +59,11 @@ size_t GSCodeReserve::GetMemoryUsed()
 	return s_memory_ptr - s_memory_base;
 }
 
+size_t GSCodeReserve::GetMemoryAvailable()
+{
+	return s_memory_end - s_memory_ptr;
+}
+
 u8* GSCodeReserve::ReserveMemory(size_t size)
 {
 	pxAssert((s_memory_ptr + size) <= s_memory_end);
@@ -34,3 +75,121 @@ void GSCodeReserve::CommitMemory(size_t size)
 	pxAssert((s_memory_ptr + size) <= s_memory_end);
 	s_memory_ptr += size;
 }
+
+std::string GSJitKeyCache::GetCachePath(u32 crc)
+{
+	return Path::Combine(EmuFolders::Cache, fmt::format("swjit_{:08X}.keys", crc));
+}
+
+void GSJitKeyCache::SetGame(u32 crc)
+{
+	if (s_crc == crc)
+		return;
+
+	Flush();
+
+	for (KeyList& list : s_keys)
+	{
+		list.keys.clear();
+		list.lookup.clear();
+	}
+
+	s_crc = crc;
+	s_generation++;
+	if (s_crc != 0)
+		Load();
+}
+
+void GSJitKeyCache::Load()
+{
+	const std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(GetCachePath(s_crc).c_str());
+	if (!data.has_value())
+		return;
+
+	FileHeader header;
+	if (data->size() < sizeof(header))
+		return;
+
+	std::memcpy(&header, data->data(), sizeof(header));
+	if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+	{
+		Console.Warning("(GSJitKeyCache) Ignoring out of date key cache for %08X.", s_crc);
+		return;
+	}
+
+	size_t total = 0;
+	for (u32 count : header.counts)
+		total += count;
+	if (data->size() != (sizeof(header) + total * sizeof(u64)))
+	{
+		Console.Warning("(GSJitKeyCache) Key cache for %08X is truncated.", s_crc);
+		return;
+	}
+
+	const u8* ptr = data->data() + sizeof(header);
+	for (u32 i = 0; i < static_cast<u32>(Map::Count); i++)
+	{
+		KeyList& list = s_keys[i];
+		list.keys.resize(header.counts[i]);
+		std::memcpy(list.keys.data(), ptr, header.counts[i] * sizeof(u64));
+		list.lookup.insert(list.keys.begin(), list.keys.end());
+		ptr += header.counts[i] * sizeof(u64);
+	}
+
+	DevCon.WriteLn("(GSJitKeyCache) Loaded %zu keys for %08X.", total, s_crc);
+}
+
+u32 GSJitKeyCache::GetGameGeneration()
+{
+	return s_generation;
+}
+
+const std::vector<u64>& GSJitKeyCache::GetKeys(Map map)
+{
+	return s_keys[static_cast<u32>(map)].keys;
+}
+
+void GSJitKeyCache::AddKey(Map map, u64 key)
+{
+	if (s_crc == 0)
+		return;
+
+	KeyList& list = s_keys[static_cast<u32>(map)];
+	if (!list.lookup.insert(key).second)
+		return;
+
+	list.keys.push_back(key);
+	s_dirty = true;
+}
+
+void GSJitKeyCache::Flush()
+{
+	if (!s_dirty || s_crc == 0)
+		return;
+
+	s_dirty = false;
+
+	FileHeader header;
+	header.magic = FILE_MAGIC;
+	header.version = FILE_VERSION;
+
+	size_t total = 0;
+	for (u32 i = 0; i < static_cast<u32>(Map::Count); i++)
+	{
+		header.counts[i] = static_cast<u32>(s_keys[i].keys.size());
+		total += s_keys[i].keys.size();
+	}
+
+	std::vector<u8> data(sizeof(header) + total * sizeof(u64));
+	std::memcpy(data.data(), &header, sizeof(header));
+
+	u8* ptr = data.data() + sizeof(header);
+	for (const KeyList& list : s_keys)
+	{
+		std::memcpy(ptr, list.keys.data(), list.keys.size() * sizeof(u64));
+		ptr += list.keys.size() * sizeof(u64);
+	}
+
+	if (!FileSystem::WriteBinaryFile(GetCachePath(s_crc).c_str(), data.data(), data.size()))
+		Console.Error("(GSJitKeyCache) Failed to write key cache for %08X.", s_crc);
+}
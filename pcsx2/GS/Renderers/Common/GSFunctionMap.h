@@ -9,6 +9,39 @@
 #include "common/HostSys.h"
 
 #include <cinttypes>
+#include <unordered_map>
+#include <vector>
+
+/// Per-key draw statistics, as collected by GSFunctionMap.
+struct GSFunctionMapStats
+{
+	u64 key;
+	u64 frames, prims;
+	u64 ticks, actual, total;
+};
+
+/// Draw statistics gathered by a single rasterizer thread. Each thread keeps its own, and they're added
+/// to the function map with GSFunctionMap::MergeStats() while the threads are idle, so drawing doesn't
+/// need to take a lock.
+struct GSFunctionMapThreadStats
+{
+	struct Entry
+	{
+		u64 prims;
+		u64 ticks, actual, total;
+	};
+
+	std::unordered_map<u64, Entry> entries;
+
+	void Update(u64 key, u64 ticks, int actual, int total, int prims)
+	{
+		Entry& e = entries[key];
+		e.prims += prims;
+		e.ticks += ticks;
+		e.actual += actual;
+		e.total += total;
+	}
+};
 
 template <class KEY, class VALUE>
 class GSFunctionMap
@@ -21,6 +54,7 @@ protected:
 		VALUE f;
 	};
 
+	// Only accessed from the owner thread, rasterizer threads collect stats in GSFunctionMapThreadStats.
 	std::unordered_map<KEY, ActivePtr*> m_map_active;
 
 	ActivePtr* m_active;
@@ -67,22 +101,44 @@ public:
 		return m_active->f;
 	}
 
-	void UpdateStats(u64 frame, u64 ticks, int actual, int total, int prims)
+	/// Counts the frame towards the function last returned by operator[].
+	void UpdateFrame(u64 frame)
 	{
-		if (m_active)
+		if (m_active && m_active->frame != frame)
 		{
-			if (m_active->frame != frame)
-			{
-				m_active->frame = frame;
-				m_active->frames++;
-			}
+			m_active->frame = frame;
+			m_active->frames++;
+		}
+	}
 
-			m_active->prims += prims;
-			m_active->ticks += ticks;
-			m_active->actual += actual;
-			m_active->total += total;
+	/// Adds a rasterizer thread's stats to the totals and clears them. The thread must not be drawing.
+	void MergeStats(GSFunctionMapThreadStats& thread_stats)
+	{
+		for (const auto& [key, e] : thread_stats.entries)
+		{
+			auto it = m_map_active.find(static_cast<KEY>(key));
+			if (it == m_map_active.end())
+				continue;
+
+			ActivePtr* p = it->second;
+			p->prims += e.prims;
+			p->ticks += e.ticks;
+			p->actual += e.actual;
+			p->total += e.total;
 
-			pxAssert(m_active->total >= m_active->actual);
+			pxAssert(p->total >= p->actual);
+		}
+
+		thread_stats.entries.clear();
+	}
+
+	void GetStats(std::vector<GSFunctionMapStats>& stats)
+	{
+		for (const auto& i : m_map_active)
+		{
+			const ActivePtr* p = i.second;
+			if (p->frames && p->actual)
+				stats.push_back({static_cast<u64>(i.first), p->frames, p->prims, p->ticks, p->actual, p->total});
 		}
 	}
 
@@ -143,21 +199,82 @@ namespace GSCodeReserve
 
 	size_t GetMemoryUsed();
 
+	size_t GetMemoryAvailable();
+
 	u8* ReserveMemory(size_t size);
 	void CommitMemory(size_t size);
 }
 
+// --------------------------------------------------------------------------------------
+//  GSJitKeyCache
+// --------------------------------------------------------------------------------------
+// Remembers which keys each game (by disc CRC) generated code for, so the code can be
+// generated in one go when the game starts, instead of the first time a draw needs it.
+//
+namespace GSJitKeyCache
+{
+	enum class Map : u8
+	{
+		SetupPrim,
+		DrawScanline,
+		Count
+	};
+
+	/// Switches to the keys for the given CRC, saving new keys for the previous game. Zero disables recording.
+	void SetGame(u32 crc);
+
+	/// Incremented each time the game changes, so renderers know to precompile again.
+	u32 GetGameGeneration();
+
+	/// Returns the keys recorded for the current game.
+	const std::vector<u64>& GetKeys(Map map);
+
+	/// Records a key which code was generated for on demand.
+	void AddKey(Map map, u64 key);
+
+	/// Saves new keys for the current game to the cache directory.
+	void Flush();
+}
+
 template <class CG, class KEY, class VALUE>
 class GSCodeGeneratorFunctionMap : public GSFunctionMap<KEY, VALUE>
 {
 	std::string m_name;
 	std::unordered_map<u64, VALUE> m_cgmap;
+	GSJitKeyCache::Map m_cache_map;
 
 	enum { MAX_SIZE = 8192 };
 
+	VALUE Generate(KEY key)
+	{
+		HostSys::BeginCodeWrite();
+
+		u8* code_ptr = GSCodeReserve::ReserveMemory(MAX_SIZE);
+		CG cg(key, code_ptr, MAX_SIZE);
+		cg.Generate();
+		pxAssert(cg.GetSize() < MAX_SIZE);
+
+#if 0
+		fprintf(stderr, "%s Location:%p Size:%zu Key:%llx\n", m_name.c_str(), code_ptr, cg.getSize(), (u64)key);
+		GSScanlineSelector sel(key);
+		sel.Print();
+#endif
+
+		const u32 size = static_cast<u32>(cg.GetSize());
+		GSCodeReserve::CommitMemory(size);
+
+		HostSys::EndCodeWrite();
+		HostSys::FlushInstructionCache(code_ptr, static_cast<u32>(size));
+
+		VALUE ret = (VALUE)cg.GetCode();
+		m_cgmap[key] = ret;
+		return ret;
+	}
+
 public:
-	GSCodeGeneratorFunctionMap(std::string name)
+	GSCodeGeneratorFunctionMap(std::string name, GSJitKeyCache::Map cache_map)
 		: m_name(name)
+		, m_cache_map(cache_map)
 	{
 	}
 
@@ -170,40 +287,25 @@ public:
 
 	VALUE GetDefaultFunction(KEY key)
 	{
-		VALUE ret = nullptr;
-
 		auto i = m_cgmap.find(key);
-
 		if (i != m_cgmap.end())
-		{
-			ret = i->second;
-		}
-		else
-		{
-			HostSys::BeginCodeWrite();
-
-			u8* code_ptr = GSCodeReserve::ReserveMemory(MAX_SIZE);
-			CG cg(key, code_ptr, MAX_SIZE);
-			cg.Generate();
-			pxAssert(cg.GetSize() < MAX_SIZE);
+			return i->second;
 
-#if 0
-			fprintf(stderr, "%s Location:%p Size:%zu Key:%llx\n", m_name.c_str(), code_ptr, cg.getSize(), (u64)key);
-			GSScanlineSelector sel(key);
-			sel.Print();
-#endif
-
-			const u32 size = static_cast<u32>(cg.GetSize());
-			GSCodeReserve::CommitMemory(size);
-
-			HostSys::EndCodeWrite();
-			HostSys::FlushInstructionCache(code_ptr, static_cast<u32>(size));
+		GSJitKeyCache::AddKey(m_cache_map, static_cast<u64>(key));
+		return Generate(key);
+	}
 
-			ret = (VALUE)cg.GetCode();
+	/// Generates code for a key ahead of its first use. Returns false if the code space is running out.
+	bool Precompile(KEY key)
+	{
+		if (m_cgmap.find(key) != m_cgmap.end())
+			return true;
 
-			m_cgmap[key] = ret;
-		}
+		// Leave room for keys we haven't seen before.
+		if (GSCodeReserve::GetMemoryAvailable() < (MAX_SIZE * 256))
+			return false;
 
-		return ret;
+		Generate(key);
+		return true;
 	}
 };
@@ -7,6 +7,8 @@
 #include <memory>
 #include <string>
 
+struct GSFunctionMapStats;
+
 class GSRenderer : public GSState
 {
 private:
@@ -49,6 +51,7 @@ public:
 	virtual bool CanUpscale() { return false; }
 	virtual float GetUpscaleMultiplier() { return 1.0f; }
 	virtual float GetTextureScaleFactor() { return 1.0f; }
+	virtual void GetDrawStats(std::vector<GSFunctionMapStats>& stats) {}
 	GSVector2i GetInternalResolution();
 	float GetModXYOffset();
 
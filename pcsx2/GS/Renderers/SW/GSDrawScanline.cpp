@@ -5,8 +5,10 @@
 #include "GS/Renderers/SW/GSTextureCacheSW.h"
 #include "GS/Renderers/SW/GSScanlineEnvironment.h"
 #include "GS/Renderers/SW/GSRasterizer.h"
+#include "VMManager.h"
 
 #include "common/Console.h"
+#include "common/Timer.h"
 
 #include <fstream>
 
@@ -26,14 +28,17 @@ static __forceinline const GSScanlineGlobalData& GlobalFromLocal(const GSScanlin
 }
 
 GSDrawScanline::GSDrawScanline()
-	: m_sp_map("GSSetupPrim")
-	, m_ds_map("GSDrawScanline")
+	: m_sp_map("GSSetupPrim", GSJitKeyCache::Map::SetupPrim)
+	, m_ds_map("GSDrawScanline", GSJitKeyCache::Map::DrawScanline)
 {
 	GSCodeReserve::ResetMemory();
+	GSJitKeyCache::SetGame(VMManager::GetDiscCRC());
 }
 
 GSDrawScanline::~GSDrawScanline()
 {
+	GSJitKeyCache::Flush();
+
 	if (const size_t used = GSCodeReserve::GetMemoryUsed(); used > 0)
 		DevCon.WriteLn("SW JIT generated %zu bytes of code", used);
 }
@@ -120,14 +125,48 @@ void GSDrawScanline::ResetCodeCache()
 	GSCodeReserve::ResetMemory();
 }
 
+void GSDrawScanline::PrecompileRecordedKeys()
+{
+	m_precompiled_generation = GSJitKeyCache::GetGameGeneration();
+
+	const std::vector<u64>& sp_keys = GSJitKeyCache::GetKeys(GSJitKeyCache::Map::SetupPrim);
+	const std::vector<u64>& ds_keys = GSJitKeyCache::GetKeys(GSJitKeyCache::Map::DrawScanline);
+	if (sp_keys.empty() && ds_keys.empty())
+		return;
+
+	Common::Timer timer;
+	u32 count = 0;
+
+	for (const u64 key : ds_keys)
+	{
+		if (!m_ds_map.Precompile(key))
+			break;
+		count++;
+	}
+
+	for (const u64 key : sp_keys)
+	{
+		if (!m_sp_map.Precompile(key))
+			break;
+		count++;
+	}
+
+	DevCon.WriteLn("SW JIT precompiled %u of %zu recorded functions in %.2f ms", count,
+		sp_keys.size() + ds_keys.size(), timer.GetTimeMilliseconds());
+}
+
 bool GSDrawScanline::SetupDraw(GSRasterizerData& data)
 {
 	const GSScanlineGlobalData& global = data.global;
 
 #ifdef ENABLE_JIT_RASTERIZER
+	if (m_precompiled_generation != GSJitKeyCache::GetGameGeneration()) [[unlikely]]
+		PrecompileRecordedKeys();
+
 	data.draw_scanline = m_ds_map[global.sel];
 	if (!data.draw_scanline) [[unlikely]]
 		return false;
+	m_ds_map.UpdateFrame(data.frame);
 
 	if (global.sel.aa1)
 	{
@@ -173,9 +212,9 @@ bool GSDrawScanline::SetupDraw(GSRasterizerData& data)
 #endif
 }
 
-void GSDrawScanline::UpdateDrawStats(u64 frame, u64 ticks, int actual, int total, int prims)
+void GSDrawScanline::MergeDrawStats(GSFunctionMapThreadStats& stats)
 {
-	m_ds_map.UpdateStats(frame, ticks, actual, total, prims);
+	m_ds_map.MergeStats(stats);
 }
 
 void GSDrawScanline::PrintStats()
@@ -183,6 +222,11 @@ void GSDrawScanline::PrintStats()
 	m_ds_map.PrintStats();
 }
 
+void GSDrawScanline::GetStats(std::vector<GSFunctionMapStats>& stats)
+{
+	m_ds_map.GetStats(stats);
+}
+
 #if _M_SSE >= 0x501
 typedef GSVector8i VectorI;
 typedef GSVector8  VectorF;
@@ -39,6 +39,9 @@ public:
 	/// Flushes the code cache, forcing everything to be recompiled.
 	void ResetCodeCache();
 
+	/// Generates code for every key the current game used in previous sessions.
+	void PrecompileRecordedKeys();
+
 	/// Populates function pointers. If this returns false, we ran out of code space.
 	bool SetupDraw(GSRasterizerData& data);
 
@@ -48,12 +51,15 @@ public:
 	/// Not currently jitted.
 	static void DrawRect(const GSVector4i& r, const GSVertexSW& v, GSScanlineLocalData& local);
 
-	void UpdateDrawStats(u64 frame, u64 ticks, int actual, int total, int prims);
+	/// Adds a rasterizer's draw stats to the totals, the rasterizer must be idle.
+	void MergeDrawStats(GSFunctionMapThreadStats& stats);
 	void PrintStats();
+	void GetStats(std::vector<GSFunctionMapStats>& stats);
 
 private:
 	GSCodeGeneratorFunctionMap<GSSetupPrimCodeGenerator, u64, SetupPrimPtr> m_sp_map;
 	GSCodeGeneratorFunctionMap<GSDrawScanlineCodeGenerator, u64, DrawScanlinePtr> m_ds_map;
+	u32 m_precompiled_generation = 0;
 
 	static void CSetupPrim(const GSVertexSW* vertex, const u16* index, const GSVertexSW& dscan, GSScanlineLocalData& local);
 	static void CDrawScanline(int pixels, int left, int top, const GSVertexSW& scan, GSScanlineLocalData& local);
@@ -13,6 +13,8 @@
 #include "common/Console.h"
 #include "common/StringUtil.h"
 
+#include <bit>
+
 #define ENABLE_DRAW_STATS 0
 
 MULTI_ISA_UNSHARED_IMPL;
@@ -38,6 +40,7 @@ GSRasterizer::GSRasterizer(GSDrawScanline* ds, int id, int threads)
 	, m_id(id)
 	, m_threads(threads)
 	, m_scanmsk_value(0)
+	, m_draw_stats(ENABLE_DRAW_STATS || GSConfig.SWDrawStats)
 {
 	memset(&m_pixels, 0, sizeof(m_pixels));
 	m_primcount = 0;
@@ -132,8 +135,7 @@ void GSRasterizer::Draw(GSRasterizerData& data)
 	m_pixels.total = 0;
 	m_primcount = 0;
 
-	if constexpr (ENABLE_DRAW_STATS)
-		data.start = GetCPUTicks();
+	const u64 start = m_draw_stats ? GetCPUTicks() : 0;
 
 	m_setup_prim = data.setup_prim;
 	m_draw_scanline = data.draw_scanline;
@@ -245,8 +247,8 @@ void GSRasterizer::Draw(GSRasterizerData& data)
 
 	m_pixels.sum += m_pixels.actual;
 
-	if constexpr (ENABLE_DRAW_STATS)
-		m_ds->UpdateDrawStats(data.frame, GetCPUTicks() - data.start, m_pixels.actual, m_pixels.total, m_primcount);
+	if (m_draw_stats)
+		m_stats.Update(data.global.sel.key, GetCPUTicks() - start, m_pixels.actual, m_pixels.total, m_primcount);
 }
 
 template <bool scissor_test>
@@ -1182,27 +1184,44 @@ int GSSingleRasterizer::GetPixels(bool reset /*= true*/)
 void GSSingleRasterizer::PrintStats()
 {
 #ifdef ENABLE_DRAW_STATS
+	m_ds.MergeDrawStats(m_r.GetDrawStats());
 	m_ds.PrintStats();
 #endif
 }
 
+void GSSingleRasterizer::GetDrawStats(std::vector<GSFunctionMapStats>& stats)
+{
+	m_ds.MergeDrawStats(m_r.GetDrawStats());
+	m_ds.GetStats(stats);
+}
+
 //
 
-GSRasterizerList::GSRasterizerList(int threads)
+GSRasterizerList::GSRasterizerList(int threads, int queues)
+	: m_num_queues(queues)
 {
 	m_thread_height = compute_best_thread_height(threads);
 
 	const int rows = (2048 >> m_thread_height) + 16;
 	m_scanline = static_cast<u8*>(_aligned_malloc(rows, 64));
 
+	// Maps each band of scanlines to the worker (or bin) which draws it.
 	for (int i = 0; i < rows; i++)
 	{
-		m_scanline[i] = static_cast<u8>(i % threads);
+		m_scanline[i] = static_cast<u8>(i % queues);
 	}
 
 	PerformanceMetrics::SetGSSWThreadCount(threads);
 }
 
+GSRasterizerList::BinWorker::~BinWorker()
+{
+	exit.store(true, std::memory_order_relaxed);
+	sema.NotifyOfWork();
+	if (thread.joinable())
+		thread.join();
+}
+
 GSRasterizerList::~GSRasterizerList()
 {
 	PerformanceMetrics::SetGSSWThreadCount(0);
@@ -1227,6 +1246,62 @@ void GSRasterizerList::OnWorkerShutdown(int i)
 {
 }
 
+void GSRasterizerList::BinWorkerThread(int i, u64 affinity)
+{
+	OnWorkerStartup(i, affinity);
+
+	BinWorker& worker = *m_bin_workers[i];
+	for (;;)
+	{
+		worker.sema.WaitForWorkWithSpin();
+		if (worker.exit.load(std::memory_order_relaxed))
+			break;
+
+		u32 bin_index;
+		while (ClaimBin(worker, &bin_index))
+			DrawBin(bin_index);
+	}
+
+	OnWorkerShutdown(i);
+}
+
+bool GSRasterizerList::ClaimBin(const BinWorker& worker, u32* bin_index)
+{
+	u64 ready = m_ready_bins.load(std::memory_order_relaxed);
+	while (ready != 0)
+	{
+		// Prefer our own bins, otherwise steal from another worker. Each worker starts looking from a
+		// different bin so they don't all fight over the same one.
+		const u64 home = ready & worker.home_bins;
+		const u32 bit = (home != 0) ? static_cast<u32>(std::countr_zero(home)) :
+			((static_cast<u32>(std::countr_zero(std::rotr(ready, worker.steal_shift))) + worker.steal_shift) % MAX_BINS);
+		const u64 mask = static_cast<u64>(1) << bit;
+
+		ready = m_ready_bins.fetch_and(~mask, std::memory_order_acquire);
+		if (ready & mask)
+		{
+			*bin_index = bit;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void GSRasterizerList::DrawBin(u32 bin_index)
+{
+	Bin& bin = *m_bins[bin_index];
+	GSRasterizer& r = *m_r[bin_index];
+	auto draw = [&r](GSRingHeap::SharedPtr<GSRasterizerData>& item) { r.Draw(*item.get()); };
+
+	// Keep going until the queue is drained, including anything added while we were drawing.
+	do
+	{
+		[[maybe_unused]] const bool consumed = bin.queue.consume_one(draw);
+		pxAssert(consumed);
+	} while (bin.pending.fetch_sub(1, std::memory_order_acq_rel) != 1);
+}
+
 void GSRasterizerList::Queue(const GSRingHeap::SharedPtr<GSRasterizerData>& data)
 {
 	GSVector4i r = data->bbox.rintersect(data->scissor);
@@ -1241,11 +1316,37 @@ void GSRasterizerList::Queue(const GSRingHeap::SharedPtr<GSRasterizerData>& data
 	pxAssert(r.top >= 0 && r.top < 2048 && r.bottom >= 0 && r.bottom < 2048);
 
 	int top = r.top >> m_thread_height;
-	int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + m_workers.size());
+	int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + m_num_queues);
+
+	if (m_bins.empty())
+	{
+		while (top < bottom)
+		{
+			m_workers[m_scanline[top++]]->Push(data);
+		}
+
+		return;
+	}
 
+	u64 ready = 0;
 	while (top < bottom)
 	{
-		m_workers[m_scanline[top++]]->Push(data);
+		const u32 bin_index = m_scanline[top++];
+		Bin& bin = *m_bins[bin_index];
+		while (!bin.queue.push(data))
+			std::this_thread::yield();
+
+		if (bin.pending.fetch_add(1, std::memory_order_acq_rel) == 0)
+			ready |= static_cast<u64>(1) << bin_index;
+	}
+
+	if (ready != 0)
+	{
+		m_ready_bins.fetch_or(ready, std::memory_order_release);
+
+		// Wake everyone, idle workers will steal bins if the owner is busy.
+		for (const std::unique_ptr<BinWorker>& worker : m_bin_workers)
+			worker->sema.NotifyOfWork();
 	}
 }
 
@@ -1258,6 +1359,11 @@ void GSRasterizerList::Sync()
 			m_workers[i]->Wait();
 		}
 
+		for (const std::unique_ptr<BinWorker>& worker : m_bin_workers)
+		{
+			worker->sema.WaitForEmptyWithSpin();
+		}
+
 		g_perfmon.Put(GSPerfMon::SyncPoint, 1);
 	}
 }
@@ -1272,6 +1378,14 @@ bool GSRasterizerList::IsSynced() const
 		}
 	}
 
+	for (const std::unique_ptr<Bin>& bin : m_bins)
+	{
+		if (bin->pending.load(std::memory_order_acquire) != 0)
+		{
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -1279,7 +1393,7 @@ int GSRasterizerList::GetPixels(bool reset)
 {
 	int pixels = 0;
 
-	for (size_t i = 0; i < m_workers.size(); i++)
+	for (size_t i = 0; i < m_r.size(); i++)
 	{
 		pixels += m_r[i]->GetPixels(reset);
 	}
@@ -1296,13 +1410,44 @@ std::unique_ptr<IRasterizer> GSRasterizerList::Create(int threads)
 		return std::make_unique<GSSingleRasterizer>();
 	}
 
-	std::unique_ptr<GSRasterizerList> rl(new GSRasterizerList(threads));
-
 	const std::vector<u32>& procs = VMManager::Internal::GetSoftwareRendererProcessorList();
 	const bool pin = (EmuConfig.EnableThreadPinning && static_cast<size_t>(threads) <= procs.size());
 	if (EmuConfig.EnableThreadPinning && !pin)
 		WARNING_LOG("Not pinning SW threads, we need {} processors, but only have {}", threads, procs.size());
 
+	if (GSConfig.SWTileBinning)
+	{
+		const int bins = std::min<int>(threads, MAX_BINS);
+		std::unique_ptr<GSRasterizerList> rl(new GSRasterizerList(threads, bins));
+
+		for (int i = 0; i < bins; i++)
+		{
+			rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(&rl->m_ds, i, bins)));
+			rl->m_bins.push_back(std::make_unique<Bin>());
+		}
+
+		for (int i = 0; i < threads; i++)
+		{
+			std::unique_ptr<BinWorker> worker = std::make_unique<BinWorker>();
+			for (int j = i; j < bins; j += threads)
+				worker->home_bins |= static_cast<u64>(1) << j;
+			worker->steal_shift = static_cast<u32>((i * bins) / threads);
+			rl->m_bin_workers.push_back(std::move(worker));
+		}
+
+		// Start the threads once every worker exists, since they can steal from each other.
+		for (int i = 0; i < threads; i++)
+		{
+			const u64 affinity = pin ? (static_cast<u64>(1u) << procs[i]) : 0;
+			rl->m_bin_workers[i]->thread = std::thread(&GSRasterizerList::BinWorkerThread, rl.get(), i, affinity);
+		}
+
+		DevCon.WriteLn("GS SW: Using tile binning with %d bins over %d threads", bins, threads);
+		return rl;
+	}
+
+	std::unique_ptr<GSRasterizerList> rl(new GSRasterizerList(threads, threads));
+
 	for (int i = 0; i < threads; i++)
 	{
 		const u64 affinity = pin ? (static_cast<u64>(1u) << procs[i]) : 0;
@@ -1320,3 +1465,12 @@ std::unique_ptr<IRasterizer> GSRasterizerList::Create(int threads)
 void GSRasterizerList::PrintStats()
 {
 }
+
+void GSRasterizerList::GetDrawStats(std::vector<GSFunctionMapStats>& stats)
+{
+	// Callers sync first, so the workers aren't touching their stats.
+	for (const std::unique_ptr<GSRasterizer>& r : m_r)
+		m_ds.MergeDrawStats(r->GetDrawStats());
+
+	m_ds.GetStats(stats);
+}
@@ -73,12 +73,14 @@ protected:
 	int m_thread_height;
 	u8* m_scanline;
 	u8 m_scanmsk_value;
+	bool m_draw_stats;
 	GSVector4i m_scissor;
 	GSVector4 m_fscissor_x;
 	GSVector4 m_fscissor_y;
 	struct { GSVertexSW* buff; int count; } m_edge;
 	struct { int sum, actual, total; } m_pixels;
 	int m_primcount;
+	GSFunctionMapThreadStats m_stats;
 
 	// For the current draw.
 	GSScanlineLocalData m_local = {};
@@ -118,6 +120,9 @@ public:
 
 	void Draw(GSRasterizerData& data);
 	int GetPixels(bool reset);
+
+	/// Stats for the draws since they were last merged, only safe to touch while the rasterizer is idle.
+	GSFunctionMapThreadStats& GetDrawStats() { return m_stats; }
 };
 
 class IRasterizer : public GSVirtualAlignedClass<32>
@@ -130,6 +135,7 @@ public:
 	virtual bool IsSynced() const = 0;
 	virtual int GetPixels(bool reset = true) = 0;
 	virtual void PrintStats() = 0;
+	virtual void GetDrawStats(std::vector<GSFunctionMapStats>& stats) = 0;
 };
 
 class GSSingleRasterizer final : public IRasterizer
@@ -143,6 +149,7 @@ public:
 	bool IsSynced() const override;
 	int GetPixels(bool reset = true) override;
 	void PrintStats() override;
+	void GetDrawStats(std::vector<GSFunctionMapStats>& stats) override;
 
 	void Draw(GSRasterizerData& data);
 
@@ -156,19 +163,57 @@ class GSRasterizerList final : public IRasterizer
 protected:
 	using GSWorker = GSJobQueue<GSRingHeap::SharedPtr<GSRasterizerData>, 65536>;
 
+	/// Maximum number of bins in tile binning mode, limited by the width of the ready mask.
+	static constexpr u32 MAX_BINS = 64;
+
+	/// In tile binning mode, each bin is a set of interleaved scanline bands with its own rasterizer
+	/// and queue of draws. A bin is only ever drawn by one worker at a time, so draw order is kept
+	/// within each bin, but any idle worker can pick up a bin which has pending work.
+	/// There's one bin per thread: every bin's rasterizer walks (and sets up) each primitive of the
+	/// draws queued to it, so splitting the bands any finer multiplies the per-primitive work.
+	struct alignas(64) Bin
+	{
+		ringbuffer_base<GSRingHeap::SharedPtr<GSRasterizerData>, 4096> queue;
+
+		/// Number of draws queued but not yet finished. Whichever worker claims the bin when this goes
+		/// from zero to one owns it until it drops back to zero.
+		std::atomic<u32> pending{0};
+	};
+
+	struct BinWorker
+	{
+		std::thread thread;
+		Threading::WorkSema sema;
+		u64 home_bins = 0;
+		u32 steal_shift = 0;
+		std::atomic<bool> exit{false};
+
+		~BinWorker();
+	};
+
 	GSDrawScanline m_ds;
 
 	// Worker threads depend on the rasterizers, so don't change the order.
 	std::vector<std::unique_ptr<GSRasterizer>> m_r;
+	std::vector<std::unique_ptr<Bin>> m_bins;
 	std::vector<std::unique_ptr<GSWorker>> m_workers;
+	std::vector<std::unique_ptr<BinWorker>> m_bin_workers;
 	u8* m_scanline;
 	int m_thread_height;
+	int m_num_queues;
 
-	GSRasterizerList(int threads);
+	/// Bit set for each bin with pending draws that no worker has claimed yet.
+	alignas(64) std::atomic<u64> m_ready_bins{0};
+
+	GSRasterizerList(int threads, int queues);
 
 	static void OnWorkerStartup(int i, u64 affinity);
 	static void OnWorkerShutdown(int i);
 
+	void BinWorkerThread(int i, u64 affinity);
+	bool ClaimBin(const BinWorker& worker, u32* bin_index);
+	void DrawBin(u32 bin_index);
+
 public:
 	~GSRasterizerList() override;
 
@@ -181,6 +226,7 @@ public:
 	bool IsSynced() const override;
 	int GetPixels(bool reset) override;
 	void PrintStats() override;
+	void GetDrawStats(std::vector<GSFunctionMapStats>& stats) override;
 };
 
 MULTI_ISA_UNSHARED_END
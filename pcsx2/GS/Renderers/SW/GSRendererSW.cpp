@@ -52,6 +52,13 @@ void GSRendererSW::Reset(bool hardware_reset)
 	GSRenderer::Reset(hardware_reset);
 }
 
+void GSRendererSW::GetDrawStats(std::vector<GSFunctionMapStats>& stats)
+{
+	// Stats are updated by the rasterizer threads when each draw completes.
+	m_rl->Sync();
+	m_rl->GetDrawStats(stats);
+}
+
 void GSRendererSW::Destroy()
 {
 	// Need to destroy worker queue first to stop any pending thread work
@@ -86,6 +86,8 @@ public:
 	__fi static GSRendererSW* GetInstance() { return static_cast<GSRendererSW*>(g_gs_renderer.get()); }
 
 	void Destroy() override;
+
+	void GetDrawStats(std::vector<GSFunctionMapStats>& stats) override;
 };
 
 MULTI_ISA_UNSHARED_END
@@ -3,8 +3,10 @@
 
 #include "GameDatabase.h"
 #include "GS/GS.h"
+#include "GS/GSXXH.h"
 #include "Host.h"
 #include "IconsFontAwesome5.h"
+#include "svnrev.h"
 #include "vtlb.h"
 
 #include "common/Console.h"
@@ -20,9 +22,11 @@
 #include "ryml.hpp"
 #include "fmt/core.h"
 #include "fmt/ranges.h"
+#include <algorithm>
 #include <fstream>
 #include <mutex>
 #include <optional>
+#include <type_traits>
 
 namespace GameDatabaseSchema
 {
@@ -35,13 +39,124 @@ namespace GameDatabase
 {
 	static void parseAndInsert(const std::string_view serial, const c4::yml::NodeRef& node);
 	static void initDatabase();
+	static bool loadIndex(const std::string& path, u64 source_hash);
+	static void writeIndex(const std::string& path, u64 source_hash);
+	static bool readIndexEntry(const std::string_view serial, GameDatabaseSchema::GameEntry* entry);
+	static u64 getBuildHash();
 } // namespace GameDatabase
 
+namespace
+{
+	// Binary form of the GameDB, so it doesn't have to be parsed from YAML on every launch.
+	// Laid out as the header, the serial table sorted by serial, the serial string pool, then the entries.
+	// Entries store enum values directly, so the index is only valid for the build which wrote it.
+	struct GameDBIndexHeader
+	{
+		char magic[8];
+		u32 version;
+		u32 num_serials;
+		u64 source_hash; // XXH3 of the YAML the index was built from
+		u64 build_hash;
+		u64 strings_size;
+		u64 records_size;
+	};
+
+	struct GameDBIndexSerial
+	{
+		u32 serial_offset;
+		u32 serial_length;
+		u32 record_offset;
+		u32 record_size;
+	};
+
+	class IndexWriter
+	{
+	public:
+		const std::vector<u8>& GetData() const { return m_data; }
+
+		void Write(const void* data, size_t size)
+		{
+			const u8* bytes = static_cast<const u8*>(data);
+			m_data.insert(m_data.end(), bytes, bytes + size);
+		}
+
+		template <typename T>
+		void WriteValue(T value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			Write(&value, sizeof(value));
+		}
+
+		void WriteString(const std::string_view str)
+		{
+			WriteValue(static_cast<u32>(str.size()));
+			Write(str.data(), str.size());
+		}
+
+	private:
+		std::vector<u8> m_data;
+	};
+
+	class IndexReader
+	{
+	public:
+		IndexReader(const u8* data, size_t size)
+			: m_ptr(data)
+			, m_end(data + size)
+		{
+		}
+
+		bool Read(void* data, size_t size)
+		{
+			if (static_cast<size_t>(m_end - m_ptr) < size)
+				return false;
+
+			if (size > 0)
+				std::memcpy(data, m_ptr, size);
+			m_ptr += size;
+			return true;
+		}
+
+		template <typename T>
+		bool ReadValue(T* value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			return Read(value, sizeof(T));
+		}
+
+		bool ReadString(std::string* str)
+		{
+			u32 size;
+			if (!ReadValue(&size) || static_cast<size_t>(m_end - m_ptr) < size)
+				return false;
+
+			str->assign(reinterpret_cast<const char*>(m_ptr), size);
+			m_ptr += size;
+			return true;
+		}
+
+	private:
+		const u8* m_ptr;
+		const u8* m_end;
+	};
+} // namespace
+
 static constexpr char GAMEDB_YAML_FILE_NAME[] = "GameIndex.yaml";
+static constexpr char GAMEDB_INDEX_FILE_NAME[] = "gamedb.cache";
+static constexpr char GAMEDB_INDEX_MAGIC[8] = {'P', 'C', 'S', 'X', '2', 'G', 'D', 'B'};
+static constexpr u32 GAMEDB_INDEX_VERSION = 1;
 
+// When the index is mapped, this only holds the entries which have been looked up so far.
 static std::unordered_map<std::string, GameDatabaseSchema::GameEntry> s_game_db;
 static std::once_flag s_load_once_flag;
 
+static FileSystem::MappedFile s_index_file;
+static const GameDBIndexSerial* s_index_serials = nullptr;
+static const char* s_index_strings = nullptr;
+static const u8* s_index_records = nullptr;
+static u32 s_index_num_serials = 0;
+static std::mutex s_index_mutex;
+
 std::string GameDatabaseSchema::GameEntry::memcardFiltersAsString() const
 {
 	return fmt::to_string(fmt::join(memcardFilters, "/"));
@@ -941,6 +1056,19 @@ void GameDatabaseSchema::GameEntry::applyGSHardwareFixes(Pcsx2Config::GSOptions&
 
 void GameDatabase::initDatabase()
 {
+	auto buf = FileSystem::ReadFileToString(Path::Combine(EmuFolders::Resources, GAMEDB_YAML_FILE_NAME).c_str());
+	if (!buf.has_value())
+	{
+		Console.Error("[GameDB] Unable to open GameDB file, file does not exist.");
+		return;
+	}
+
+	// Hashing the YAML is far cheaper than parsing it, and catches edits that keep the size and timestamp.
+	const u64 source_hash = GSXXH3_64bits(buf->data(), buf->size());
+	const std::string index_path = EmuFolders::Cache.empty() ? std::string() : Path::Combine(EmuFolders::Cache, GAMEDB_INDEX_FILE_NAME);
+	if (!index_path.empty() && loadIndex(index_path, source_hash))
+		return;
+
 	ryml::Callbacks rymlCallbacks = ryml::get_callbacks();
 	rymlCallbacks.m_error = [](const char* msg, size_t msg_len, ryml::Location loc, void* userdata) {
 		Console.Error(fmt::format("[GameDB YAML] Parsing error at {}:{} (bufpos={}): {}",
@@ -951,13 +1079,6 @@ void GameDatabase::initDatabase()
 		Console.Error(fmt::format("[GameDB YAML] Internal Parsing error: {}", std::string_view(msg, msg_size)));
 	});
 
-	auto buf = FileSystem::ReadFileToString(Path::Combine(EmuFolders::Resources, GAMEDB_YAML_FILE_NAME).c_str());
-	if (!buf.has_value())
-	{
-		Console.Error("[GameDB] Unable to open GameDB file, file does not exist.");
-		return;
-	}
-
 	ryml::Tree tree = ryml::parse_in_arena(c4::to_csubstr(buf.value()));
 	ryml::NodeRef root = tree.rootref();
 
@@ -982,6 +1103,243 @@ void GameDatabase::initDatabase()
 	}
 
 	ryml::reset_callbacks();
+
+	if (!index_path.empty() && !s_game_db.empty())
+		writeIndex(index_path, source_hash);
+}
+
+u64 GameDatabase::getBuildHash()
+{
+	return GSXXH3_64bits(GIT_REV, std::strlen(GIT_REV));
+}
+
+bool GameDatabase::loadIndex(const std::string& path, u64 source_hash)
+{
+	FileSystem::MappedFile file;
+	if (!file.Open(path.c_str()))
+		return false;
+
+	GameDBIndexHeader header;
+	if (file.GetSize() < sizeof(header))
+	{
+		Console.Error(fmt::format("[GameDB] Invalid index size: {}", file.GetSize()));
+		return false;
+	}
+
+	std::memcpy(&header, file.GetData(), sizeof(header));
+	if (std::memcmp(header.magic, GAMEDB_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != GAMEDB_INDEX_VERSION ||
+		header.build_hash != getBuildHash())
+	{
+		Console.Warning("[GameDB] Index is from a different version, it will be rebuilt.");
+		return false;
+	}
+
+	if (header.source_hash != source_hash)
+	{
+		Console.Warning("[GameDB] Index is out of date, it will be rebuilt.");
+		return false;
+	}
+
+	const u64 serials_size = static_cast<u64>(header.num_serials) * sizeof(GameDBIndexSerial);
+	if (sizeof(header) + serials_size + header.strings_size + header.records_size != file.GetSize())
+	{
+		Console.Error(fmt::format("[GameDB] Unexpected size of index: '{}'.", path));
+		return false;
+	}
+
+	const GameDBIndexSerial* serials = reinterpret_cast<const GameDBIndexSerial*>(file.GetData() + sizeof(header));
+	const char* strings = reinterpret_cast<const char*>(file.GetData() + sizeof(header) + serials_size);
+	for (u32 i = 0; i < header.num_serials; i++)
+	{
+		const GameDBIndexSerial& serial = serials[i];
+		if (static_cast<u64>(serial.serial_offset) + serial.serial_length > header.strings_size ||
+			static_cast<u64>(serial.record_offset) + serial.record_size > header.records_size ||
+			(i > 0 && std::string_view(strings + serial.serial_offset, serial.serial_length) <=
+						  std::string_view(strings + serials[i - 1].serial_offset, serials[i - 1].serial_length)))
+		{
+			Console.Error(fmt::format("[GameDB] Corrupted index: '{}'.", path));
+			return false;
+		}
+	}
+
+	// Lookups land all over the place.
+	file.Advise(0, file.GetSize(), FileSystem::MappedFile::AccessPattern::Random);
+
+	s_index_serials = serials;
+	s_index_strings = strings;
+	s_index_records = reinterpret_cast<const u8*>(strings + header.strings_size);
+	s_index_num_serials = header.num_serials;
+	s_index_file = std::move(file);
+	return true;
+}
+
+void GameDatabase::writeIndex(const std::string& path, u64 source_hash)
+{
+	std::vector<const std::pair<const std::string, GameDatabaseSchema::GameEntry>*> games;
+	games.reserve(s_game_db.size());
+	for (const auto& it : s_game_db)
+		games.push_back(&it);
+	std::sort(games.begin(), games.end(), [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+
+	std::vector<GameDBIndexSerial> serials;
+	std::string strings;
+	IndexWriter records;
+	serials.reserve(games.size());
+	for (const auto* it : games)
+	{
+		const GameDatabaseSchema::GameEntry& entry = it->second;
+		GameDBIndexSerial& serial = serials.emplace_back();
+		serial.serial_offset = static_cast<u32>(strings.size());
+		serial.serial_length = static_cast<u32>(it->first.size());
+		serial.record_offset = static_cast<u32>(records.GetData().size());
+		strings.append(it->first);
+
+		records.WriteString(entry.name);
+		records.WriteString(entry.name_sort);
+		records.WriteString(entry.name_en);
+		records.WriteString(entry.region);
+		records.WriteValue(entry.compat);
+		records.WriteValue(entry.eeRoundMode);
+		records.WriteValue(entry.eeDivRoundMode);
+		records.WriteValue(entry.vu0RoundMode);
+		records.WriteValue(entry.vu1RoundMode);
+		records.WriteValue(entry.eeClampMode);
+		records.WriteValue(entry.vu0ClampMode);
+		records.WriteValue(entry.vu1ClampMode);
+
+		records.WriteValue(static_cast<u32>(entry.gameFixes.size()));
+		for (const GamefixId id : entry.gameFixes)
+			records.WriteValue(id);
+
+		records.WriteValue(static_cast<u32>(entry.speedHacks.size()));
+		for (const auto& [id, value] : entry.speedHacks)
+		{
+			records.WriteValue(id);
+			records.WriteValue(static_cast<s32>(value));
+		}
+
+		records.WriteValue(static_cast<u32>(entry.gsHWFixes.size()));
+		for (const auto& [id, value] : entry.gsHWFixes)
+		{
+			records.WriteValue(id);
+			records.WriteValue(value);
+		}
+
+		records.WriteValue(static_cast<u32>(entry.memcardFilters.size()));
+		for (const std::string& filter : entry.memcardFilters)
+			records.WriteString(filter);
+
+		records.WriteValue(static_cast<u32>(entry.patches.size()));
+		for (const auto& [crc, patch] : entry.patches)
+		{
+			records.WriteValue(crc);
+			records.WriteString(patch);
+		}
+
+		records.WriteValue(static_cast<u32>(entry.dynaPatches.size()));
+		for (const Patch::DynamicPatch& patch : entry.dynaPatches)
+		{
+			records.WriteValue(static_cast<u32>(patch.pattern.size()));
+			records.Write(patch.pattern.data(), patch.pattern.size() * sizeof(Patch::DynamicPatchEntry));
+			records.WriteValue(static_cast<u32>(patch.replacement.size()));
+			records.Write(patch.replacement.data(), patch.replacement.size() * sizeof(Patch::DynamicPatchEntry));
+		}
+
+		serial.record_size = static_cast<u32>(records.GetData().size()) - serial.record_offset;
+	}
+
+	GameDBIndexHeader header = {};
+	std::memcpy(header.magic, GAMEDB_INDEX_MAGIC, sizeof(header.magic));
+	header.version = GAMEDB_INDEX_VERSION;
+	header.num_serials = static_cast<u32>(serials.size());
+	header.source_hash = source_hash;
+	header.build_hash = getBuildHash();
+	header.strings_size = strings.size();
+	header.records_size = records.GetData().size();
+
+	auto fp = FileSystem::OpenManagedCFile(path.c_str(), "wb");
+	const bool success = fp &&
+						 std::fwrite(&header, sizeof(header), 1, fp.get()) == 1 &&
+						 std::fwrite(serials.data(), sizeof(GameDBIndexSerial), serials.size(), fp.get()) == serials.size() &&
+						 std::fwrite(strings.data(), strings.size(), 1, fp.get()) == 1 &&
+						 std::fwrite(records.GetData().data(), records.GetData().size(), 1, fp.get()) == 1 &&
+						 std::fflush(fp.get()) == 0;
+	if (!success)
+	{
+		Console.Error(fmt::format("[GameDB] Failed to write index to '{}'.", path));
+		fp.reset();
+		FileSystem::DeleteFilePath(path.c_str());
+	}
+}
+
+bool GameDatabase::readIndexEntry(const std::string_view serial, GameDatabaseSchema::GameEntry* entry)
+{
+	const GameDBIndexSerial* end = s_index_serials + s_index_num_serials;
+	const GameDBIndexSerial* it = std::lower_bound(s_index_serials, end, serial, [](const GameDBIndexSerial& lhs, const std::string_view rhs) {
+		return std::string_view(s_index_strings + lhs.serial_offset, lhs.serial_length) < rhs;
+	});
+	if (it == end || std::string_view(s_index_strings + it->serial_offset, it->serial_length) != serial)
+		return false;
+
+	IndexReader reader(s_index_records + it->record_offset, it->record_size);
+	bool okay = reader.ReadString(&entry->name) && reader.ReadString(&entry->name_sort) &&
+				reader.ReadString(&entry->name_en) && reader.ReadString(&entry->region) &&
+				reader.ReadValue(&entry->compat) && reader.ReadValue(&entry->eeRoundMode) &&
+				reader.ReadValue(&entry->eeDivRoundMode) && reader.ReadValue(&entry->vu0RoundMode) &&
+				reader.ReadValue(&entry->vu1RoundMode) && reader.ReadValue(&entry->eeClampMode) &&
+				reader.ReadValue(&entry->vu0ClampMode) && reader.ReadValue(&entry->vu1ClampMode);
+
+	u32 count = 0;
+	okay = okay && reader.ReadValue(&count);
+	for (u32 i = 0; okay && i < count; i++)
+		okay = reader.ReadValue(&entry->gameFixes.emplace_back());
+
+	okay = okay && reader.ReadValue(&count);
+	for (u32 i = 0; okay && i < count; i++)
+	{
+		auto& [id, value] = entry->speedHacks.emplace_back();
+		s32 svalue = 0;
+		okay = reader.ReadValue(&id) && reader.ReadValue(&svalue);
+		value = svalue;
+	}
+
+	okay = okay && reader.ReadValue(&count);
+	for (u32 i = 0; okay && i < count; i++)
+	{
+		auto& [id, value] = entry->gsHWFixes.emplace_back();
+		okay = reader.ReadValue(&id) && reader.ReadValue(&value);
+	}
+
+	okay = okay && reader.ReadValue(&count);
+	for (u32 i = 0; okay && i < count; i++)
+		okay = reader.ReadString(&entry->memcardFilters.emplace_back());
+
+	okay = okay && reader.ReadValue(&count);
+	for (u32 i = 0; okay && i < count; i++)
+	{
+		u32 crc = 0;
+		std::string patch;
+		okay = reader.ReadValue(&crc) && reader.ReadString(&patch);
+		entry->patches.emplace(crc, std::move(patch));
+	}
+
+	okay = okay && reader.ReadValue(&count);
+	for (u32 i = 0; okay && i < count; i++)
+	{
+		Patch::DynamicPatch& patch = entry->dynaPatches.emplace_back();
+		u32 num_entries = 0;
+		okay = reader.ReadValue(&num_entries);
+		patch.pattern.resize(okay ? num_entries : 0);
+		okay = okay && reader.Read(patch.pattern.data(), num_entries * sizeof(Patch::DynamicPatchEntry)) &&
+			   reader.ReadValue(&num_entries);
+		patch.replacement.resize(okay ? num_entries : 0);
+		okay = okay && reader.Read(patch.replacement.data(), num_entries * sizeof(Patch::DynamicPatchEntry));
+	}
+
+	if (!okay)
+		Console.Error(fmt::format("[GameDB] Corrupted index entry for serial '{}'.", serial));
+
+	return okay;
 }
 
 void GameDatabase::ensureLoaded()
@@ -990,7 +1348,9 @@ void GameDatabase::ensureLoaded()
 		Common::Timer timer;
 		Console.WriteLn(fmt::format("[GameDB] Has not been initialized yet, initializing..."));
 		initDatabase();
-		Console.WriteLn("[GameDB] %zu games on record (loaded in %.2fms)", s_game_db.size(), timer.GetTimeMilliseconds());
+		Console.WriteLn("[GameDB] %zu games on record (loaded from %s in %.2fms)",
+			s_index_file.IsOpen() ? static_cast<size_t>(s_index_num_serials) : s_game_db.size(),
+			s_index_file.IsOpen() ? "index" : "YAML", timer.GetTimeMilliseconds());
 	});
 }
 
@@ -998,8 +1358,25 @@ const GameDatabaseSchema::GameEntry* GameDatabase::findGame(const std::string_vi
 {
 	GameDatabase::ensureLoaded();
 
-	auto iter = s_game_db.find(StringUtil::toLower(serial));
-	return (iter != s_game_db.end()) ? &iter->second : nullptr;
+	std::string lserial = StringUtil::toLower(serial);
+	if (!s_index_file.IsOpen())
+	{
+		auto iter = s_game_db.find(lserial);
+		return (iter != s_game_db.end()) ? &iter->second : nullptr;
+	}
+
+	// Entries are read out of the index the first time they're asked for. The map never drops them,
+	// so the returned pointers stay valid, but it does need protecting from concurrent lookups.
+	std::unique_lock lock(s_index_mutex);
+	auto iter = s_game_db.find(lserial);
+	if (iter != s_game_db.end())
+		return &iter->second;
+
+	GameDatabaseSchema::GameEntry entry;
+	if (!readIndexEntry(lserial, &entry))
+		return nullptr;
+
+	return &s_game_db.emplace(std::move(lserial), std::move(entry)).first->second;
 }
 
 bool GameDatabase::TrackHash::parseHash(const std::string_view str)
@@ -1046,6 +1423,22 @@ struct TrackHashHasher
 };
 
 static constexpr char HASHDB_YAML_FILE_NAME[] = "RedumpDatabase.yaml";
+static constexpr char HASHDB_INDEX_FILE_NAME[] = "redump.cache";
+static constexpr char HASHDB_INDEX_MAGIC[8] = {'P', 'C', 'S', 'X', '2', 'R', 'D', 'B'};
+static constexpr u32 HASHDB_INDEX_VERSION = 1;
+
+namespace
+{
+	struct HashDBIndexHeader
+	{
+		char magic[8];
+		u32 version;
+		u32 num_entries;
+		u64 source_hash; // XXH3 of the YAML the index was built from
+		u64 data_size;
+	};
+} // namespace
+
 std::unordered_map<GameDatabase::TrackHash, u32, TrackHashHasher> s_track_hash_to_entry_map;
 std::vector<GameDatabase::HashDatabaseEntry> s_hash_database;
 
@@ -1095,11 +1488,123 @@ static bool parseHashDatabaseEntry(const c4::yml::NodeRef& node)
 	return true;
 }
 
+// Rebuilding the lookup tables from the flat index is a few allocations per entry, instead of a YAML parse.
+static bool loadHashIndex(const std::string& path, u64 source_hash)
+{
+	FileSystem::MappedFile file;
+	if (!file.Open(path.c_str()))
+		return false;
+
+	HashDBIndexHeader header;
+	if (file.GetSize() < sizeof(header))
+	{
+		Console.Error(fmt::format("[HashDatabase] Invalid index size: {}", file.GetSize()));
+		return false;
+	}
+
+	std::memcpy(&header, file.GetData(), sizeof(header));
+	if (std::memcmp(header.magic, HASHDB_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != HASHDB_INDEX_VERSION ||
+		header.source_hash != source_hash)
+	{
+		Console.Warning("[HashDatabase] Index is out of date, it will be rebuilt.");
+		return false;
+	}
+
+	if (sizeof(header) + header.data_size != file.GetSize())
+	{
+		Console.Error(fmt::format("[HashDatabase] Unexpected size of index: '{}'.", path));
+		return false;
+	}
+
+	file.Advise(0, file.GetSize(), FileSystem::MappedFile::AccessPattern::Sequential);
+
+	IndexReader reader(file.GetData() + sizeof(header), header.data_size);
+	s_hash_database.reserve(header.num_entries);
+	for (u32 i = 0; i < header.num_entries; i++)
+	{
+		GameDatabase::HashDatabaseEntry entry;
+		u32 num_tracks = 0;
+		if (!reader.ReadString(&entry.serial) || !reader.ReadString(&entry.name) || !reader.ReadString(&entry.version) ||
+			!reader.ReadValue(&num_tracks))
+		{
+			break;
+		}
+
+		entry.tracks.resize(num_tracks);
+		if (!reader.Read(entry.tracks.data(), num_tracks * sizeof(GameDatabase::TrackHash)))
+			break;
+
+		for (const GameDatabase::TrackHash& th : entry.tracks)
+			s_track_hash_to_entry_map.emplace(th, i);
+
+		s_hash_database.push_back(std::move(entry));
+	}
+
+	if (s_hash_database.size() != header.num_entries)
+	{
+		Console.Error(fmt::format("[HashDatabase] Corrupted index: '{}'.", path));
+		s_track_hash_to_entry_map.clear();
+		s_hash_database.clear();
+		return false;
+	}
+
+	return true;
+}
+
+static void writeHashIndex(const std::string& path, u64 source_hash)
+{
+	IndexWriter data;
+	for (const GameDatabase::HashDatabaseEntry& entry : s_hash_database)
+	{
+		data.WriteString(entry.serial);
+		data.WriteString(entry.name);
+		data.WriteString(entry.version);
+		data.WriteValue(static_cast<u32>(entry.tracks.size()));
+		data.Write(entry.tracks.data(), entry.tracks.size() * sizeof(GameDatabase::TrackHash));
+	}
+
+	HashDBIndexHeader header = {};
+	std::memcpy(header.magic, HASHDB_INDEX_MAGIC, sizeof(header.magic));
+	header.version = HASHDB_INDEX_VERSION;
+	header.num_entries = static_cast<u32>(s_hash_database.size());
+	header.source_hash = source_hash;
+	header.data_size = data.GetData().size();
+
+	auto fp = FileSystem::OpenManagedCFile(path.c_str(), "wb");
+	const bool success = fp &&
+						 std::fwrite(&header, sizeof(header), 1, fp.get()) == 1 &&
+						 std::fwrite(data.GetData().data(), data.GetData().size(), 1, fp.get()) == 1 &&
+						 std::fflush(fp.get()) == 0;
+	if (!success)
+	{
+		Console.Error(fmt::format("[HashDatabase] Failed to write index to '{}'.", path));
+		fp.reset();
+		FileSystem::DeleteFilePath(path.c_str());
+	}
+}
+
 bool GameDatabase::loadHashDatabase()
 {
 	if (!s_hash_database.empty())
 		return true;
 
+	Common::Timer load_timer;
+
+	auto buf = FileSystem::ReadFileToString(Path::Combine(EmuFolders::Resources, HASHDB_YAML_FILE_NAME).c_str());
+	if (!buf.has_value())
+	{
+		Console.Error("[GameDB] Unable to open hash database file, file does not exist.");
+		return false;
+	}
+
+	const u64 source_hash = GSXXH3_64bits(buf->data(), buf->size());
+	const std::string index_path = EmuFolders::Cache.empty() ? std::string() : Path::Combine(EmuFolders::Cache, HASHDB_INDEX_FILE_NAME);
+	if (!index_path.empty() && loadHashIndex(index_path, source_hash))
+	{
+		Console.WriteLn(Color_StrongGreen, "[HashDatabase] Loaded index in %.0f ms", load_timer.GetTimeMilliseconds());
+		return true;
+	}
+
 	ryml::Callbacks rymlCallbacks = ryml::get_callbacks();
 	rymlCallbacks.m_error = [](const char* msg, size_t msg_len, ryml::Location loc, void*) {
 		Console.Error(fmt::format(
@@ -1110,15 +1615,6 @@ bool GameDatabase::loadHashDatabase()
 		Console.Error(fmt::format("[HashDatabase YAML] Internal Parsing error: {}", std::string_view(msg, msg_size)));
 	});
 
-	Common::Timer load_timer;
-
-	auto buf = FileSystem::ReadFileToString(Path::Combine(EmuFolders::Resources, HASHDB_YAML_FILE_NAME).c_str());
-	if (!buf.has_value())
-	{
-		Console.Error("[GameDB] Unable to open hash database file, file does not exist.");
-		return false;
-	}
-
 	ryml::Tree tree = ryml::parse_in_arena(c4::to_csubstr(buf.value()));
 	ryml::NodeRef root = tree.rootref();
 
@@ -1140,6 +1636,9 @@ bool GameDatabase::loadHashDatabase()
 		return false;
 	}
 
+	if (!index_path.empty())
+		writeHashIndex(index_path, source_hash);
+
 	Console.WriteLn(Color_StrongGreen, "[HashDatabase] Loaded YAML in %.0f ms", load_timer.GetTimeMilliseconds());
 	return true;
 }
@@ -17,18 +17,24 @@
 #include "common/Path.h"
 #include "common/ProgressCallback.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
 
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <condition_variable>
 #include <cstdio>
 #include <ctime>
 #include <fstream>
+#include <mutex>
 #include <string_view>
+#include <thread>
 #include <utility>
 
 #ifdef _WIN32
 #include "common/RedtapeWindows.h"
+#else
+#include <sys/stat.h>
 #endif
 
 namespace GameList
@@ -38,6 +44,11 @@ namespace GameList
 		GAME_LIST_CACHE_SIGNATURE = 0x45434C47,
 		GAME_LIST_CACHE_VERSION = 34,
 
+		// Scanning is mostly waiting on I/O, so this isn't tied to the number of CPUs.
+		MAX_SCAN_THREADS = 8,
+
+		// More than a few outstanding requests just makes a single disk seek back and forth.
+		MAX_SCANS_PER_DEVICE = 4,
 
 		PLAYED_TIME_SERIAL_LENGTH = 32,
 		PLAYED_TIME_LAST_TIME_LENGTH = 20, // uint64
@@ -51,6 +62,12 @@ namespace GameList
 		std::time_t total_played_time;
 	};
 
+	struct ScanRequest
+	{
+		std::string path;
+		std::time_t timestamp;
+	};
+
 	using CacheMap = UnorderedStringMap<Entry>;
 	using PlayedTimeMap = UnorderedStringMap<PlayedTimeEntry>;
 
@@ -64,6 +81,9 @@ namespace GameList
 	static bool GetGameListEntryFromCache(const std::string& path, GameList::Entry* entry);
 	static void ScanDirectory(const char* path, bool recursive, bool only_cache, const std::vector<std::string>& excluded_paths,
 		const PlayedTimeMap& played_time_map, const INISettingsInterface& custom_attributes_ini, ProgressCallback* progress);
+	static void ScanFiles(std::vector<ScanRequest> requests, u32 progress_base, const PlayedTimeMap& played_time_map,
+		const INISettingsInterface& custom_attributes_ini, ProgressCallback* progress);
+	static std::string GetDeviceKey(const std::string& directory);
 	static bool AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map);
 	static bool ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
 		const PlayedTimeMap& played_time_map, const INISettingsInterface& custom_attributes_ini);
@@ -160,18 +180,14 @@ bool GameList::GetIsoSerialAndCRC(const std::string& path, s32* disc_type, std::
 {
 	Error error;
 
-	// This isn't great, we really want to make it all thread-local...
-	CDVD = &CDVDapi_Iso;
-	if (!CDVD->open(path, &error))
+	// Doesn't go through the global CDVD object, so this can run on several scanner threads at once.
+	// TODO: we could include the version in the game list?
+	if (!cdvdGetDiscInfoFromFile(path, disc_type, serial, crc, &error))
 	{
-		Console.Error(fmt::format("(GameList::GetIsoSerialAndCRC) CDVD open of '{}' failed: {}", path, error.GetDescription()));
+		Console.Error(fmt::format("(GameList::GetIsoSerialAndCRC) Open of '{}' failed: {}", path, error.GetDescription()));
 		return false;
 	}
 
-	// TODO: we could include the version in the game list?
-	*disc_type = DoCDVDdetectDiskType();
-	cdvdGetDiscInfo(serial, nullptr, nullptr, crc, nullptr);
-	DoCDVDclose();
 	return true;
 }
 
@@ -603,14 +619,12 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
 					(FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES),
 		&files);
 
-	u32 files_scanned = 0;
 	progress->SetProgressRange(static_cast<u32>(files.size()));
 	progress->SetProgressValue(0);
 
+	std::vector<ScanRequest> requests;
 	for (FILESYSTEM_FIND_DATA& ffd : files)
 	{
-		files_scanned++;
-
 		if (progress->IsCancelled() || !GameList::IsScannableFilename(ffd.FileName) || IsPathExcluded(excluded_paths, ffd.FileName))
 		{
 			continue;
@@ -622,16 +636,175 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
 			continue;
 		}
 
-		const std::string_view filename = Path::GetFileName(ffd.FileName);
-		progress->SetFormattedStatusText(fmt::format(TRANSLATE_FS("GameList","Scanning {}..."), filename.data()).c_str());
-		ScanFile(std::move(ffd.FileName), ffd.ModificationTime, lock, played_time_map, custom_attributes_ini);
-		progress->SetProgressValue(files_scanned);
+		requests.push_back(ScanRequest{std::move(ffd.FileName), ffd.ModificationTime});
 	}
 
-	progress->SetProgressValue(files_scanned);
+	if (!requests.empty() && !progress->IsCancelled())
+	{
+		const u32 progress_base = static_cast<u32>(files.size() - requests.size());
+		progress->SetProgressValue(progress_base);
+		ScanFiles(std::move(requests), progress_base, played_time_map, custom_attributes_ini, progress);
+	}
+
+	progress->SetProgressValue(static_cast<u32>(files.size()));
 	progress->PopState();
 }
 
+void GameList::ScanFiles(std::vector<ScanRequest> requests, u32 progress_base, const PlayedTimeMap& played_time_map,
+	const INISettingsInterface& custom_attributes_ini, ProgressCallback* progress)
+{
+	// Files are queued per device, so one slow device (e.g. a NAS) can't be swamped, or hold up the rest.
+	struct DeviceQueue
+	{
+		std::vector<ScanRequest> requests;
+		u32 active = 0;
+	};
+
+	const u32 total = static_cast<u32>(requests.size());
+	std::vector<DeviceQueue> devices;
+	{
+		UnorderedStringMap<size_t> device_indices;
+		UnorderedStringMap<size_t> directory_devices;
+		for (ScanRequest& req : requests)
+		{
+			const std::string_view directory = Path::GetDirectory(req.path);
+			auto dir_iter = directory_devices.find(directory);
+			if (dir_iter == directory_devices.end())
+			{
+				const std::string key = GetDeviceKey(std::string(directory));
+				auto dev_iter = device_indices.find(key);
+				if (dev_iter == device_indices.end())
+				{
+					dev_iter = device_indices.emplace(key, devices.size()).first;
+					devices.emplace_back();
+				}
+
+				dir_iter = directory_devices.emplace(directory, dev_iter->second).first;
+			}
+
+			devices[dir_iter->second].requests.push_back(std::move(req));
+		}
+
+		// Requests are taken from the back, keep the listing order.
+		for (DeviceQueue& device : devices)
+			std::reverse(device.requests.begin(), device.requests.end());
+	}
+
+	std::mutex queue_mutex;
+	std::condition_variable queue_cv;
+	std::string last_started;
+	u32 completed = 0;
+	bool cancelled = false;
+
+	const auto worker = [&]() {
+		Threading::SetNameOfCurrentThread("Game List Scanner");
+
+		std::unique_lock queue_lock(queue_mutex);
+		for (;;)
+		{
+			DeviceQueue* device = nullptr;
+			bool pending = false;
+			for (DeviceQueue& it : devices)
+			{
+				if (it.requests.empty())
+					continue;
+
+				pending = true;
+				if (it.active < MAX_SCANS_PER_DEVICE)
+				{
+					device = &it;
+					break;
+				}
+			}
+
+			if (!pending || cancelled)
+				break;
+
+			if (!device)
+			{
+				queue_cv.wait(queue_lock);
+				continue;
+			}
+
+			ScanRequest req = std::move(device->requests.back());
+			device->requests.pop_back();
+			device->active++;
+			last_started = Path::GetFileName(req.path);
+			queue_lock.unlock();
+
+			{
+				// Entries and the cache file are only touched with the lock held, the rest runs concurrently.
+				std::unique_lock lock(s_mutex);
+				ScanFile(std::move(req.path), req.timestamp, lock, played_time_map, custom_attributes_ini);
+			}
+
+			queue_lock.lock();
+			device->active--;
+			completed++;
+			queue_cv.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	const u32 num_threads = std::min<u32>(MAX_SCAN_THREADS, total);
+	threads.reserve(num_threads);
+	for (u32 i = 0; i < num_threads; i++)
+		threads.emplace_back(worker);
+
+	// Progress is only reported from this thread.
+	std::string status_file;
+	std::unique_lock queue_lock(queue_mutex);
+	while (completed < total && !cancelled)
+	{
+		queue_cv.wait_for(queue_lock, std::chrono::milliseconds(100));
+
+		const u32 value = completed;
+		const bool status_changed = (status_file != last_started);
+		if (status_changed)
+			status_file = last_started;
+		queue_lock.unlock();
+
+		if (status_changed)
+			progress->SetFormattedStatusText(fmt::format(TRANSLATE_FS("GameList", "Scanning {}..."), status_file).c_str());
+		progress->SetProgressValue(progress_base + value);
+		const bool cancel = progress->IsCancelled();
+
+		queue_lock.lock();
+		if (cancel)
+		{
+			// Scans already in progress are left to finish.
+			cancelled = true;
+			queue_cv.notify_all();
+		}
+	}
+	queue_lock.unlock();
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+std::string GameList::GetDeviceKey(const std::string& directory)
+{
+#ifdef _WIN32
+	// Drive letter, or server and share for UNC paths.
+	if (directory.starts_with("\\\\"))
+	{
+		const std::string::size_type server_end = directory.find_first_of("\\/", 2);
+		const std::string::size_type share_end =
+			(server_end != std::string::npos) ? directory.find_first_of("\\/", server_end + 1) : std::string::npos;
+		return StringUtil::toLower(directory.substr(0, share_end));
+	}
+
+	return StringUtil::toLower(directory.substr(0, directory.find_first_of("\\/")));
+#else
+	struct stat sd;
+	if (stat(directory.c_str(), &sd) != 0)
+		return directory;
+
+	return std::to_string(static_cast<u64>(sd.st_dev));
+#endif
+}
+
 bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map)
 {
 	Entry entry;
@@ -667,6 +840,8 @@ bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_loc
 
 	entry.last_modified_time = timestamp;
 
+	// the cache is shared with the other scanner threads, and written before any custom attributes are applied
+	lock.lock();
 	if (s_cache_write_stream || OpenCacheForWriting())
 	{
 		if (!WriteEntryToCache(&entry))
@@ -676,7 +851,6 @@ bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_loc
 	if (entry.type == EntryType::Invalid)
 	{
 		// don't add invalid entries to list
-		lock.lock();
 		return true;
 	}
 
@@ -702,8 +876,6 @@ bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_loc
 		}
 	}
 
-	lock.lock();
-
 	// remove if present
 	auto it = std::find_if(
 		s_entries.begin(), s_entries.end(), [&entry](const Entry& existing_entry) { return (existing_entry.path == entry.path); });
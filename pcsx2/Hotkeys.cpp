@@ -9,6 +9,7 @@
 #include "ImGui/ImGuiOverlays.h"
 #include "Input/InputManager.h"
 #include "Recording/InputRecording.h"
+#include "Rewind.h"
 #include "SPU2/spu2.h"
 #include "VMManager.h"
 
@@ -247,6 +248,20 @@ DEFINE_HOTKEY("SaveStateAndSelectNextSlot", TRANSLATE_NOOP("Hotkeys", "Save Stat
 			SaveStateSelectorUI::SelectNextSlot(false);
 		}
 	})
+DEFINE_HOTKEY("Rewind", TRANSLATE_NOOP("Hotkeys", "Save States"), TRANSLATE_NOOP("Hotkeys", "Rewind (Hold)"),
+	[](s32 pressed) {
+		if (!VMManager::HasValidVM())
+			return;
+		if (pressed > 0 && !Rewind::IsActive())
+		{
+			Host::AddIconOSDMessage("Rewind", ICON_FA_EXCLAMATION_TRIANGLE,
+				TRANSLATE_STR("Hotkeys", "Rewind is not available."), Host::OSD_QUICK_DURATION);
+		}
+		else if (pressed >= 0)
+		{
+			Rewind::SetRewinding(pressed > 0);
+		}
+	})
 
 #define DEFINE_HOTKEY_SAVESTATE_X(slotnum, title) \
 	DEFINE_HOTKEY("SaveStateToSlot" #slotnum, "Save States", title, [](s32 pressed) { \
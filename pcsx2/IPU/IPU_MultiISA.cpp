@@ -13,20 +13,13 @@
 #include "IPU/IPUdma.h"
 #include "IPU/yuv2rgb.h"
 #include "IPU/IPU_MultiISA.h"
+#include "GS/GSVector.h"
 
 // the IPU is fixed to 16 byte strides (128-bit / QWC resolution):
 static const uint decoder_stride = 16;
 
 #if MULTI_ISA_COMPILE_ONCE
 
-static constexpr std::array<u8, 1024> make_clip_lut()
-{
-	std::array<u8, 1024> lut = {};
-	for (int i = -384; i < 640; i++)
-		lut[i+384] = (i < 0) ? 0 : ((i > 255) ? 255 : i);
-	return lut;
-}
-
 static constexpr mpeg2_scan_pack make_scan_pack()
 {
 	constexpr u8 mpeg2_scan_norm[64] = {
@@ -57,7 +50,6 @@ static constexpr mpeg2_scan_pack make_scan_pack()
 	return pack;
 }
 
-alignas(16) const std::array<u8, 1024> g_idct_clip_lut = make_clip_lut();
 alignas(16) const mpeg2_scan_pack mpeg2_scan = make_scan_pack();
 
 #endif
@@ -206,138 +198,138 @@ __ri static u8 getBits8(u8 *address, bool advance)
  * column inputs are 16-bit values.
  */
 
-__fi static void BUTTERFLY(int& t0, int& t1, int w0, int w1, int d0, int d1)
+// The IDCT runs on eight rows (then eight columns) at once, in two halves of four 32-bit lanes so
+// every intermediate matches the integer reference exactly. Results are truncated to 16 bits between
+// the passes, as storing them back into the block would.
+
+__fi static void BUTTERFLY(GSVector4i& t0, GSVector4i& t1, int w0, int w1, const GSVector4i& d0, const GSVector4i& d1)
 {
-	int tmp = w0 * (d0 + d1);
-	t0 = tmp + (w1 - w0) * d1;
-	t1 = tmp - (w1 + w0) * d0;
+	const GSVector4i tmp = GSVector4i(w0).mul32l(d0.add32(d1));
+	t0 = tmp.add32(GSVector4i(w1 - w0).mul32l(d1));
+	t1 = tmp.sub32(GSVector4i(w1 + w0).mul32l(d0));
 }
 
-__ri static void IDCT_Block(s16* block)
+template <bool columns>
+__fi static void IDCT_Pass(GSVector4i* d)
 {
-	for (int i = 0; i < 8; i++)
+	GSVector4i a0, a1, a2, a3;
 	{
-		s16* const rblock = block + 8 * i;
-		if (!(rblock[1] | ((s32*)rblock)[1] | ((s32*)rblock)[2] |
-				((s32*)rblock)[3]))
-		{
-			u32 tmp = (u16)(rblock[0] << 3);
-			tmp |= tmp << 16;
-			((s32*)rblock)[0] = tmp;
-			((s32*)rblock)[1] = tmp;
-			((s32*)rblock)[2] = tmp;
-			((s32*)rblock)[3] = tmp;
-			continue;
-		}
+		const GSVector4i d0 = d[0].sll32<11>().add32(GSVector4i(columns ? 65536 : 128));
+		const GSVector4i d2 = d[2].sll32<11>();
+		const GSVector4i t0 = d0.add32(d2);
+		const GSVector4i t1 = d0.sub32(d2);
+		GSVector4i t2, t3;
+		BUTTERFLY(t2, t3, W6, W2, d[3], d[1]);
+		a0 = t0.add32(t2);
+		a1 = t1.add32(t3);
+		a2 = t1.sub32(t3);
+		a3 = t0.sub32(t2);
+	}
 
-		int a0, a1, a2, a3;
+	GSVector4i b0, b1, b2, b3;
+	{
+		GSVector4i t0, t1, t2, t3;
+		BUTTERFLY(t0, t1, W7, W1, d[7], d[4]);
+		BUTTERFLY(t2, t3, W3, W5, d[5], d[6]);
+		b0 = t0.add32(t2);
+		b3 = t1.add32(t3);
+		t0 = t0.sub32(t2);
+		t1 = t1.sub32(t3);
+		if constexpr (columns)
 		{
-			const int d0 = (rblock[0] << 11) + 128;
-			const int d1 = rblock[1];
-			const int d2 = rblock[2] << 11;
-			const int d3 = rblock[3];
-			int t0 = d0 + d2;
-			int t1 = d0 - d2;
-			int t2, t3;
-			BUTTERFLY(t2, t3, W6, W2, d3, d1);
-			a0 = t0 + t2;
-			a1 = t1 + t3;
-			a2 = t1 - t3;
-			a3 = t0 - t2;
+			t0 = t0.sra32<8>();
+			t1 = t1.sra32<8>();
+			b1 = t0.add32(t1).mul32l(GSVector4i(181));
+			b2 = t0.sub32(t1).mul32l(GSVector4i(181));
 		}
-
-		int b0, b1, b2, b3;
+		else
 		{
-			const int d0 = rblock[4];
-			const int d1 = rblock[5];
-			const int d2 = rblock[6];
-			const int d3 = rblock[7];
-			int t0, t1, t2, t3;
-			BUTTERFLY(t0, t1, W7, W1, d3, d0);
-			BUTTERFLY(t2, t3, W3, W5, d1, d2);
-			b0 = t0 + t2;
-			b3 = t1 + t3;
-			t0 -= t2;
-			t1 -= t3;
-			b1 = ((t0 + t1) * 181) >> 8;
-			b2 = ((t0 - t1) * 181) >> 8;
+			b1 = t0.add32(t1).mul32l(GSVector4i(181)).sra32<8>();
+			b2 = t0.sub32(t1).mul32l(GSVector4i(181)).sra32<8>();
 		}
-
-		rblock[0] = (a0 + b0) >> 8;
-		rblock[1] = (a1 + b1) >> 8;
-		rblock[2] = (a2 + b2) >> 8;
-		rblock[3] = (a3 + b3) >> 8;
-		rblock[4] = (a3 - b3) >> 8;
-		rblock[5] = (a2 - b2) >> 8;
-		rblock[6] = (a1 - b1) >> 8;
-		rblock[7] = (a0 - b0) >> 8;
 	}
 
+	constexpr int shift = columns ? 17 : 8;
+	d[0] = a0.add32(b0).sra32<shift>();
+	d[1] = a1.add32(b1).sra32<shift>();
+	d[2] = a2.add32(b2).sra32<shift>();
+	d[3] = a3.add32(b3).sra32<shift>();
+	d[4] = a3.sub32(b3).sra32<shift>();
+	d[5] = a2.sub32(b2).sra32<shift>();
+	d[6] = a1.sub32(b1).sra32<shift>();
+	d[7] = a0.sub32(b0).sra32<shift>();
+}
+
+__fi static void IDCT_Transpose(GSVector4i* v)
+{
+	const GSVector4i t0 = v[0].upl16(v[1]);
+	const GSVector4i t1 = v[0].uph16(v[1]);
+	const GSVector4i t2 = v[2].upl16(v[3]);
+	const GSVector4i t3 = v[2].uph16(v[3]);
+	const GSVector4i t4 = v[4].upl16(v[5]);
+	const GSVector4i t5 = v[4].uph16(v[5]);
+	const GSVector4i t6 = v[6].upl16(v[7]);
+	const GSVector4i t7 = v[6].uph16(v[7]);
+
+	const GSVector4i u0 = t0.upl32(t2);
+	const GSVector4i u1 = t0.uph32(t2);
+	const GSVector4i u2 = t1.upl32(t3);
+	const GSVector4i u3 = t1.uph32(t3);
+	const GSVector4i u4 = t4.upl32(t6);
+	const GSVector4i u5 = t4.uph32(t6);
+	const GSVector4i u6 = t5.upl32(t7);
+	const GSVector4i u7 = t5.uph32(t7);
+
+	v[0] = u0.upl64(u4);
+	v[1] = u0.uph64(u4);
+	v[2] = u1.upl64(u5);
+	v[3] = u1.uph64(u5);
+	v[4] = u2.upl64(u6);
+	v[5] = u2.uph64(u6);
+	v[6] = u3.upl64(u7);
+	v[7] = u3.uph64(u7);
+}
+
+// Widens eight rows of 16-bit values, runs a pass over them and packs the results back, keeping the low 16 bits.
+template <bool columns>
+__fi static void IDCT_Pass16(GSVector4i* v)
+{
+	GSVector4i lo[8], hi[8];
 	for (int i = 0; i < 8; i++)
 	{
-		s16* const cblock = block + i;
+		lo[i] = v[i].i16to32();
+		hi[i] = v[i].srl<8>().i16to32();
+	}
 
-		int a0, a1, a2, a3;
-		{
-			const int d0 = (cblock[8 * 0] << 11) + 65536;
-			const int d1 = cblock[8 * 1];
-			const int d2 = cblock[8 * 2] << 11;
-			const int d3 = cblock[8 * 3];
-			const int t0 = d0 + d2;
-			const int t1 = d0 - d2;
-			int t2;
-			int t3;
-			BUTTERFLY(t2, t3, W6, W2, d3, d1);
-			a0 = t0 + t2;
-			a1 = t1 + t3;
-			a2 = t1 - t3;
-			a3 = t0 - t2;
-		}
+	IDCT_Pass<columns>(lo);
+	IDCT_Pass<columns>(hi);
 
-		int b0, b1, b2, b3;
-		{
-			const int d0 = cblock[8 * 4];
-			const int d1 = cblock[8 * 5];
-			const int d2 = cblock[8 * 6];
-			const int d3 = cblock[8 * 7];
-			int t0, t1, t2, t3;
-			BUTTERFLY(t0, t1, W7, W1, d3, d0);
-			BUTTERFLY(t2, t3, W3, W5, d1, d2);
-			b0 = t0 + t2;
-			b3 = t1 + t3;
-			t0 = (t0 - t2) >> 8;
-			t1 = (t1 - t3) >> 8;
-			b1 = (t0 + t1) * 181;
-			b2 = (t0 - t1) * 181;
-		}
+	for (int i = 0; i < 8; i++)
+		v[i] = lo[i].sll32<16>().sra32<16>().ps32(hi[i].sll32<16>().sra32<16>());
+}
 
-		cblock[8 * 0] = (a0 + b0) >> 17;
-		cblock[8 * 1] = (a1 + b1) >> 17;
-		cblock[8 * 2] = (a2 + b2) >> 17;
-		cblock[8 * 3] = (a3 + b3) >> 17;
-		cblock[8 * 4] = (a3 - b3) >> 17;
-		cblock[8 * 5] = (a2 - b2) >> 17;
-		cblock[8 * 6] = (a1 - b1) >> 17;
-		cblock[8 * 7] = (a0 - b0) >> 17;
-	}
+__ri static void IDCT_Block(s16* block, GSVector4i* rows)
+{
+	for (int i = 0; i < 8; i++)
+		rows[i] = GSVector4i::load<true>(block + 8 * i);
+
+	// Row pass with the rows spread across lanes, then the column pass with the columns across lanes.
+	IDCT_Transpose(rows);
+	IDCT_Pass16<false>(rows);
+	IDCT_Transpose(rows);
+	IDCT_Pass16<true>(rows);
 }
 
 __ri static void IDCT_Copy(s16* block, u8* dest, const int stride)
 {
-	IDCT_Block(block);
+	GSVector4i rows[8];
+	IDCT_Block(block, rows);
 
+	const GSVector4i zero = GSVector4i::zero();
 	for (int i = 0; i < 8; i++)
 	{
-		dest[0] = (g_idct_clip_lut.data() + 384)[block[0]];
-		dest[1] = (g_idct_clip_lut.data() + 384)[block[1]];
-		dest[2] = (g_idct_clip_lut.data() + 384)[block[2]];
-		dest[3] = (g_idct_clip_lut.data() + 384)[block[3]];
-		dest[4] = (g_idct_clip_lut.data() + 384)[block[4]];
-		dest[5] = (g_idct_clip_lut.data() + 384)[block[5]];
-		dest[6] = (g_idct_clip_lut.data() + 384)[block[6]];
-		dest[7] = (g_idct_clip_lut.data() + 384)[block[7]];
-
-		std::memset(block, 0, 16);
+		GSVector4i::storel(dest, rows[i].pu16(rows[i]));
+		GSVector4i::store<true>(block, zero);
 
 		dest += stride;
 		block += 8;
@@ -352,12 +344,13 @@ __ri static void IDCT_Add(const int last, s16* block, s16* dest, const int strid
 
 	if (last != 129 || (block[0] & 7) == 4)
 	{
-		IDCT_Block(block);
+		GSVector4i rows[8];
+		IDCT_Block(block, rows);
 
 		const r128 zero = r128_zero();
 		for (int i = 0; i < 8; i++)
 		{
-			r128_store(dest, r128_load(block));
+			GSVector4i::store<true>(dest, rows[i]);
 			r128_store(block, zero);
 
 			dest += stride;
@@ -375,6 +368,15 @@ __ri static void IDCT_Add(const int last, s16* block, s16* dest, const int strid
 	}
 }
 
+void IPU_IDCT(s16* block)
+{
+	GSVector4i rows[8];
+	IDCT_Block(block, rows);
+
+	for (int i = 0; i < 8; i++)
+		GSVector4i::store<true>(block + 8 * i, rows[i]);
+}
+
 /* Bitstream and buffer needs to be reallocated in order for successful
 	reading of the old data. Here the old data stored in the 2nd slot
 	of the internal buffer is copied to 1st slot, and the new data read
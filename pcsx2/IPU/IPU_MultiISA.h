@@ -145,6 +145,9 @@ MULTI_ISA_DEF(
 	extern void ipu_dither(const macroblock_rgb32& rgb32, macroblock_rgb16& rgb16, int dte);
 
 	void IPUWorker();
+
+	// Runs the IDCT over an aligned 8x8 block in place, for checking against the reference in tests.
+	void IPU_IDCT(s16* block);
 )
 
 // Quantization matrix
@@ -161,5 +164,4 @@ struct mpeg2_scan_pack
 	u8 alt[64];
 };
 
-alignas(16) extern const std::array<u8, 1024> g_idct_clip_lut;
 alignas(16) extern const mpeg2_scan_pack mpeg2_scan;
@@ -20,11 +20,13 @@
 #include "MTGS.h"
 #include "PerformanceMetrics.h"
 #include "Recording/InputRecording.h"
+#include "Rewind.h"
 #include "SIO/Pad/Pad.h"
 #include "SIO/Pad/PadBase.h"
 #include "USB/USB.h"
 #include "VMManager.h"
 #include "svnrev.h"
+#include "vtlb.h"
 
 #include "common/BitUtils.h"
 #include "common/FileSystem.h"
@@ -187,6 +189,12 @@ __ri void ImGuiManager::DrawPerformanceOverlay(float& position_y, float scale, f
 			GSgetMemoryStats(text);
 			if (!text.empty())
 				DRAW_LINE(fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
+
+			// Unpack routine cache hit rate, compiles and evictions.
+			text.clear();
+			text.append_format("VIF: {:.1f}% | {} C | {} E", PerformanceMetrics::GetVIFUnpackCacheHitRate(),
+				PerformanceMetrics::GetVIFUnpackCacheMisses(), PerformanceMetrics::GetVIFUnpackCacheEvictions());
+			DRAW_LINE(fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
 		}
 
 		if (GSConfig.OsdShowResolution)
@@ -242,6 +250,16 @@ __ri void ImGuiManager::DrawPerformanceOverlay(float& position_y, float scale, f
 				FormatProcessorStat(text, PerformanceMetrics::GetCaptureThreadUsage(), PerformanceMetrics::GetCaptureThreadAverageTime());
 				DRAW_LINE(fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
 			}
+
+			if (EmuConfig.EnableRewind)
+			{
+				text.clear();
+				text.append_format("RW: {} | {:.1f}MB | {:.2f}ms | {:.2f}ms | {:.2f}ms", Rewind::GetStateCount(),
+					static_cast<float>(Rewind::GetCompressedSize()) / static_cast<float>(_1mb),
+					PerformanceMetrics::GetRewindCaptureTime(), PerformanceMetrics::GetRewindMaximumCaptureTime(),
+					PerformanceMetrics::GetRewindRestoreTime());
+				DRAW_LINE(fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
+			}
 		}
 
 		if (GSConfig.OsdShowGPU)
@@ -251,6 +269,20 @@ __ri void ImGuiManager::DrawPerformanceOverlay(float& position_y, float scale, f
 			DRAW_LINE(fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
 		}
 
+		if (GSConfig.OsdShowSMCStats)
+		{
+			// Pages with the most code recompiled after being written, M for manual protection.
+			std::array<mmap_SMCPageStats, 4> pages;
+			const u32 count = mmap_GetSMCPageStats(pages.data(), static_cast<u32>(pages.size()));
+			for (u32 i = 0; i < count; i++)
+			{
+				text.clear();
+				text.append_format("SMC {:08X}: {} RC | {} W | {}", pages[i].paddr, pages[i].recompiles,
+					pages[i].recent_writes, (pages[i].mode == ProtMode_Manual) ? 'M' : 'P');
+				DRAW_LINE(fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
+			}
+		}
+
 		if (GSConfig.OsdShowIndicators)
 		{
 			const float target_speed = VMManager::GetTargetSpeed();
@@ -27,6 +27,7 @@
 #include <memory>
 #include <span>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 namespace Patch
@@ -123,6 +124,16 @@ namespace Patch
 		void (*func)(PatchGroup* group, const std::string_view cmd, const std::string_view param);
 	};
 
+	// Active patch flattened for ApplyLoadedPatches(). Plain EE writes carry their size and little-endian value,
+	// anything else (extended codes, IOP writes, byte strings) has a size of zero and goes through ApplyPatch().
+	struct CompiledPatch
+	{
+		u32 addr;
+		u32 size;
+		u64 value;
+		const PatchCommand* command;
+	};
+
 	using PatchList = std::vector<PatchGroup>;
 	using ActivePatchList = std::vector<const PatchCommand*>;
 	using EnablePatchList = std::vector<std::string>;
@@ -157,7 +168,11 @@ namespace Patch
 	static u32 EnablePatches(const PatchList& patches, const EnablePatchList& enable_list);
 
 	static void ApplyPatch(const PatchCommand* p);
-	static void ApplyDynaPatch(const DynamicPatch& patch, u32 address);
+	static void CompileActivePatches();
+	template <typename T>
+	static void ApplyCompiledWrite(u32 addr, T value);
+	static bool ApplyDynaPatch(const DynamicPatch& patch, u32 address);
+	static void IndexDynamicPatches();
 	static void writeCheat();
 	static void handle_extended_t(const PatchCommand* p);
 
@@ -176,7 +191,19 @@ namespace Patch
 	static PatchList s_cheat_patches;
 
 	static ActivePatchList s_active_patches;
+	static std::array<std::vector<CompiledPatch>, PPT_END_MARKER> s_compiled_patches;
 	static std::vector<DynamicPatch> s_active_dynamic_patches;
+
+	// Dynamic patches grouped by the offset of their first pattern word, then keyed on that word's value, so
+	// compiling an instruction only has to look at the patches which could match there.
+	struct DynamicPatchGroup
+	{
+		u32 offset;
+		std::unordered_map<u32, std::vector<u32>> patches; // indices into s_active_dynamic_patches
+	};
+	static std::vector<DynamicPatchGroup> s_dynamic_patch_groups;
+	static std::vector<u32> s_unindexed_dynamic_patches; // patches without a pattern match everywhere
+	static std::vector<u32> s_dynamic_patch_candidates;
 	static EnablePatchList s_enabled_cheats;
 	static EnablePatchList s_enabled_patches;
 	static u32 s_patches_crc;
@@ -712,6 +739,8 @@ void Patch::UpdateActivePatches(bool reload_enabled_list, bool verbose, bool ver
 			TRANSLATE_PLURAL_STR("Patch", "%n cheat patches are active.", "OSD Message", c_count));
 	}
 
+	CompileActivePatches();
+
 	// Display message on first boot when we load patches.
 	// Except when it's just GameDB.
 	const bool just_gamedb = (p_count == 0 && c_count == 0 && gp_count > 0);
@@ -789,7 +818,10 @@ void Patch::UnloadPatches()
 	s_override_aspect_ratio = {};
 	s_patches_crc = 0;
 	s_active_patches = {};
+	s_compiled_patches = {};
 	s_active_dynamic_patches = {};
+	s_dynamic_patch_groups = {};
+	s_unindexed_dynamic_patches = {};
 	s_enabled_patches = {};
 	s_enabled_cheats = {};
 	decltype(s_cheat_patches)().swap(s_cheat_patches);
@@ -904,23 +936,165 @@ void Patch::PatchFunc::gsinterlacemode(PatchGroup* group, const std::string_view
 // This is for applying patches directly to memory
 void Patch::ApplyLoadedPatches(patch_place_type place)
 {
-	for (const PatchCommand* i : s_active_patches)
+	for (const CompiledPatch& cp : s_compiled_patches[place])
 	{
-		if (i->placetopatch == place)
-			ApplyPatch(i);
+		switch (cp.size)
+		{
+			case 1:
+				ApplyCompiledWrite<u8>(cp.addr, static_cast<u8>(cp.value));
+				break;
+			case 2:
+				ApplyCompiledWrite<u16>(cp.addr, static_cast<u16>(cp.value));
+				break;
+			case 4:
+				ApplyCompiledWrite<u32>(cp.addr, static_cast<u32>(cp.value));
+				break;
+			case 8:
+				ApplyCompiledWrite<u64>(cp.addr, cp.value);
+				break;
+			default:
+				ApplyPatch(cp.command);
+				break;
+		}
 	}
 }
 
-void Patch::ApplyDynamicPatches(u32 pc)
+void Patch::CompileActivePatches()
 {
-	for (const auto& dynpatch : s_active_dynamic_patches)
-		ApplyDynaPatch(dynpatch, pc);
+	for (std::vector<CompiledPatch>& list : s_compiled_patches)
+		list.clear();
+
+	// Kept in pnach order rather than sorted by address, later lines are allowed to overwrite earlier ones
+	// and extended codes depend on the lines before them.
+	for (const PatchCommand* p : s_active_patches)
+	{
+		if (p->placetopatch >= PPT_END_MARKER)
+			continue;
+
+		CompiledPatch cp = {p->addr, 0, p->data, p};
+		if (p->cpu == CPU_EE)
+		{
+			switch (p->type)
+			{
+				case BYTE_T:
+					cp.size = 1;
+					break;
+				case SHORT_T:
+					cp.size = 2;
+					break;
+				case WORD_T:
+					cp.size = 4;
+					break;
+				case DOUBLE_T:
+					cp.size = 8;
+					break;
+				case SHORT_BE_T:
+					cp.size = 2;
+					cp.value = ByteSwap(static_cast<u16>(p->data));
+					break;
+				case WORD_BE_T:
+					cp.size = 4;
+					cp.value = ByteSwap(static_cast<u32>(p->data));
+					break;
+				case DOUBLE_BE_T:
+					cp.size = 8;
+					cp.value = ByteSwap(p->data);
+					break;
+				default:
+					break;
+			}
+		}
+
+		s_compiled_patches[p->placetopatch].push_back(cp);
+	}
+}
+
+template <typename T>
+void Patch::ApplyCompiledWrite(u32 addr, T value)
+{
+	// Continuous patches rarely change anything after the first frame. Compare against the host mapping directly when
+	// the page is plain memory (and the interpreter isn't going through the data cache), and only write on a change,
+	// which also saves the recompiler from invalidating the patched code every vsync.
+	const auto vmv = vtlb_private::vtlbdata.vmap[addr >> vtlb_private::VTLB_PAGE_BITS];
+	T current;
+	if (!vmv.isHandler(addr) && (CHECK_EEREC || !CHECK_CACHE))
+		std::memcpy(&current, reinterpret_cast<const void*>(vmv.assumePtr(addr)), sizeof(current));
+	else
+		current = vtlb_memRead<T>(addr);
+
+	if (current != value)
+		vtlb_memWrite<T>(addr, value);
+}
+
+u32 Patch::ApplyDynamicPatches(u32 pc)
+{
+	if (s_active_dynamic_patches.empty())
+		return 0;
+
+	std::vector<u32>& candidates = s_dynamic_patch_candidates;
+	candidates.assign(s_unindexed_dynamic_patches.begin(), s_unindexed_dynamic_patches.end());
+	for (const DynamicPatchGroup& group : s_dynamic_patch_groups)
+	{
+		const u32* word = static_cast<const u32*>(PSM(pc + group.offset));
+		if (!word)
+			continue;
+
+		const auto it = group.patches.find(*word);
+		if (it != group.patches.end())
+			candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+	}
+
+	// Patches are applied in the order they were loaded, same as checking the whole list would.
+	if (candidates.size() > 1)
+		std::sort(candidates.begin(), candidates.end());
+
+	u32 checked = static_cast<u32>(candidates.size());
+	for (const u32 index : candidates)
+	{
+		if (!ApplyDynaPatch(s_active_dynamic_patches[index], pc))
+			continue;
+
+		// The replacement may have created the pattern of a later patch, which the index didn't see.
+		for (u32 i = index + 1; i < static_cast<u32>(s_active_dynamic_patches.size()); i++)
+			ApplyDynaPatch(s_active_dynamic_patches[i], pc);
+
+		checked += static_cast<u32>(s_active_dynamic_patches.size()) - index - 1;
+		break;
+	}
+
+	return checked;
 }
 
 void Patch::LoadDynamicPatches(const std::vector<DynamicPatch>& patches)
 {
 	for (const DynamicPatch& it : patches)
 		s_active_dynamic_patches.push_back(it);
+
+	IndexDynamicPatches();
+}
+
+void Patch::IndexDynamicPatches()
+{
+	s_dynamic_patch_groups.clear();
+	s_unindexed_dynamic_patches.clear();
+
+	for (u32 i = 0; i < static_cast<u32>(s_active_dynamic_patches.size()); i++)
+	{
+		const DynamicPatch& patch = s_active_dynamic_patches[i];
+		if (patch.pattern.empty())
+		{
+			s_unindexed_dynamic_patches.push_back(i);
+			continue;
+		}
+
+		const DynamicPatchEntry& first = patch.pattern.front();
+		auto group = std::find_if(s_dynamic_patch_groups.begin(), s_dynamic_patch_groups.end(),
+			[&first](const DynamicPatchGroup& g) { return g.offset == first.offset; });
+		if (group == s_dynamic_patch_groups.end())
+			group = s_dynamic_patch_groups.insert(group, DynamicPatchGroup{first.offset, {}});
+
+		group->patches[first.value].push_back(i);
+	}
 }
 
 static u32 SkipCount = 0, IterationCount = 0;
@@ -1507,12 +1681,12 @@ void Patch::ApplyPatch(const PatchCommand* p)
 	}
 }
 
-void Patch::ApplyDynaPatch(const DynamicPatch& patch, u32 address)
+bool Patch::ApplyDynaPatch(const DynamicPatch& patch, u32 address)
 {
 	for (const auto& pattern : patch.pattern)
 	{
 		if (*static_cast<u32*>(PSM(address + pattern.offset)) != pattern.value)
-			return;
+			return false;
 	}
 
 	Console.WriteLn("Applying Dynamic Patch to address 0x%08X", address);
@@ -1521,4 +1695,6 @@ void Patch::ApplyDynaPatch(const DynamicPatch& patch, u32 address)
 	{
 		memWrite32(address + replacement.offset, replacement.value);
 	}
+
+	return true;
 }
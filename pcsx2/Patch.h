@@ -96,7 +96,9 @@ namespace Patch
 
 	// Functions for Dynamic EE patching.
 	extern void LoadDynamicPatches(const std::vector<DynamicPatch>& patches);
-	extern void ApplyDynamicPatches(u32 pc);
+
+	/// Applies the dynamic patches whose pattern matches at pc. Returns the number of patches checked.
+	extern u32 ApplyDynamicPatches(u32 pc);
 
 	// Patches the emulation memory by applying all the loaded patches with a specific place value.
 	// Note: unless you know better, there's no need to check whether or not different patch sources
@@ -322,9 +322,13 @@ void Pcsx2Config::SpeedhackOptions::LoadSave(SettingsWrapper& wrap)
 	EECycleSkip = std::min(EECycleSkip, MAX_EE_CYCLE_SKIP);
 }
 
- Pcsx2Config::ProfilerOptions::ProfilerOptions()
-	: bitset(0xfffffffe)
+Pcsx2Config::ProfilerOptions::ProfilerOptions()
+	: bitset(0)
 {
+	RecBlocks_EE = true;
+	RecBlocks_IOP = true;
+	RecBlocks_VU0 = true;
+	RecBlocks_VU1 = true;
 }
 
 void Pcsx2Config::ProfilerOptions::LoadSave(SettingsWrapper& wrap)
@@ -336,6 +340,7 @@ void Pcsx2Config::ProfilerOptions::LoadSave(SettingsWrapper& wrap)
 	SettingsWrapBitBool(RecBlocks_IOP);
 	SettingsWrapBitBool(RecBlocks_VU0);
 	SettingsWrapBitBool(RecBlocks_VU1);
+	SettingsWrapBitBool(PerfJitDump);
 }
 
 bool Pcsx2Config::ProfilerOptions::operator!=(const ProfilerOptions& right) const
@@ -364,6 +369,7 @@ Pcsx2Config::RecompilerOptions::RecompilerOptions()
 	EnableVU1 = true;
 	EnableFastmem = true;
 	PauseOnTLBMiss = false;
+	EnableEETiering = false;
 
 	// vu and fpu clamping default to standard overflow.
 	vu0Overflow = true;
@@ -442,6 +448,7 @@ void Pcsx2Config::RecompilerOptions::LoadSave(SettingsWrapper& wrap)
 	SettingsWrapBitBool(EnableVU1);
 	SettingsWrapBitBool(EnableFastmem);
 	SettingsWrapBitBool(PauseOnTLBMiss);
+	SettingsWrapBitBool(EnableEETiering);
 
 	SettingsWrapBitBool(vu0Overflow);
 	SettingsWrapBitBool(vu0ExtraOverflow);
@@ -629,6 +636,7 @@ Pcsx2Config::GSOptions::GSOptions()
 	OsdShowSettings = false;
 	OsdShowInputs = false;
 	OsdShowFrameTimes = false;
+	OsdShowSMCStats = false;
 	OsdShowVersion = false;
 
 	HWDownloadMode = GSHardwareDownloadMode::Enabled;
@@ -636,6 +644,8 @@ Pcsx2Config::GSOptions::GSOptions()
 	HWSpinCPUForReadbacks = false;
 	GPUPaletteConversion = false;
 	AutoFlushSW = true;
+	SWTileBinning = false;
+	SWDrawStats = false;
 	PreloadFrameWithGSData = false;
 	Mipmap = true;
 	HWMipmap = true;
@@ -713,6 +723,8 @@ bool Pcsx2Config::GSOptions::OptionsAreEqual(const GSOptions& right) const
 		OpEqu(MaxAnisotropy) &&
 		OpEqu(SWExtraThreads) &&
 		OpEqu(SWExtraThreadsHeight) &&
+		OpEqu(SWTileBinning) &&
+		OpEqu(SWDrawStats) &&
 		OpEqu(TriFilter) &&
 		OpEqu(TVShader) &&
 		OpEqu(GetSkipCountFunctionId) &&
@@ -835,12 +847,15 @@ void Pcsx2Config::GSOptions::LoadSave(SettingsWrapper& wrap)
 	SettingsWrapBitBool(OsdShowSettings);
 	SettingsWrapBitBool(OsdShowInputs);
 	SettingsWrapBitBool(OsdShowFrameTimes);
+	SettingsWrapBitBool(OsdShowSMCStats);
 	SettingsWrapBitBool(OsdShowVersion);
 
 	SettingsWrapBitBool(HWSpinGPUForReadbacks);
 	SettingsWrapBitBool(HWSpinCPUForReadbacks);
 	SettingsWrapBitBoolEx(GPUPaletteConversion, "paltex");
 	SettingsWrapBitBoolEx(AutoFlushSW, "autoflush_sw");
+	SettingsWrapBitBoolEx(SWTileBinning, "sw_tile_binning");
+	SettingsWrapBitBoolEx(SWDrawStats, "sw_draw_stats");
 	SettingsWrapBitBoolEx(PreloadFrameWithGSData, "preload_frame_with_gs_data");
 	SettingsWrapBitBoolEx(Mipmap, "mipmap");
 	SettingsWrapBitBoolEx(ManualUserHacks, "UserHacks");
@@ -1089,6 +1104,7 @@ void Pcsx2Config::SPU2Options::LoadSave(SettingsWrapper& wrap)
 		SettingsWrapEntry(OutputVolume);
 		SettingsWrapEntry(FastForwardVolume);
 		SettingsWrapEntry(OutputMuted);
+		SettingsWrapEntry(AsyncMixing);
 		SettingsWrapParsedEnum(Backend, "Backend", &AudioStream::ParseBackendName, &AudioStream::GetBackendName);
 		SettingsWrapParsedEnum(SyncMode, "SyncMode", &ParseSyncMode, &GetSyncModeName);
 		SettingsWrapEntry(DriverName);
@@ -1108,6 +1124,7 @@ bool Pcsx2Config::SPU2Options::operator==(const SPU2Options& right) const
 		   OpEqu(OutputVolume) &&
 		   OpEqu(FastForwardVolume) &&
 		   OpEqu(OutputMuted) &&
+		   OpEqu(AsyncMixing) &&
 		   OpEqu(Backend) &&
 		   OpEqu(StreamParameters) &&
 		   OpEqu(DriverName) &&
@@ -1699,6 +1716,10 @@ Pcsx2Config::Pcsx2Config()
 	}
 
 	GzipIsoIndexTemplate = "$(f).pindex.tmp";
+	CdvdReadCacheBuffers = 8;
+	CdvdDecompressThreads = 2;
+	RewindFrameInterval = 10;
+	RewindBufferSize = 256;
 	PINESlot = 28011;
 }
 
@@ -1709,6 +1730,7 @@ void Pcsx2Config::LoadSaveCore(SettingsWrapper& wrap)
 	SettingsWrapBitBool(CdvdVerboseReads);
 	SettingsWrapBitBool(CdvdDumpBlocks);
 	SettingsWrapBitBool(CdvdPrecache);
+	SettingsWrapBitBool(CdvdMapFiles);
 	SettingsWrapBitBool(EnablePatches);
 	SettingsWrapBitBool(EnableCheats);
 	SettingsWrapBitBool(EnablePINE);
@@ -1726,6 +1748,7 @@ void Pcsx2Config::LoadSaveCore(SettingsWrapper& wrap)
 
 	SettingsWrapBitBool(BackupSavestate);
 	SettingsWrapBitBool(SavestateZstdCompression);
+	SettingsWrapBitBool(EnableRewind);
 	SettingsWrapBitBool(McdFolderAutoManage);
 
 	SettingsWrapBitBool(WarnAboutUnsafeSettings);
@@ -1746,6 +1769,10 @@ void Pcsx2Config::LoadSaveCore(SettingsWrapper& wrap)
 	Achievements.LoadSave(wrap);
 
 	SettingsWrapEntry(GzipIsoIndexTemplate);
+	SettingsWrapEntry(CdvdReadCacheBuffers);
+	SettingsWrapEntry(CdvdDecompressThreads);
+	SettingsWrapEntry(RewindFrameInterval);
+	SettingsWrapEntry(RewindBufferSize);
 	SettingsWrapEntry(PINESlot);
 
 	// For now, this in the derived config for backwards ini compatibility.
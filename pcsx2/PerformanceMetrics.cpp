@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
 // SPDX-License-Identifier: GPL-3.0+
 
+#include <atomic>
 #include <chrono>
 #include <vector>
 
@@ -14,6 +15,7 @@
 #include "MTGS.h"
 #include "MTVU.h"
 #include "VMManager.h"
+#include "Vif_Dynarec.h"
 
 static const float UPDATE_INTERVAL = 0.5f;
 
@@ -71,6 +73,34 @@ static float s_accumulated_gpu_time = 0.0f;
 static float s_gpu_usage = 0.0f;
 static u32 s_presents_since_last_update = 0;
 
+// rewind timings, reported by the CPU thread
+static std::atomic<u64> s_accumulated_rewind_capture_us{0};
+static std::atomic<u64> s_maximum_rewind_capture_us{0};
+static std::atomic<u32> s_rewind_captures_since_last_update{0};
+static std::atomic<float> s_rewind_restore_time{0.0f};
+static float s_average_rewind_capture_time = 0.0f;
+static float s_maximum_rewind_capture_time = 0.0f;
+
+// VIF unpack cache totals, read from both VIFs at each update
+static HashBucket::Stats s_last_vif_cache_stats = {};
+static float s_vif_cache_hit_rate = 0.0f;
+static u32 s_vif_cache_misses = 0;
+static u32 s_vif_cache_evictions = 0;
+
+static HashBucket::Stats GetVIFCacheStats()
+{
+	// The counters only ever go up, so wrapping is taken care of by the unsigned subtraction in Update().
+	HashBucket::Stats stats = {};
+	for (const nVifStruct& v : nVif)
+	{
+		const HashBucket::Stats vif_stats = v.vifBlocks.stats();
+		stats.hits += vif_stats.hits;
+		stats.misses += vif_stats.misses;
+		stats.evictions += vif_stats.evictions;
+	}
+	return stats;
+}
+
 void PerformanceMetrics::Clear()
 {
 	Reset();
@@ -94,6 +124,14 @@ void PerformanceMetrics::Clear()
 	s_average_gpu_time = 0.0f;
 	s_gpu_usage = 0.0f;
 
+	s_average_rewind_capture_time = 0.0f;
+	s_maximum_rewind_capture_time = 0.0f;
+	s_rewind_restore_time.store(0.0f, std::memory_order_relaxed);
+
+	s_vif_cache_hit_rate = 0.0f;
+	s_vif_cache_misses = 0;
+	s_vif_cache_evictions = 0;
+
 	s_frame_number = 0;
 
 	s_frame_time_history.fill(0.0f);
@@ -113,6 +151,12 @@ void PerformanceMetrics::Reset()
 	s_accumulated_gpu_time = 0.0f;
 	s_presents_since_last_update = 0;
 
+	s_accumulated_rewind_capture_us.store(0, std::memory_order_relaxed);
+	s_maximum_rewind_capture_us.store(0, std::memory_order_relaxed);
+	s_rewind_captures_since_last_update.store(0, std::memory_order_relaxed);
+
+	s_last_vif_cache_stats = GetVIFCacheStats();
+
 	s_last_update_time.Reset();
 	s_last_frame_time.Reset();
 
@@ -159,6 +203,20 @@ void PerformanceMetrics::Update(bool gs_register_write, bool fb_blit, bool is_sk
 	s_gpu_usage = s_accumulated_gpu_time / (time * 10.0f);
 	s_accumulated_gpu_time = 0.0f;
 
+	const u32 rewind_captures = s_rewind_captures_since_last_update.exchange(0, std::memory_order_relaxed);
+	const u64 rewind_capture_us = s_accumulated_rewind_capture_us.exchange(0, std::memory_order_relaxed);
+	s_average_rewind_capture_time = (rewind_captures > 0) ?
+		(static_cast<float>(rewind_capture_us) / 1000.0f / static_cast<float>(rewind_captures)) : 0.0f;
+	s_maximum_rewind_capture_time = static_cast<float>(s_maximum_rewind_capture_us.exchange(0, std::memory_order_relaxed)) / 1000.0f;
+
+	const HashBucket::Stats vif_cache_stats = GetVIFCacheStats();
+	const u32 vif_cache_hits = vif_cache_stats.hits - s_last_vif_cache_stats.hits;
+	s_vif_cache_misses = vif_cache_stats.misses - s_last_vif_cache_stats.misses;
+	s_vif_cache_evictions = vif_cache_stats.evictions - s_last_vif_cache_stats.evictions;
+	s_vif_cache_hit_rate = ((vif_cache_hits + s_vif_cache_misses) > 0) ?
+		(static_cast<float>(vif_cache_hits) * 100.0f / static_cast<float>(vif_cache_hits + s_vif_cache_misses)) : 0.0f;
+	s_last_vif_cache_stats = vif_cache_stats;
+
 	// prefer privileged register write based framerate detection, it's less likely to have false positives
 	if (s_gs_privileged_register_writes_since_last_update > 0 && !EmuConfig.Gamefixes.BlitInternalFPSHack)
 	{
@@ -234,6 +292,22 @@ void PerformanceMetrics::OnGPUPresent(float gpu_time)
 	s_presents_since_last_update++;
 }
 
+void PerformanceMetrics::OnRewindCapture(float capture_time)
+{
+	const u64 us = static_cast<u64>(capture_time * 1000.0f);
+	s_accumulated_rewind_capture_us.fetch_add(us, std::memory_order_relaxed);
+	s_rewind_captures_since_last_update.fetch_add(1, std::memory_order_relaxed);
+
+	u64 max_us = s_maximum_rewind_capture_us.load(std::memory_order_relaxed);
+	while (us > max_us && !s_maximum_rewind_capture_us.compare_exchange_weak(max_us, us, std::memory_order_relaxed))
+		;
+}
+
+void PerformanceMetrics::OnRewindRestore(float restore_time)
+{
+	s_rewind_restore_time.store(restore_time, std::memory_order_relaxed);
+}
+
 void PerformanceMetrics::SetCPUThread(Threading::ThreadHandle thread)
 {
 	s_last_cpu_time = thread ? thread.GetCPUTime() : 0;
@@ -352,6 +426,11 @@ double PerformanceMetrics::GetGSSWThreadAverageTime(u32 index)
 	return s_gs_sw_threads[index].time;
 }
 
+u64 PerformanceMetrics::GetGSSWThreadCPUTime(u32 index)
+{
+	return s_gs_sw_threads[index].handle.GetCPUTime();
+}
+
 float PerformanceMetrics::GetGPUUsage()
 {
 	return s_gpu_usage;
@@ -362,6 +441,36 @@ float PerformanceMetrics::GetGPUAverageTime()
 	return s_average_gpu_time;
 }
 
+float PerformanceMetrics::GetRewindCaptureTime()
+{
+	return s_average_rewind_capture_time;
+}
+
+float PerformanceMetrics::GetRewindMaximumCaptureTime()
+{
+	return s_maximum_rewind_capture_time;
+}
+
+float PerformanceMetrics::GetRewindRestoreTime()
+{
+	return s_rewind_restore_time.load(std::memory_order_relaxed);
+}
+
+float PerformanceMetrics::GetVIFUnpackCacheHitRate()
+{
+	return s_vif_cache_hit_rate;
+}
+
+u32 PerformanceMetrics::GetVIFUnpackCacheMisses()
+{
+	return s_vif_cache_misses;
+}
+
+u32 PerformanceMetrics::GetVIFUnpackCacheEvictions()
+{
+	return s_vif_cache_evictions;
+}
+
 const PerformanceMetrics::FrameTimeHistory& PerformanceMetrics::GetFrameTimeHistory()
 {
 	return s_frame_time_history;
@@ -23,6 +23,10 @@ namespace PerformanceMetrics
 	void Update(bool gs_register_write, bool fb_blit, bool is_skipping_present);
 	void OnGPUPresent(float gpu_time);
 
+	/// Records the time spent on the CPU thread capturing or restoring a rewind state.
+	void OnRewindCapture(float capture_time);
+	void OnRewindRestore(float restore_time);
+
 	/// Sets the EE thread for CPU usage calculations.
 	void SetCPUThread(Threading::ThreadHandle thread);
 
@@ -54,10 +58,20 @@ namespace PerformanceMetrics
 	u32 GetGSSWThreadCount();
 	double GetGSSWThreadUsage(u32 index);
 	double GetGSSWThreadAverageTime(u32 index);
+	u64 GetGSSWThreadCPUTime(u32 index);
 
 	float GetGPUUsage();
 	float GetGPUAverageTime();
 
+	float GetRewindCaptureTime();
+	float GetRewindMaximumCaptureTime();
+	float GetRewindRestoreTime();
+
+	/// VIF unpack routine cache activity over the last update interval, for both VIFs.
+	float GetVIFUnpackCacheHitRate();
+	u32 GetVIFUnpackCacheMisses();
+	u32 GetVIFUnpackCacheEvictions();
+
 	const FrameTimeHistory& GetFrameTimeHistory();
 	u32 GetFrameTimeHistoryPos();
 } // namespace PerformanceMetrics
@@ -0,0 +1,411 @@
+// SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
+// SPDX-License-Identifier: GPL-3.0+
+
+#include "Achievements.h"
+#include "Config.h"
+#include "GSDumpReplayer.h"
+#include "PerformanceMetrics.h"
+#include "Recording/InputRecording.h"
+#include "Rewind.h"
+#include "SaveState.h"
+#include "vtlb.h"
+
+#include "common/Console.h"
+#include "common/Error.h"
+#include "common/Threading.h"
+#include "common/Timer.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Rewind
+{
+	// An older state, stored as the XOR of itself against the state which was captured after it.
+	struct DeltaState
+	{
+		std::vector<u8> compressed;
+		std::vector<ArchiveEntry> entries;
+		size_t length;
+	};
+
+	static void WorkerThreadEntryPoint();
+	static void CompressHead(ArchiveEntryList* next);
+	static void StepHeadBack();
+	static void WaitForWorker(std::unique_lock<std::mutex>& lock);
+	static void XorInto(u8* dst, const u8* src, size_t size);
+
+	// The head, one state waiting for compression, and one being captured. When none are free the
+	// worker is behind, and the capture is skipped rather than stalling the CPU thread. These are full
+	// uncompressed states, so they aren't counted against RewindBufferSize.
+	static constexpr u32 NUM_STATE_BUFFERS = 3;
+
+	// XOR deltas of neighbouring states are mostly zeros, so the fastest level is nearly as good as the others.
+	static constexpr int COMPRESSION_LEVEL = 1;
+
+	static std::mutex s_mutex;
+	static std::condition_variable s_work_cv;
+	static std::condition_variable s_done_cv;
+	static std::thread s_thread;
+	static bool s_shutdown = false;
+	static bool s_worker_busy = false;
+	static bool s_step_pending = false;
+
+	static std::vector<std::unique_ptr<ArchiveEntryList>> s_free_states;
+	static std::deque<std::unique_ptr<ArchiveEntryList>> s_pending_states;
+	static std::unique_ptr<ArchiveEntryList> s_head_state;
+	static std::deque<DeltaState> s_delta_states;
+	static size_t s_compressed_size = 0;
+	static size_t s_max_compressed_size = 0;
+
+	// Only touched by the worker thread.
+	static ZSTD_CCtx* s_cctx = nullptr;
+	static ZSTD_DCtx* s_dctx = nullptr;
+	static std::vector<u8> s_delta_buffer;
+
+	// Only touched by the CPU thread.
+	static u32 s_frames_until_capture = 0;
+	static bool s_restore_pending = false;
+	static std::atomic_bool s_rewinding{false};
+} // namespace Rewind
+
+void Rewind::Initialize()
+{
+	if (!EmuConfig.EnableRewind || s_thread.joinable())
+		return;
+
+	s_max_compressed_size = static_cast<size_t>(std::max(EmuConfig.RewindBufferSize, 1u)) * static_cast<size_t>(_1mb);
+	s_frames_until_capture = 0;
+	s_rewinding.store(false, std::memory_order_relaxed);
+
+	for (u32 i = 0; i < NUM_STATE_BUFFERS; i++)
+		s_free_states.push_back(std::make_unique<ArchiveEntryList>());
+
+	// Captures reuse the pool buffers, so only main memory pages written since a buffer's
+	// previous capture need to be copied into it.
+	mmap_SetDirtyTrackingEnabled(true);
+
+	s_shutdown = false;
+	s_thread = std::thread(WorkerThreadEntryPoint);
+
+	Console.WriteLn("(Rewind) Capturing every %u frames, up to %u MB of compressed states.",
+		std::max(EmuConfig.RewindFrameInterval, 1u), static_cast<u32>(s_max_compressed_size / _1mb));
+}
+
+void Rewind::Shutdown()
+{
+	if (!s_thread.joinable())
+		return;
+
+	{
+		std::unique_lock lock(s_mutex);
+		s_shutdown = true;
+		s_work_cv.notify_one();
+	}
+
+	s_thread.join();
+
+	mmap_SetDirtyTrackingEnabled(false);
+
+	s_free_states.clear();
+	s_pending_states.clear();
+	s_head_state.reset();
+	s_delta_states.clear();
+	s_compressed_size = 0;
+	s_step_pending = false;
+	s_restore_pending = false;
+	s_rewinding.store(false, std::memory_order_relaxed);
+}
+
+void Rewind::Clear()
+{
+	if (!s_thread.joinable())
+		return;
+
+	std::unique_lock lock(s_mutex);
+	s_step_pending = false;
+	WaitForWorker(lock);
+
+	while (!s_pending_states.empty())
+	{
+		s_free_states.push_back(std::move(s_pending_states.front()));
+		s_pending_states.pop_front();
+	}
+	if (s_head_state)
+		s_free_states.push_back(std::move(s_head_state));
+
+	s_delta_states.clear();
+	s_compressed_size = 0;
+	s_frames_until_capture = 0;
+	s_restore_pending = false;
+}
+
+bool Rewind::IsActive()
+{
+	return s_thread.joinable() && !Achievements::IsHardcoreModeActive() && !g_InputRecording.isActive() &&
+		   !GSDumpReplayer::IsReplayingDump();
+}
+
+void Rewind::SetRewinding(bool enabled)
+{
+	s_rewinding.store(enabled, std::memory_order_relaxed);
+}
+
+u32 Rewind::GetStateCount()
+{
+	std::unique_lock lock(s_mutex);
+	return static_cast<u32>(s_delta_states.size()) + (s_head_state ? 1 : 0);
+}
+
+size_t Rewind::GetCompressedSize()
+{
+	std::unique_lock lock(s_mutex);
+	return s_compressed_size;
+}
+
+bool Rewind::FrameUpdate()
+{
+	if (!IsActive())
+		return false;
+
+	if (s_rewinding.load(std::memory_order_relaxed))
+	{
+		// Don't wait for the worker, if it's still stepping back from the last restore, try again next frame.
+		std::unique_lock lock(s_mutex);
+		s_restore_pending = (s_head_state && !s_worker_busy && !s_step_pending && s_pending_states.empty());
+		return s_restore_pending;
+	}
+
+	if (s_frames_until_capture > 0)
+	{
+		s_frames_until_capture--;
+		return false;
+	}
+
+	Common::Timer timer;
+
+	std::unique_ptr<ArchiveEntryList> state;
+	{
+		std::unique_lock lock(s_mutex);
+		if (s_free_states.empty())
+			return false;
+
+		state = std::move(s_free_states.back());
+		s_free_states.pop_back();
+	}
+
+	Error error;
+	if (!SaveState_DownloadState(state.get(), &error))
+	{
+		Console.Error(fmt::format("(Rewind) Failed to capture state: {}", error.GetDescription()));
+
+		std::unique_lock lock(s_mutex);
+		s_free_states.push_back(std::move(state));
+		return false;
+	}
+
+	{
+		std::unique_lock lock(s_mutex);
+		s_pending_states.push_back(std::move(state));
+		s_work_cv.notify_one();
+	}
+
+	s_frames_until_capture = std::max(EmuConfig.RewindFrameInterval, 1u) - 1;
+	PerformanceMetrics::OnRewindCapture(timer.GetTimeMilliseconds());
+	return false;
+}
+
+void Rewind::ApplyPendingRestore()
+{
+	if (!std::exchange(s_restore_pending, false) || !IsActive())
+		return;
+
+	Common::Timer timer;
+
+	// FrameUpdate() saw the worker idle, and it only picks up jobs from this thread, so the head can be read unlocked.
+	ArchiveEntryList* head;
+	{
+		std::unique_lock lock(s_mutex);
+		head = s_head_state.get();
+	}
+	if (!head)
+		return;
+
+	Error error;
+	if (!SaveState_LoadFromMemory(*head, &error))
+	{
+		Console.Error(fmt::format("(Rewind) Failed to restore state: {}", error.GetDescription()));
+		Clear();
+		return;
+	}
+
+	// Rebuild the next older state while the restored one runs, unless we're at the oldest.
+	{
+		std::unique_lock lock(s_mutex);
+		if (!s_delta_states.empty())
+		{
+			s_step_pending = true;
+			s_work_cv.notify_one();
+		}
+	}
+
+	s_frames_until_capture = std::max(EmuConfig.RewindFrameInterval, 1u);
+	PerformanceMetrics::OnRewindRestore(timer.GetTimeMilliseconds());
+}
+
+void Rewind::WaitForWorker(std::unique_lock<std::mutex>& lock)
+{
+	s_done_cv.wait(lock, []() { return !s_worker_busy && !s_step_pending && s_pending_states.empty(); });
+}
+
+void Rewind::WorkerThreadEntryPoint()
+{
+	Threading::SetNameOfCurrentThread("Rewind Compression");
+
+	s_cctx = ZSTD_createCCtx();
+	s_dctx = ZSTD_createDCtx();
+	ZSTD_CCtx_setParameter(s_cctx, ZSTD_c_compressionLevel, COMPRESSION_LEVEL);
+
+	std::unique_lock lock(s_mutex);
+	for (;;)
+	{
+		s_work_cv.wait(lock, []() { return s_shutdown || s_step_pending || !s_pending_states.empty(); });
+		if (s_shutdown)
+			break;
+
+		s_worker_busy = true;
+		if (s_step_pending)
+		{
+			lock.unlock();
+			StepHeadBack();
+			lock.lock();
+			s_step_pending = false;
+		}
+		else
+		{
+			std::unique_ptr<ArchiveEntryList> next = std::move(s_pending_states.front());
+			s_pending_states.pop_front();
+			lock.unlock();
+			CompressHead(next.get());
+			lock.lock();
+
+			if (s_head_state)
+				s_free_states.push_back(std::move(s_head_state));
+			s_head_state = std::move(next);
+		}
+
+		s_worker_busy = false;
+		s_done_cv.notify_all();
+	}
+
+	lock.unlock();
+
+	ZSTD_freeDCtx(s_dctx);
+	s_dctx = nullptr;
+	ZSTD_freeCCtx(s_cctx);
+	s_cctx = nullptr;
+	s_delta_buffer = {};
+}
+
+void Rewind::CompressHead(ArchiveEntryList* next)
+{
+	// Nothing to compress against for the first capture, it just becomes the head.
+	if (!s_head_state)
+		return;
+
+	const ArchiveEntryList& prev = *s_head_state;
+	const size_t prev_length = prev.GetDataLength();
+	const size_t next_length = next->GetDataLength();
+	const size_t common_length = std::min(prev_length, next_length);
+
+	// Bytes past the end of the newer state have nothing to XOR against, and are kept as-is.
+	s_delta_buffer.resize(prev_length);
+	std::memcpy(s_delta_buffer.data(), prev.GetBuffer().data(), prev_length);
+	XorInto(s_delta_buffer.data(), next->GetBuffer().data(), common_length);
+
+	DeltaState delta;
+	delta.compressed.resize(ZSTD_compressBound(prev_length));
+	const size_t compressed_size = ZSTD_compress2(s_cctx, delta.compressed.data(), delta.compressed.size(),
+		s_delta_buffer.data(), prev_length);
+	if (ZSTD_isError(compressed_size))
+	{
+		Console.Error("(Rewind) Failed to compress state: %s", ZSTD_getErrorName(compressed_size));
+		return;
+	}
+
+	delta.compressed.resize(compressed_size);
+	delta.compressed.shrink_to_fit();
+	delta.entries = prev.GetEntries();
+	delta.length = prev_length;
+
+	std::unique_lock lock(s_mutex);
+	s_compressed_size += compressed_size;
+	s_delta_states.push_back(std::move(delta));
+	while (s_compressed_size > s_max_compressed_size && !s_delta_states.empty())
+	{
+		s_compressed_size -= s_delta_states.front().compressed.size();
+		s_delta_states.pop_front();
+	}
+}
+
+void Rewind::StepHeadBack()
+{
+	// The CPU thread doesn't touch the head or the newest delta while a step is pending.
+	DeltaState& delta = s_delta_states.back();
+	ArchiveEntryList& head = *s_head_state;
+	const size_t head_length = head.GetDataLength();
+	const size_t common_length = std::min(head_length, delta.length);
+
+	s_delta_buffer.resize(delta.length);
+	const size_t size = ZSTD_decompressDCtx(s_dctx, s_delta_buffer.data(), s_delta_buffer.size(),
+		delta.compressed.data(), delta.compressed.size());
+
+	if (ZSTD_isError(size) || size != delta.length)
+	{
+		Console.Error("(Rewind) Failed to decompress state, dropping older states.");
+
+		std::unique_lock lock(s_mutex);
+		s_delta_states.clear();
+		s_compressed_size = 0;
+		return;
+	}
+
+	if (head.GetBuffer().size() < delta.length)
+		head.GetBuffer().resize(delta.length);
+
+	u8* data = head.GetBuffer().data();
+	XorInto(data, s_delta_buffer.data(), common_length);
+	if (delta.length > common_length)
+		std::memcpy(data + common_length, s_delta_buffer.data() + common_length, delta.length - common_length);
+
+	head.SetEntries(std::move(delta.entries));
+	head.SetDirtyGeneration(0);
+
+	std::unique_lock lock(s_mutex);
+	s_compressed_size -= delta.compressed.size();
+	s_delta_states.pop_back();
+}
+
+void Rewind::XorInto(u8* dst, const u8* src, size_t size)
+{
+	size_t pos = 0;
+	for (; (pos + sizeof(u64)) <= size; pos += sizeof(u64))
+	{
+		u64 a, b;
+		std::memcpy(&a, dst + pos, sizeof(a));
+		std::memcpy(&b, src + pos, sizeof(b));
+		a ^= b;
+		std::memcpy(dst + pos, &a, sizeof(a));
+	}
+	for (; pos < size; pos++)
+		dst[pos] ^= src[pos];
+}
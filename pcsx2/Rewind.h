@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
+// SPDX-License-Identifier: GPL-3.0+
+
+#pragma once
+
+#include "common/Pcsx2Defs.h"
+
+/// Keeps a ring of recent in-memory save states so the running game can be stepped backwards.
+/// Only the newest state is held uncompressed. Older states are stored as zstd-compressed XOR
+/// deltas against their successor, which are produced by a background thread.
+/// Memory use is RewindBufferSize for the deltas, plus three uncompressed states (the newest, one
+/// waiting for compression and one being captured), each as large as a save state before zipping.
+namespace Rewind
+{
+	/// Starts the compression thread if rewind is enabled in the current configuration.
+	void Initialize();
+
+	/// Stops the compression thread and frees all captured states.
+	void Shutdown();
+
+	/// Drops all captured states, used when the timeline changes (state load, reset).
+	void Clear();
+
+	/// Captures a new state, or while rewinding, checks whether the previous one can be restored. Called once
+	/// per frame on the CPU thread. Returns true if a restore is ready, in which case the caller should leave
+	/// execution and call ApplyPendingRestore() before resuming, since states can't be loaded mid-frame.
+	bool FrameUpdate();
+
+	/// Loads the state readied by FrameUpdate(), if any. Called on the CPU thread while the CPU isn't executing.
+	void ApplyPendingRestore();
+
+	/// Returns true if states are being captured, i.e. rewind is enabled and allowed for the running game.
+	bool IsActive();
+
+	/// Sets whether the hotkey is held. While held, every frame restores the previous captured state.
+	void SetRewinding(bool enabled);
+
+	/// Returns the number of states which can be rewound to.
+	u32 GetStateCount();
+
+	/// Returns the number of bytes used by compressed states.
+	size_t GetCompressedSize();
+} // namespace Rewind
@@ -15,6 +15,7 @@
 #include "common/FileSystem.h"
 #include "common/Path.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
 #include "common/Timer.h"
 
 #include "fmt/core.h"
@@ -118,8 +119,15 @@ FolderMemoryCard::FolderMemoryCard()
 {
 }
 
+FolderMemoryCard::~FolderMemoryCard()
+{
+	WaitForFlush();
+}
+
 void FolderMemoryCard::InitializeInternalData()
 {
+	WaitForFlush();
+
 	memset(&m_superBlock, 0xFF, sizeof(m_superBlock));
 	memset(&m_indirectFat, 0xFF, sizeof(m_indirectFat));
 	memset(&m_fat, 0xFF, sizeof(m_fat));
@@ -211,6 +219,7 @@ void FolderMemoryCard::Close(bool flush)
 	{
 		Flush();
 	}
+	WaitForFlush();
 
 	m_cache.clear();
 	m_oldDataCache.clear();
@@ -916,6 +925,9 @@ bool FolderMemoryCard::ReadFromFile(u8* dest, u32 adr, u32 dataLength)
 	auto it = m_fileMetadataQuickAccess.find(fatCluster);
 	if (it != m_fileMetadataQuickAccess.end())
 	{
+		// the file may still be getting replaced by the last flush
+		WaitForFlush();
+
 		const u32 clusterNumber = it->second.consecutiveCluster;
 		std::FILE* file = m_lastAccessedFile.ReOpen(m_folderName, &it->second);
 		if (file)
@@ -1067,6 +1079,11 @@ s32 FolderMemoryCard::Save(const u8* src, u32 adr, int size)
 
 void FolderMemoryCard::NextFrame()
 {
+	if (m_flushThread.joinable() && !m_flushInProgress.load(std::memory_order_acquire))
+	{
+		m_flushThread.join();
+	}
+
 	if (m_framesUntilFlush > 0 && --m_framesUntilFlush == 0)
 	{
 		Flush();
@@ -1074,6 +1091,38 @@ void FolderMemoryCard::NextFrame()
 }
 
 void FolderMemoryCard::Flush()
+{
+	if (m_cache.empty())
+	{
+		return;
+	}
+
+	if (!m_performFileWrites)
+	{
+		FlushCache();
+		return;
+	}
+
+	// The file system has to be in the state the last flush left it in before the next one is written on top of it.
+	WaitForFlush();
+
+	// Everything the host file system needs is copied off to the writer thread, after which the cache only has to be
+	// applied to the internal data here. Open files are closed since the writer may replace or rename them.
+	std::unique_ptr<FolderMemoryCard> flushCopy = CreateFlushCopy();
+	m_lastAccessedFile.CloseAll();
+	m_performFileWrites = false;
+	FlushCache();
+	m_performFileWrites = true;
+
+	m_flushInProgress.store(true, std::memory_order_relaxed);
+	m_flushThread = std::thread([this, flushCopy = std::move(flushCopy)]() {
+		Threading::SetNameOfCurrentThread("Folder Memcard Writer");
+		flushCopy->FlushCache();
+		m_flushInProgress.store(false, std::memory_order_release);
+	});
+}
+
+void FolderMemoryCard::FlushCache()
 {
 	if (m_cache.empty())
 	{
@@ -1084,7 +1133,8 @@ void FolderMemoryCard::Flush()
 	WriteToFile(m_folderName.GetFullPath().RemoveLast() + L"-debug_" + wxDateTime::Now().Format(L"%Y-%m-%d-%H-%M-%S") + L"_pre-flush.ps2");
 #endif
 
-	Console.WriteLn("(FolderMcd) Writing data for slot %u to file system...", m_slot);
+	if (m_performFileWrites)
+		Console.WriteLn("(FolderMcd) Writing data for slot %u to file system...", m_slot);
 	Common::Timer timeFlushStart;
 
 	// Keep a copy of the old file entries so we can figure out which files and directories, if any, have been deleted from the memory card.
@@ -1106,7 +1156,8 @@ void FolderMemoryCard::Flush()
 	FlushBlock(m_superBlock.data.backup_block2);
 	if (m_backupBlock2.programmedBlock != 0xFFFFFFFFu)
 	{
-		Console.Warning("(FolderMcd) Aborting flush of slot %u, emulation was interrupted during save process!", m_slot);
+		if (m_performFileWrites)
+			Console.Warning("(FolderMcd) Aborting flush of slot %u, emulation was interrupted during save process!", m_slot);
 		return;
 	}
 
@@ -1148,17 +1199,81 @@ void FolderMemoryCard::Flush()
 		FlushPage(i);
 	}
 
+	if (m_batchFileWrites)
+	{
+		WriteBatchedFiles();
+	}
+
 	m_lastAccessedFile.FlushAll();
 	m_lastAccessedFile.ClearMetadataWriteState();
 	m_oldDataCache.clear();
 
-	Console.WriteLn("(FolderMcd) Done! Took %.2f ms.", timeFlushStart.GetTimeMilliseconds());
+	if (m_performFileWrites)
+		Console.WriteLn("(FolderMcd) Done! Took %.2f ms.", timeFlushStart.GetTimeMilliseconds());
 
 #ifdef DEBUG_WRITE_FOLDER_CARD_IN_MEMORY_TO_FILE_ON_CHANGE
 	WriteToFile(m_folderName.GetFullPath().RemoveLast() + L"-debug_" + wxDateTime::Now().Format(L"%Y-%m-%d-%H-%M-%S") + L"_post-flush.ps2");
 #endif
 }
 
+std::unique_ptr<FolderMemoryCard> FolderMemoryCard::CreateFlushCopy() const
+{
+	std::unique_ptr<FolderMemoryCard> copy = std::make_unique<FolderMemoryCard>();
+	std::memcpy(&copy->m_superBlock, &m_superBlock, sizeof(m_superBlock));
+	std::memcpy(&copy->m_indirectFat, &m_indirectFat, sizeof(m_indirectFat));
+	std::memcpy(&copy->m_fat, &m_fat, sizeof(m_fat));
+	std::memcpy(&copy->m_backupBlock1, &m_backupBlock1, sizeof(m_backupBlock1));
+	std::memcpy(&copy->m_backupBlock2, &m_backupBlock2, sizeof(m_backupBlock2));
+	copy->m_fileEntryDict = m_fileEntryDict;
+	copy->m_cache = m_cache;
+	copy->m_oldDataCache = m_oldDataCache;
+	copy->m_folderName = m_folderName;
+	copy->m_slot = m_slot;
+	copy->m_isEnabled = m_isEnabled;
+	copy->m_performFileWrites = true;
+	copy->m_filteringEnabled = m_filteringEnabled;
+	copy->m_filteringString = m_filteringString;
+	copy->m_batchFileWrites = true;
+
+	// m_fileMetadataQuickAccess points into m_fileEntryDict, so it's left for FlushFileEntries() to rebuild
+	// from the copied entries before any file data is written.
+	return copy;
+}
+
+void FolderMemoryCard::WaitForFlush()
+{
+	if (m_flushThread.joinable())
+	{
+		m_flushThread.join();
+	}
+}
+
+void FolderMemoryCard::WriteBatchedFiles()
+{
+	// files are replaced below, which doesn't work while they're still open on Windows
+	m_lastAccessedFile.CloseAll();
+
+	for (const auto& [filePath, data] : m_batchedFileWrites)
+	{
+		// write the new contents next to the file first, so it's never left half-written
+		const std::string tempPath(Path::Combine(Path::GetDirectory(filePath), fmt::format("_pcsx2_temp_{}", Path::GetFileName(filePath))));
+		bool written = false;
+		if (auto tempFile = FileSystem::OpenManagedCFile(tempPath.c_str(), "wb"); tempFile)
+		{
+			written = (data.empty() || std::fwrite(data.data(), data.size(), 1, tempFile.get()) == 1) &&
+					  std::fflush(tempFile.get()) == 0;
+		}
+
+		if (!written || !FileSystem::RenamePath(tempPath.c_str(), filePath.c_str()))
+		{
+			Console.Error("(FolderMcd) Failed to write '%s' for slot %u.", filePath.c_str(), m_slot);
+			FileSystem::DeleteFilePath(tempPath.c_str());
+		}
+	}
+
+	m_batchedFileWrites.clear();
+}
+
 bool FolderMemoryCard::FlushPage(const u32 page)
 {
 	auto it = m_cache.find(page);
@@ -1395,14 +1510,17 @@ void FolderMemoryCard::FlushDeletedFilesAndRemoveUnchangedDataFromCache(const st
 				const std::string fullDirPath(Path::Combine(m_folderName, dirPath));
 				const std::string filePath(Path::Combine(fullDirPath, cleanName));
 				m_lastAccessedFile.CloseMatching(filePath);
-				const std::string newFilePath(Path::Combine(Path::Combine(m_folderName, dirPath), fmt::format("_pcsx2_deleted_{}", cleanName)));
-				if (FileSystem::DirectoryExists(newFilePath.c_str()))
+				if (m_performFileWrites)
 				{
-					// wxRenameFile doesn't overwrite directories, so we have to remove the old one first
-					FileSystem::RecursiveDeleteDirectory(newFilePath.c_str());
+					const std::string newFilePath(Path::Combine(Path::Combine(m_folderName, dirPath), fmt::format("_pcsx2_deleted_{}", cleanName)));
+					if (FileSystem::DirectoryExists(newFilePath.c_str()))
+					{
+						// wxRenameFile doesn't overwrite directories, so we have to remove the old one first
+						FileSystem::RecursiveDeleteDirectory(newFilePath.c_str());
+					}
+					FileSystem::RenamePath(filePath.c_str(), newFilePath.c_str());
+					DeleteFromIndex(fullDirPath, cleanName);
 				}
-				FileSystem::RenamePath(filePath.c_str(), newFilePath.c_str());
-				DeleteFromIndex(fullDirPath, cleanName);
 			}
 			else if (entry->IsDir())
 			{
@@ -1524,18 +1642,46 @@ bool FolderMemoryCard::WriteToFile(const u8* src, u32 adr, u32 dataLength)
 	{
 		const MemoryCardFileEntry* const entry = it->second.entry;
 		const u32 clusterNumber = it->second.consecutiveCluster;
+		const u32 clusterOffset = (page % 2) * PageSize + offset;
+		const u32 fileSize = entry->entry.data.length;
+		const u32 fileOffsetStart = std::min(clusterNumber * ClusterSize + clusterOffset, fileSize);
+		const u32 fileOffsetEnd = std::min(fileOffsetStart + dataLength, fileSize);
+		const u32 bytesToWrite = fileOffsetEnd - fileOffsetStart;
 
-		if (m_performFileWrites)
+		if (m_performFileWrites && m_batchFileWrites)
+		{
+			std::string filePath(m_folderName);
+			it->second.GetPath(&filePath);
+
+			auto batch = m_batchedFileWrites.find(filePath);
+			if (batch == m_batchedFileWrites.end())
+			{
+				// creates the file and its metadata if necessary, and starts the batch off with what's already in there
+				std::FILE* file = m_lastAccessedFile.ReOpen(m_folderName, &it->second, true);
+				std::optional<std::vector<u8>> contents = file ? FileSystem::ReadBinaryFile(file) : std::nullopt;
+				if (!contents.has_value())
+				{
+					return false;
+				}
+
+				batch = m_batchedFileWrites.emplace(std::move(filePath), std::move(contents.value())).first;
+			}
+
+			std::vector<u8>& data = batch->second;
+			if (data.size() < fileOffsetEnd)
+			{
+				data.resize(fileOffsetEnd, 0xFF);
+			}
+			if (bytesToWrite > 0)
+			{
+				std::memcpy(&data[fileOffsetStart], src, bytesToWrite);
+			}
+		}
+		else if (m_performFileWrites)
 		{
 			std::FILE* file = m_lastAccessedFile.ReOpen(m_folderName, &it->second, true);
 			if (file)
 			{
-				const u32 clusterOffset = (page % 2) * PageSize + offset;
-				const u32 fileSize = entry->entry.data.length;
-				const u32 fileOffsetStart = std::min(clusterNumber * ClusterSize + clusterOffset, fileSize);
-				const u32 fileOffsetEnd = std::min(fileOffsetStart + dataLength, fileSize);
-				const u32 bytesToWrite = fileOffsetEnd - fileOffsetStart;
-
 				u32 actualFileSize = static_cast<u32>(std::clamp<s64>(FileSystem::FSize64(file), 0, std::numeric_limits<u32>::max()));
 				if (actualFileSize < fileOffsetStart)
 				{
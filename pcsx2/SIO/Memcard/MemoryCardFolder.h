@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "Config.h"
@@ -307,9 +310,17 @@ protected:
 	bool m_filteringEnabled;
 	std::string m_filteringString;
 
+	// writes a copy of the card made by Flush() to the file system, so the emulation thread doesn't have to wait for it
+	std::thread m_flushThread;
+	std::atomic_bool m_flushInProgress{false};
+
+	// if set, file data is collected per host file while flushing and written out in one go by WriteBatchedFiles()
+	bool m_batchFileWrites = false;
+	std::map<std::string, std::vector<u8>> m_batchedFileWrites;
+
 public:
 	FolderMemoryCard();
-	virtual ~FolderMemoryCard() = default;
+	virtual ~FolderMemoryCard();
 
 	void Lock();
 	void Unlock();
@@ -468,9 +479,21 @@ protected:
 	bool WriteToFile(const u8* src, u32 adr, u32 dataLength);
 
 
-	// flush the whole cache to the internal data and/or host file system
+	// flush the whole cache to the internal data, and hand a copy of the card to a thread that writes it to the host file system
 	void Flush();
 
+	// flush the whole cache to the internal data and/or host file system
+	void FlushCache();
+
+	// copy of the card state needed to flush the cache, with file data writes batched up per host file
+	std::unique_ptr<FolderMemoryCard> CreateFlushCopy() const;
+
+	// wait for the host file system to be up to date with the last flush
+	void WaitForFlush();
+
+	// write the file data collected while flushing, replacing each file atomically
+	void WriteBatchedFiles();
+
 	// flush a single page of the cache to the internal data and/or host file system
 	bool FlushPage(const u32 page);
 
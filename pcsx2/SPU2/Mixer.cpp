@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
 // SPDX-License-Identifier: GPL-3.0+
 
+#include "GS/GSVector.h"
 #include "Host/AudioStream.h"
 #include "SPU2/Debug.h"
 #include "SPU2/defs.h"
@@ -455,9 +456,199 @@ static __forceinline StereoOut32 MixVoice(uint coreidx, uint voiceidx)
 	return voiceOut;
 }
 
+// Inputs to the interpolation and volume stages for every voice of a core, so they can be done
+// for several voices at once. Noise and stopped voices are expressed as coefficients as well, a
+// single 0x8000 coefficient passes the sample through unchanged and all zeros gives silence.
+struct alignas(32) VoiceBatch
+{
+	s32 Coef[4][V_Core::NumVoices];
+	s32 PV[4][V_Core::NumVoices]; // PV4, PV3, PV2, PV1
+	s32 ADSR[V_Core::NumVoices];
+	s32 VolL[V_Core::NumVoices];
+	s32 VolR[V_Core::NumVoices];
+	s32 DryL[V_Core::NumVoices];
+	s32 DryR[V_Core::NumVoices];
+	s32 WetL[V_Core::NumVoices];
+	s32 WetR[V_Core::NumVoices];
+	s32 Value[V_Core::NumVoices]; // post ADSR
+	bool Active[V_Core::NumVoices];
+};
+
+static VoiceBatch s_voice_batch;
+
+// The batched mixer steps every voice through memory before mixing any of them. That only matches
+// mixing them one at a time when no voice is modulated by the output of the one before it, and no
+// voice can read from the dynamic area the voice output gets written back to.
+static __forceinline bool CanBatchCoreVoices(const V_Core& thiscore)
+{
+	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; ++voiceidx)
+	{
+		const V_Voice& vc(thiscore.Voices[voiceidx]);
+
+		if (vc.Modulated && voiceidx != 0)
+			return false;
+
+		// NextA wraps around to the start of memory past 0xFFFFF.
+		if (vc.NextA < SPU2_DYN_MEMLINE || vc.NextA >= 0xFFFF0 || vc.LoopStartA < SPU2_DYN_MEMLINE ||
+			(vc.PendingLoopStart && vc.PendingLoopStartA < SPU2_DYN_MEMLINE))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Everything MixVoice() does up to the interpolation, in the same order.
+static __forceinline void PrepareVoice(uint coreidx, uint voiceidx, VoiceBatch& batch)
+{
+	V_Core& thiscore(Cores[coreidx]);
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	pxAssertMsg((vc.SCurrent <= 28) && (vc.SCurrent != 0), "Current sample should always range from 1->28");
+
+	vc.Volume.Update();
+	UpdatePitch(coreidx, voiceidx);
+
+	s32 coef[4] = {};
+	s32 pv[4] = {};
+	s32 adsr = 0;
+
+	if (vc.ADSR.Phase > V_ADSR::PHASE_STOPPED)
+	{
+		if (vc.Noise)
+		{
+			coef[3] = 0x8000;
+			pv[3] = GetNoiseValues(thiscore);
+		}
+		else
+		{
+			while (vc.SP >= 0)
+			{
+				vc.PV4 = vc.PV3;
+				vc.PV3 = vc.PV2;
+				vc.PV2 = vc.PV1;
+				vc.PV1 = GetNextDataBuffered(thiscore, voiceidx);
+				vc.SP -= 0x1000;
+			}
+
+			const s32 mu = vc.SP + 0x1000;
+			const auto& table = interpTable[(mu & 0x0ff0) >> 4];
+			for (int i = 0; i < 4; i++)
+				coef[i] = table[i];
+
+			pv[0] = vc.PV4;
+			pv[1] = vc.PV3;
+			pv[2] = vc.PV2;
+			pv[3] = vc.PV1;
+		}
+
+		CalculateADSR(thiscore, voiceidx);
+		adsr = vc.ADSR.Value;
+		batch.Active[voiceidx] = true;
+	}
+	else
+	{
+		while (vc.SP >= 0)
+			GetNextDataDummy(thiscore, voiceidx); // Dummy is enough
+
+		batch.Active[voiceidx] = false;
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		batch.Coef[i][voiceidx] = coef[i];
+		batch.PV[i][voiceidx] = pv[i];
+	}
+
+	batch.ADSR[voiceidx] = adsr;
+	batch.VolL[voiceidx] = vc.Volume.Left.Value;
+	batch.VolR[voiceidx] = vc.Volume.Right.Value;
+	batch.DryL[voiceidx] = thiscore.VoiceGates[voiceidx].DryL;
+	batch.DryR[voiceidx] = thiscore.VoiceGates[voiceidx].DryR;
+	batch.WetL[voiceidx] = thiscore.VoiceGates[voiceidx].WetL;
+	batch.WetR[voiceidx] = thiscore.VoiceGates[voiceidx].WetR;
+}
+
+template <typename V>
+static __forceinline s32 HorizontalSum32(const V& v)
+{
+	alignas(32) s32 lanes[sizeof(V) / sizeof(s32)];
+	V::template store<true>(lanes, v);
+
+	s32 sum = 0;
+	for (const s32 lane : lanes)
+		sum += lane;
+	return sum;
+}
+
+// Interpolation, ADSR and volume for all voices. Each product is shifted on its own, same as the
+// scalar code, so the results are identical.
+template <typename V>
+static __forceinline void MixVoiceBatch(VoiceBatch& batch, VoiceMixSet& dest)
+{
+	constexpr uint lanes = sizeof(V) / sizeof(s32);
+	static_assert((V_Core::NumVoices % lanes) == 0);
+
+	V dry_l = V::zero(), dry_r = V::zero(), wet_l = V::zero(), wet_r = V::zero();
+
+	for (uint i = 0; i < V_Core::NumVoices; i += lanes)
+	{
+		V interp = V::template load<true>(&batch.Coef[0][i]).mul32l(V::template load<true>(&batch.PV[0][i])).template sra32<15>();
+		for (int tap = 1; tap < 4; tap++)
+			interp = interp.add32(V::template load<true>(&batch.Coef[tap][i]).mul32l(V::template load<true>(&batch.PV[tap][i])).template sra32<15>());
+
+		const V value = V::template load<true>(&batch.ADSR[i]).mul32l(interp).template sra32<15>();
+		V::template store<true>(&batch.Value[i], value);
+
+		const V left = V::template load<true>(&batch.VolL[i]).mul32l(value).template sra32<15>();
+		const V right = V::template load<true>(&batch.VolR[i]).mul32l(value).template sra32<15>();
+
+		dry_l = dry_l.add32(left & V::template load<true>(&batch.DryL[i]));
+		dry_r = dry_r.add32(right & V::template load<true>(&batch.DryR[i]));
+		wet_l = wet_l.add32(left & V::template load<true>(&batch.WetL[i]));
+		wet_r = wet_r.add32(right & V::template load<true>(&batch.WetR[i]));
+	}
+
+	dest.Dry.Left += HorizontalSum32(dry_l);
+	dest.Dry.Right += HorizontalSum32(dry_r);
+	dest.Wet.Left += HorizontalSum32(wet_l);
+	dest.Wet.Right += HorizontalSum32(wet_r);
+}
+
+static __forceinline void MixCoreVoicesBatched(VoiceMixSet& dest, const uint coreidx)
+{
+	VoiceBatch& batch = s_voice_batch;
+
+	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; ++voiceidx)
+		PrepareVoice(coreidx, voiceidx, batch);
+
+	// This file isn't built per ISA, so eight lanes are only used when the whole build targets AVX2.
+#if _M_SSE >= 0x501
+	MixVoiceBatch<GSVector8i>(batch, dest);
+#else
+	MixVoiceBatch<GSVector4i>(batch, dest);
+#endif
+
+	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; ++voiceidx)
+	{
+		if (!batch.Active[voiceidx])
+			continue;
+
+		Cores[coreidx].Voices[voiceidx].OutX = batch.Value[voiceidx];
+
+		if (IsDevBuild)
+			DebugCores[coreidx].Voices[voiceidx].displayPeak = std::max(DebugCores[coreidx].Voices[voiceidx].displayPeak, batch.Value[voiceidx]);
+	}
+
+	// Write-back of raw voice data (post ADSR applied)
+	spu2M_WriteFast(((0 == coreidx) ? 0x400 : 0xc00) + OutPos, batch.Value[1]);
+	spu2M_WriteFast(((0 == coreidx) ? 0x600 : 0xe00) + OutPos, batch.Value[3]);
+}
+
 const VoiceMixSet VoiceMixSet::Empty((StereoOut32()), (StereoOut32())); // Don't use SteroOut32::Empty because C++ doesn't make any dep/order checks on global initializers.
 
-static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx)
+static __forceinline void MixCoreVoicesScalar(VoiceMixSet& dest, const uint coreidx)
 {
 	V_Core& thiscore(Cores[coreidx]);
 
@@ -474,6 +665,29 @@ static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx)
 	}
 }
 
+static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx)
+{
+	if (CanBatchCoreVoices(Cores[coreidx]))
+		MixCoreVoicesBatched(dest, coreidx);
+	else
+		MixCoreVoicesScalar(dest, coreidx);
+}
+
+bool spu2MixCoreVoices(VoiceMixSet& dest, uint coreidx, bool batched)
+{
+	if (!batched)
+	{
+		MixCoreVoicesScalar(dest, coreidx);
+		return true;
+	}
+
+	if (!CanBatchCoreVoices(Cores[coreidx]))
+		return false;
+
+	MixCoreVoicesBatched(dest, coreidx);
+	return true;
+}
+
 StereoOut32 V_Core::Mix(const VoiceMixSet& inVoices, const StereoOut32& Input, const StereoOut32& Ext)
 {
 	MasterVol.Update();
@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
+// SPDX-License-Identifier: GPL-3.0+
+
+#include "SPU2/MixerThread.h"
+#include "SPU2/defs.h"
+#include "SPU2/spu2.h"
+#include "Config.h"
+#include "IopDma.h"
+
+#include "common/Console.h"
+#include "common/Threading.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace SPU2
+{
+	namespace
+	{
+		enum class MixerCommandType : u32
+		{
+			Tick,
+			Write,
+		};
+
+		struct MixerCommand
+		{
+			MixerCommandType type;
+			u32 arg; // tick count or register address
+			u16 value;
+		};
+
+		enum : u32
+		{
+			DEFERRED_IRQ = (1u << 0),
+			DEFERRED_DMA4_IRQ = (1u << 1),
+			DEFERRED_DMA7_IRQ = (1u << 2),
+		};
+	} // namespace
+
+	static void MixerThreadEntryPoint();
+	static void PushCommand(const MixerCommand& cmd);
+	static void ExecuteCommand(const MixerCommand& cmd);
+	static bool IsDMARunning();
+
+	static constexpr u32 QUEUE_SIZE = 16384; // must be a power of two
+
+	// Single producer (CPU thread), single consumer (mixer thread).
+	static std::array<MixerCommand, QUEUE_SIZE> s_queue;
+	alignas(__cachelinesize) static std::atomic<u32> s_write_pos{0};
+	alignas(__cachelinesize) static std::atomic<u32> s_read_pos{0};
+
+	static Threading::WorkSema s_work_sema;
+	static std::thread s_thread;
+	static std::atomic_bool s_shutdown{false};
+	static bool s_active = false;
+
+	// Interrupts raised while mixing on the mixer thread, delivered by the CPU thread.
+	static std::atomic<u32> s_deferred_irqs{0};
+	static thread_local bool s_on_mixer_thread = false;
+
+	// Only touched by the CPU thread. Set by a sync, so the DMA state is sampled the next time work is
+	// queued, while the mixer thread is still idle. DMAs are only started from the CPU thread.
+	static bool s_cpu_owns_state = true;
+	static bool s_dma_running = false;
+} // namespace SPU2
+
+void SPU2::UpdateMixerThread()
+{
+	const bool wanted = EmuConfig.SPU2.AsyncMixing && !IsRunningPSXMode();
+	if (wanted == s_active)
+		return;
+
+	if (!wanted)
+	{
+		ShutdownMixerThread();
+		return;
+	}
+
+	s_write_pos.store(0, std::memory_order_relaxed);
+	s_read_pos.store(0, std::memory_order_relaxed);
+	s_deferred_irqs.store(0, std::memory_order_relaxed);
+	s_shutdown.store(false, std::memory_order_relaxed);
+	s_cpu_owns_state = true;
+	s_work_sema.Reset();
+	s_thread = std::thread(MixerThreadEntryPoint);
+	s_active = true;
+
+	Console.WriteLn("(SPU2) Mixing on a separate thread.");
+}
+
+void SPU2::ShutdownMixerThread()
+{
+	if (!s_active)
+		return;
+
+	SyncMixerThread();
+
+	s_shutdown.store(true, std::memory_order_release);
+	s_work_sema.NotifyOfWork();
+	s_thread.join();
+	s_active = false;
+}
+
+bool SPU2::IsMixerThreadActive()
+{
+	return s_active;
+}
+
+void SPU2::SyncMixerThread()
+{
+	if (!s_active)
+		return;
+
+	// Only round trip with the mixer thread if something was queued since the last sync, games poll registers in tight loops.
+	if (!s_cpu_owns_state)
+	{
+		s_work_sema.NotifyOfWork();
+		s_work_sema.WaitForEmptyWithSpin();
+		s_cpu_owns_state = true;
+	}
+
+	const u32 irqs = s_deferred_irqs.exchange(0, std::memory_order_acquire);
+	if (irqs & DEFERRED_IRQ)
+		spu2Irq();
+	if (irqs & DEFERRED_DMA4_IRQ)
+		spu2DMA4Irq();
+	if (irqs & DEFERRED_DMA7_IRQ)
+		spu2DMA7Irq();
+}
+
+bool SPU2::IsDMARunning()
+{
+	// Input DMAs advance MADR and read IOP memory while mixing, which the IOP can access at any time.
+	for (const V_Core& core : Cores)
+	{
+		if (core.DMAICounter > 0 || core.InputDataTransferred > 0 || core.InputDataLeft > 0 || core.AdmaInProgress)
+			return true;
+	}
+
+	return false;
+}
+
+bool SPU2::MixerThreadNeedsSync()
+{
+	if (s_deferred_irqs.load(std::memory_order_relaxed) & (DEFERRED_DMA4_IRQ | DEFERRED_DMA7_IRQ))
+		return true;
+
+	// The state can only be looked at directly while the mixer thread is idle.
+	return s_cpu_owns_state ? IsDMARunning() : s_dma_running;
+}
+
+void SPU2::QueueMixerTicks(u32 ticks)
+{
+	PushCommand(MixerCommand{MixerCommandType::Tick, ticks, 0});
+
+	// Writes are left for the next tick (or sync) to pick up, they don't change anything audible by themselves.
+	s_work_sema.NotifyOfWork();
+}
+
+void SPU2::QueueMixerWrite(u32 rmem, u16 value)
+{
+	PushCommand(MixerCommand{MixerCommandType::Write, rmem, value});
+}
+
+void SPU2::DeliverMixerIrqs()
+{
+	if (!(s_deferred_irqs.load(std::memory_order_relaxed) & DEFERRED_IRQ))
+		return;
+
+	if (s_deferred_irqs.fetch_and(~DEFERRED_IRQ, std::memory_order_acquire) & DEFERRED_IRQ)
+		spu2Irq();
+}
+
+void SPU2::RaiseIrq()
+{
+	if (s_on_mixer_thread)
+		s_deferred_irqs.fetch_or(DEFERRED_IRQ, std::memory_order_release);
+	else
+		spu2Irq();
+}
+
+void SPU2::RaiseDMAIrq(u32 core)
+{
+	if (s_on_mixer_thread)
+		s_deferred_irqs.fetch_or((core == 0) ? DEFERRED_DMA4_IRQ : DEFERRED_DMA7_IRQ, std::memory_order_release);
+	else if (core == 0)
+		spu2DMA4Irq();
+	else
+		spu2DMA7Irq();
+}
+
+void SPU2::PushCommand(const MixerCommand& cmd)
+{
+	if (s_cpu_owns_state)
+	{
+		s_cpu_owns_state = false;
+		s_dma_running = IsDMARunning();
+	}
+
+	const u32 write_pos = s_write_pos.load(std::memory_order_relaxed);
+	const u32 next_pos = (write_pos + 1) & (QUEUE_SIZE - 1);
+	if (next_pos == s_read_pos.load(std::memory_order_acquire))
+	{
+		// Mixer thread has fallen a whole queue behind, let it catch up.
+		s_work_sema.NotifyOfWork();
+		s_work_sema.WaitForEmptyWithSpin();
+	}
+
+	s_queue[write_pos] = cmd;
+	s_write_pos.store(next_pos, std::memory_order_release);
+}
+
+void SPU2::ExecuteCommand(const MixerCommand& cmd)
+{
+	switch (cmd.type)
+	{
+		case MixerCommandType::Tick:
+			MixTicks(cmd.arg);
+			break;
+
+		case MixerCommandType::Write:
+			SPU2_FastWrite(cmd.arg, cmd.value);
+			break;
+
+			jNO_DEFAULT;
+	}
+}
+
+void SPU2::MixerThreadEntryPoint()
+{
+	Threading::SetNameOfCurrentThread("SPU2 Mixer");
+	s_on_mixer_thread = true;
+
+	for (;;)
+	{
+		s_work_sema.WaitForWork();
+		if (s_shutdown.load(std::memory_order_acquire))
+			break;
+
+		u32 read_pos = s_read_pos.load(std::memory_order_relaxed);
+		while (read_pos != s_write_pos.load(std::memory_order_acquire))
+		{
+			ExecuteCommand(s_queue[read_pos]);
+			read_pos = (read_pos + 1) & (QUEUE_SIZE - 1);
+			s_read_pos.store(read_pos, std::memory_order_release);
+		}
+	}
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
+// SPDX-License-Identifier: GPL-3.0+
+
+#pragma once
+
+#include "common/Pcsx2Defs.h"
+
+/// Optional asynchronous mixing. Register writes and elapsed ticks are pushed onto a lock-free queue and
+/// replayed in order by a dedicated thread, which mixes and feeds the output stream. The CPU thread only
+/// waits for the queue to drain when it needs to look at the SPU2 state itself (register reads, DMA,
+/// savestates), after which it owns the state until it queues more work. Interrupts raised on the mixer
+/// thread are delivered at the CPU thread's next update, so their timing depends on the host.
+namespace SPU2
+{
+	/// Starts or stops the mixer thread to match the configuration. PSX mode always mixes on the CPU thread.
+	void UpdateMixerThread();
+
+	/// Replays anything still queued and stops the mixer thread.
+	void ShutdownMixerThread();
+
+	/// Returns true if ticks and register writes are being handed to the mixer thread.
+	bool IsMixerThreadActive();
+
+	/// Waits for the mixer thread to replay everything queued, then delivers the interrupts it deferred.
+	void SyncMixerThread();
+
+	/// Returns true if the next time update has to run on the CPU thread, because a DMA (or its interrupt
+	/// countdown) is running, or a DMA interrupt is waiting to be delivered. Mixing during an input DMA
+	/// updates the IOP's MADR and reads IOP memory, so it can't happen behind the IOP's back.
+	bool MixerThreadNeedsSync();
+
+	/// Queues mixing of the given number of ticks.
+	void QueueMixerTicks(u32 ticks);
+
+	/// Queues a register write, replayed through SPU2_FastWrite().
+	void QueueMixerWrite(u32 rmem, u16 value);
+
+	/// Delivers core interrupts raised by the mixer thread. DMA interrupts need the state and wait for a sync.
+	void DeliverMixerIrqs();
+
+	/// Raises the core/DMA interrupts from mixing code. On the mixer thread they're deferred to the CPU thread.
+	void RaiseIrq();
+	void RaiseDMAIrq(u32 core);
+} // namespace SPU2
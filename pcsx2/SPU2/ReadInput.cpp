@@ -6,6 +6,7 @@
 #include "IopHw.h"
 #include "SPU2/Debug.h"
 #include "SPU2/defs.h"
+#include "SPU2/MixerThread.h"
 #include "SPU2/spu2.h"
 
 // Core 0 Input is "SPDIF mode" - Source audio is AC3 compressed.
@@ -45,10 +46,7 @@ StereoOut32 V_Core::ReadInput_HiFi()
 		// Tom & Jerry War of the Whiskers is one such game, the music will skip
 		if (!InputDataTransferred && !InputDataLeft)
 		{
-			if (Index == 0)
-				spu2DMA4Irq();
-			else
-				spu2DMA7Irq();
+			SPU2::RaiseDMAIrq(Index);
 		}
 	}
 
@@ -117,10 +115,7 @@ StereoOut32 V_Core::ReadInput()
 		// Tom & Jerry War of the Whiskers is one such game, the music will skip
 		if (!InputDataTransferred && !InputDataLeft)
 		{
-			if (Index == 0)
-				spu2DMA4Irq();
-			else
-				spu2DMA7Irq();
+			SPU2::RaiseDMAIrq(Index);
 		}
 	}
 
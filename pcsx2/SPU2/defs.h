@@ -606,6 +606,11 @@ extern void StopVoices(int core, u32 value);
 extern void CalculateADSR(V_Voice& vc);
 extern void UpdateSpdifMode();
 
+// Mixes one core's voices for the current sample, with the batched mixer or voice by voice. Returns false
+// without mixing anything if the batched mixer can't be used for the voices' current state. The mixer
+// picks the path by itself, this is so tests can check both give the same results.
+extern bool spu2MixCoreVoices(VoiceMixSet& dest, uint coreidx, bool batched);
+
 namespace SPU2Savestate
 {
 	struct DataBlock;
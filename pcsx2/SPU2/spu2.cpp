@@ -5,6 +5,7 @@
 #include "SPU2/defs.h"
 #include "SPU2/Debug.h"
 #include "SPU2/Dma.h"
+#include "SPU2/MixerThread.h"
 #include "Host/AudioStream.h"
 #include "Host.h"
 #include "GS/GSCapture.h"
@@ -62,6 +63,8 @@ void SPU2writeDMA4Mem(u16* pMem, u32 size) // size now in 16bit units
 
 void SPU2interruptDMA4()
 {
+	SPU2::SyncMixerThread();
+
 	SPU2::FileLog("[%10d] SPU2 interruptDMA4\n", Cycles);
 	if (Cores[0].DmaMode)
 		Cores[0].Regs.STATX |= 0x80;
@@ -71,6 +74,8 @@ void SPU2interruptDMA4()
 
 void SPU2interruptDMA7()
 {
+	SPU2::SyncMixerThread();
+
 	SPU2::FileLog("[%10d] SPU2 interruptDMA7\n", Cycles);
 	if (Cores[1].DmaMode)
 		Cores[1].Regs.STATX |= 0x80;
@@ -97,6 +102,9 @@ void SPU2writeDMA7Mem(u16* pMem, u32 size)
 
 void SPU2::CreateOutputStream()
 {
+	// The mixer thread writes to the stream.
+	SyncMixerThread();
+
 	// Persist volume through stream recreates.
 	const u32 volume = s_output_stream ? s_output_stream->GetOutputVolume() : GetResetVolume();
 	const u32 sample_rate = GetConsoleSampleRate();
@@ -175,6 +183,8 @@ bool SPU2::IsAudioCaptureActive()
 
 void SPU2::InternalReset(bool psxmode)
 {
+	SyncMixerThread();
+
 	s_current_chunk_pos = 0;
 	s_psxmode = psxmode;
 	if (!s_psxmode)
@@ -195,6 +205,7 @@ void SPU2::Reset(bool psxmode)
 {
 	InternalReset(psxmode);
 	UpdateSampleRate();
+	UpdateMixerThread();
 }
 
 void SPU2::OnTargetSpeedChanged()
@@ -204,6 +215,7 @@ void SPU2::OnTargetSpeedChanged()
 
 	if (!s_output_stream->IsStretchEnabled())
 	{
+		SyncMixerThread();
 		s_output_stream->EmptyBuffer();
 		s_current_chunk_pos = 0;
 	}
@@ -236,11 +248,15 @@ bool SPU2::Open()
 	WaveDump::Open();
 #endif
 
+	UpdateMixerThread();
+
 	return true;
 }
 
 void SPU2::Close()
 {
+	ShutdownMixerThread();
+
 	FileLog("[%10d] SPU2 Close\n", Cycles);
 
 	s_output_stream.reset();
@@ -272,6 +288,9 @@ void SPU2::CheckForConfigChanges(const Pcsx2Config& old_config)
 		SetOutputVolume(GetResetVolume());
 	}
 
+	if (opts.AsyncMixing != oldopts.AsyncMixing)
+		UpdateMixerThread();
+
 	// Things which require re-initialzing the output.
 	if (opts.Backend != oldopts.Backend ||
 		opts.StreamParameters != oldopts.StreamParameters ||
@@ -299,7 +318,7 @@ void SPU2::CheckForConfigChanges(const Pcsx2Config& old_config)
 
 void SPU2async()
 {
-	TimeUpdate(psxRegs.cycle);
+	TimeUpdateAsync(psxRegs.cycle);
 }
 
 u16 SPU2read(u32 rmem)
@@ -309,6 +328,9 @@ u16 SPU2read(u32 rmem)
 	const u32 mem = rmem & 0xFFFF;
 	u32 omem = mem;
 
+	// Reads see the state the mixer thread leaves behind (ENDX, ENVX, IRQ and ADMA status).
+	SPU2::SyncMixerThread();
+
 	if (mem & 0x400)
 	{
 		omem ^= 0x400;
@@ -360,6 +382,17 @@ void SPU2write(u32 rmem, u16 value)
 	// If the SPU2 isn't in in sync with the IOP, samples can end up playing at rather
 	// incorrect pitches and loop lengths.
 
+	// With the mixer thread, writes are replayed in order between the queued ticks, so the timing holds.
+	if (SPU2::IsMixerThreadActive() && rmem >> 16 != 0x1f80)
+	{
+		TimeUpdateAsync(psxRegs.cycle);
+#ifdef PCSX2_DEVBUILD
+		SPU2::WriteRegLog("write", rmem, value);
+#endif
+		SPU2::QueueMixerWrite(rmem, value);
+		return;
+	}
+
 	TimeUpdate(psxRegs.cycle);
 
 	if (rmem >> 16 == 0x1f80)
@@ -390,6 +423,8 @@ s32 SPU2freeze(FreezeAction mode, freezeData* data)
 
 	pxAssume(mode == FreezeAction::Load || mode == FreezeAction::Save);
 
+	SPU2::SyncMixerThread();
+
 	if (data->data == nullptr)
 	{
 		printf("SPU2 savestate null pointer!\n");
@@ -72,6 +72,8 @@ void SPU2writeDMA7Mem(u16* pMem, u32 size);
 extern u32 lClocks;
 
 extern void TimeUpdate(u32 cClocks);
+extern void TimeUpdateAsync(u32 cClocks);
+extern void MixTicks(u32 ticks);
 extern void SPU2_FastWrite(u32 rmem, u16 value);
 
 //#define PCM24_S1_INTERLEAVE
@@ -14,6 +14,7 @@
 #include "SPU2/Debug.h"
 #include "SPU2/defs.h"
 #include "SPU2/Dma.h"
+#include "SPU2/MixerThread.h"
 #include "SPU2/regs.h"
 #include "SPU2/spu2.h"
 
@@ -254,16 +255,17 @@ __forceinline static bool StartQueuedVoice(uint coreidx, uint voiceidx)
 	return true;
 }
 
-__forceinline void TimeUpdate(u32 cClocks)
+// Works out how many clocks have passed since the last update. Returns false if the clock went backwards.
+static __forceinline bool GetElapsedClocks(u32 cClocks, u32& dClocks)
 {
-	u32 dClocks = cClocks - lClocks;
+	dClocks = cClocks - lClocks;
 
 	// Sanity Checks:
 	//  It's not totally uncommon for the IOP's clock to jump backwards a cycle or two, and in
 	//  such cases we just want to ignore the TimeUpdate call.
 
 	if (dClocks > (u32)-15)
-		return;
+		return false;
 
 	//  But if for some reason our clock value seems way off base (typically due to bad dma
 	//  timings from PCSX2), just mix out a little bit, skip the rest, and hope the ship
@@ -277,8 +279,12 @@ __forceinline void TimeUpdate(u32 cClocks)
 		lClocks = cClocks - dClocks;
 	}
 
-	//Update Mixing Progress
-	while (dClocks >= TickInterval)
+	return true;
+}
+
+void MixTicks(u32 ticks)
+{
+	for (; ticks > 0; ticks--)
 	{
 		for (int i = 0; i < 2; i++)
 		{
@@ -289,13 +295,11 @@ __forceinline void TimeUpdate(u32 cClocks)
 				if (!(Spdif.Info & (4 << i)) && Cores[i].IRQEnable)
 				{
 					Spdif.Info |= (4 << i);
-					spu2Irq();
+					SPU2::RaiseIrq();
 				}
 			}
 		}
 
-		dClocks -= TickInterval;
-		lClocks += TickInterval;
 		Cycles++;
 
 		// Start Queued Voices, they start after 2T (Tested on real HW)
@@ -307,6 +311,21 @@ __forceinline void TimeUpdate(u32 cClocks)
 
 		spu2Mix();
 	}
+}
+
+__forceinline void TimeUpdate(u32 cClocks)
+{
+	// Callers go on to look at the state, so anything queued for the mixer thread has to be done first.
+	SPU2::SyncMixerThread();
+
+	u32 dClocks;
+	if (!GetElapsedClocks(cClocks, dClocks))
+		return;
+
+	//Update Mixing Progress
+	const u32 ticks = dClocks / TickInterval;
+	lClocks += ticks * TickInterval;
+	MixTicks(ticks);
 
 	//Update DMA4 interrupt delay counter
 	if (Cores[0].DMAICounter > 0 && (psxRegs.cycle - Cores[0].LastClock) > 0)
@@ -416,6 +435,29 @@ __forceinline void TimeUpdate(u32 cClocks)
 	}
 }
 
+void TimeUpdateAsync(u32 cClocks)
+{
+	// DMAs and their interrupt countdowns poke at the IOP, so they're always run here.
+	if (!SPU2::IsMixerThreadActive() || SPU2::MixerThreadNeedsSync())
+	{
+		TimeUpdate(cClocks);
+		return;
+	}
+
+	u32 dClocks;
+	if (!GetElapsedClocks(cClocks, dClocks))
+		return;
+
+	const u32 ticks = dClocks / TickInterval;
+	if (ticks > 0)
+	{
+		lClocks += ticks * TickInterval;
+		SPU2::QueueMixerTicks(ticks);
+	}
+
+	SPU2::DeliverMixerIrqs();
+}
+
 __forceinline void UpdateSpdifMode()
 {
 	const int OPM = PlayMode;
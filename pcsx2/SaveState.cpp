@@ -378,6 +378,33 @@ static bool SysState_ComponentFreezeIn(zip_file_t* zf, SysState_Component comp)
 	return true;
 }
 
+static bool SysState_ComponentFreezeInMemory(std::span<const u8> data, SysState_Component comp)
+{
+	freezeData fP = { 0, nullptr };
+	if (comp.freeze(FreezeAction::Size, &fP) != 0)
+		fP.size = 0;
+
+	// Components only read from the buffer when loading.
+	if (fP.size > 0)
+	{
+		if (data.size() < static_cast<size_t>(fP.size))
+		{
+			Console.Error(fmt::format("* {}: Save data is incomplete", comp.name));
+			return false;
+		}
+
+		fP.data = const_cast<u8*>(data.data());
+	}
+
+	if (comp.freeze(FreezeAction::Load, &fP) != 0)
+	{
+		Console.Error(fmt::format("* {}: Failed to load freeze data", comp.name));
+		return false;
+	}
+
+	return true;
+}
+
 static bool SysState_ComponentFreezeOut(SaveStateBase& writer, SysState_Component comp)
 {
 	freezeData fP = {};
@@ -423,6 +450,14 @@ static bool SysState_ComponentFreezeInNew(zip_file_t* zf, const char* name, bool
 	return do_state_func(sw);
 }
 
+static bool SysState_ComponentFreezeInMemoryNew(std::span<const u8> data, bool(*do_state_func)(StateWrapper&))
+{
+	StateWrapper::ReadOnlyMemoryStream stream(data.empty() ? nullptr : data.data(), data.size());
+	StateWrapper sw(&stream, StateWrapper::Mode::Read, g_SaveVersion);
+
+	return do_state_func(sw);
+}
+
 static bool SysState_ComponentFreezeOutNew(SaveStateBase& writer, const char* name, u32 reserve, bool (*do_state_func)(StateWrapper&))
 {
 	StateWrapper::VectorMemoryStream stream(reserve);
@@ -455,8 +490,16 @@ public:
 
 	virtual const char* GetFilename() const = 0;
 	virtual bool FreezeIn(zip_file_t* zf) const = 0;
+	virtual bool FreezeInMemory(std::span<const u8> data) const = 0;
 	virtual bool FreezeOut(SaveStateBase& writer) const = 0;
 	virtual bool IsRequired() const = 0;
+
+	// Writes over `previous`, which is already in the writer's buffer at the current position and
+	// was captured at dirty page snapshot `since`. Only memory entries can skip unchanged data.
+	virtual bool FreezeOutIncremental(SaveStateBase& writer, const ArchiveEntry& previous, u32 since) const
+	{
+		return FreezeOut(writer);
+	}
 };
 
 class MemorySavestateEntry : public BaseSavestateEntry
@@ -467,7 +510,9 @@ protected:
 
 public:
 	virtual bool FreezeIn(zip_file_t* zf) const;
+	virtual bool FreezeInMemory(std::span<const u8> data) const;
 	virtual bool FreezeOut(SaveStateBase& writer) const;
+	virtual bool FreezeOutIncremental(SaveStateBase& writer, const ArchiveEntry& previous, u32 since) const;
 	virtual bool IsRequired() const { return true; }
 
 protected:
@@ -488,12 +533,44 @@ bool MemorySavestateEntry::FreezeIn(zip_file_t* zf) const
 	return true;
 }
 
+bool MemorySavestateEntry::FreezeInMemory(std::span<const u8> data) const
+{
+	const u32 expectedSize = GetDataSize();
+	const u32 size = std::min(expectedSize, static_cast<u32>(data.size()));
+	if (size != expectedSize)
+	{
+		Console.WriteLn(Color_Yellow, " '%s' is incomplete (expected 0x%x bytes, loading only 0x%x bytes)",
+			GetFilename(), expectedSize, size);
+	}
+
+	std::memcpy(GetDataPtr(), data.data(), size);
+	return true;
+}
+
 bool MemorySavestateEntry::FreezeOut(SaveStateBase& writer) const
 {
 	writer.FreezeMem(GetDataPtr(), GetDataSize());
 	return writer.IsOkay();
 }
 
+bool MemorySavestateEntry::FreezeOutIncremental(SaveStateBase& writer, const ArchiveEntry& previous, u32 since) const
+{
+	const u32 size = GetDataSize();
+	if (previous.GetDataIndex() != writer.GetCurrentPos() || previous.GetDataSize() != size)
+		return FreezeOut(writer);
+
+	writer.PrepBlock(size);
+	if (writer.HasError())
+		return false;
+
+	// Falls back to a full copy for memory which isn't dirty tracked.
+	if (!mmap_CopyChangedPages(writer.GetBlockPtr(), GetDataPtr(), size, since))
+		std::memcpy(writer.GetBlockPtr(), GetDataPtr(), size);
+
+	writer.CommitBlock(size);
+	return true;
+}
+
 // --------------------------------------------------------------------------------------
 //  SavestateEntry_* (EmotionMemory, IopMemory, etc)
 // --------------------------------------------------------------------------------------
@@ -605,6 +682,7 @@ public:
 
 	const char* GetFilename() const override { return "SPU2.bin"; }
 	bool FreezeIn(zip_file_t* zf) const override { return SysState_ComponentFreezeIn(zf, SPU2_); }
+	bool FreezeInMemory(std::span<const u8> data) const override { return SysState_ComponentFreezeInMemory(data, SPU2_); }
 	bool FreezeOut(SaveStateBase& writer) const override { return SysState_ComponentFreezeOut(writer, SPU2_); }
 	bool IsRequired() const override { return true; }
 };
@@ -616,6 +694,7 @@ public:
 
 	const char* GetFilename() const override { return "USB.bin"; }
 	bool FreezeIn(zip_file_t* zf) const override { return SysState_ComponentFreezeInNew(zf, "USB", &USB::DoState); }
+	bool FreezeInMemory(std::span<const u8> data) const override { return SysState_ComponentFreezeInMemoryNew(data, &USB::DoState); }
 	bool FreezeOut(SaveStateBase& writer) const override { return SysState_ComponentFreezeOutNew(writer, "USB", 16 * 1024, &USB::DoState); }
 	bool IsRequired() const override { return false; }
 };
@@ -627,6 +706,7 @@ public:
 
 	const char* GetFilename() const override { return "PAD.bin"; }
 	bool FreezeIn(zip_file_t* zf) const override { return SysState_ComponentFreezeInNew(zf, "PAD", &Pad::Freeze); }
+	bool FreezeInMemory(std::span<const u8> data) const override { return SysState_ComponentFreezeInMemoryNew(data, &Pad::Freeze); }
 	bool FreezeOut(SaveStateBase& writer) const override { return SysState_ComponentFreezeOutNew(writer, "PAD", 16 * 1024, &Pad::Freeze); }
 	bool IsRequired() const override { return true; }
 };
@@ -638,6 +718,7 @@ public:
 
 	const char* GetFilename() const { return "GS.bin"; }
 	bool FreezeIn(zip_file_t* zf) const { return SysState_ComponentFreezeIn(zf, GS); }
+	bool FreezeInMemory(std::span<const u8> data) const { return SysState_ComponentFreezeInMemory(data, GS); }
 	bool FreezeOut(SaveStateBase& writer) const { return SysState_ComponentFreezeOut(writer, GS); }
 	bool IsRequired() const { return true; }
 };
@@ -664,6 +745,14 @@ class SaveStateEntry_Achievements final : public BaseSavestateEntry
 		return true;
 	}
 
+	bool FreezeInMemory(std::span<const u8> data) const override
+	{
+		if (Achievements::IsActive())
+			Achievements::LoadState(data);
+
+		return true;
+	}
+
 	bool FreezeOut(SaveStateBase& writer) const override
 	{
 		if (!Achievements::IsActive())
@@ -701,7 +790,27 @@ static const std::unique_ptr<BaseSavestateEntry> SavestateEntries[] = {
 std::unique_ptr<ArchiveEntryList> SaveState_DownloadState(Error* error)
 {
 	std::unique_ptr<ArchiveEntryList> destlist = std::make_unique<ArchiveEntryList>();
-	destlist->GetBuffer().resize(1024 * 1024 * 64);
+	if (!SaveState_DownloadState(destlist.get(), error))
+		destlist.reset();
+
+	return destlist;
+}
+
+bool SaveState_DownloadState(ArchiveEntryList* destlist, Error* error)
+{
+	// Buffers are reused by callers that capture repeatedly, so only grow it here.
+	if (destlist->GetBuffer().size() < 1024 * 1024 * 64)
+		destlist->GetBuffer().resize(1024 * 1024 * 64);
+
+	// If the buffer already holds an older capture, main memory pages which haven't been
+	// written since don't need to be copied again.
+	const u32 since = destlist->GetDirtyGeneration();
+	const u32 generation = mmap_IsDirtyTrackingEnabled() ? mmap_BeginDirtySnapshot() : 0;
+	std::vector<ArchiveEntry> previous_entries;
+	if (since != 0 && destlist->GetLength() == (std::size(SavestateEntries) + 1))
+		previous_entries = destlist->GetEntries();
+	destlist->SetEntries({});
+	destlist->SetDirtyGeneration(0);
 
 	memSavingState saveme(destlist->GetBuffer());
 	ArchiveEntry internals(EntryFilename_InternalStructures);
@@ -710,7 +819,7 @@ std::unique_ptr<ArchiveEntryList> SaveState_DownloadState(Error* error)
 	if (!saveme.FreezeBios())
 	{
 		Error::SetString(error, "FreezeBios() failed");
-		return nullptr;
+		return false;
 	}
 
 	if (!saveme.FreezeInternals(error))
@@ -718,20 +827,22 @@ std::unique_ptr<ArchiveEntryList> SaveState_DownloadState(Error* error)
 		if (!error->IsValid())
 			Error::SetString(error, "FreezeInternals() failed");
 
-		return nullptr;
+		return false;
 	}
 
 	internals.SetDataSize(saveme.GetCurrentPos() - internals.GetDataIndex());
 	destlist->Add(internals);
 
-	for (const std::unique_ptr<BaseSavestateEntry>& entry : SavestateEntries)
+	for (u32 i = 0; i < std::size(SavestateEntries); i++)
 	{
+		const std::unique_ptr<BaseSavestateEntry>& entry = SavestateEntries[i];
 		uint startpos = saveme.GetCurrentPos();
-		if (!entry->FreezeOut(saveme))
+		const bool frozen = previous_entries.empty() ? entry->FreezeOut(saveme) :
+													   entry->FreezeOutIncremental(saveme, previous_entries[i + 1], since);
+		if (!frozen)
 		{
 			Error::SetString(error, fmt::format("FreezeOut() failed for {}.", entry->GetFilename()));
-			destlist.reset();
-			break;
+			return false;
 		}
 
 		destlist->Add(
@@ -740,7 +851,8 @@ std::unique_ptr<ArchiveEntryList> SaveState_DownloadState(Error* error)
 				.SetDataSize(saveme.GetCurrentPos() - startpos));
 	}
 
-	return destlist;
+	destlist->SetDirtyGeneration(generation);
+	return true;
 }
 
 std::unique_ptr<SaveStateScreenshotData> SaveState_SaveScreenshot()
@@ -1170,3 +1282,54 @@ bool SaveState_UnzipFromDisk(const std::string& filename, Error* error)
 	PostLoadPrep();
 	return true;
 }
+
+bool SaveState_LoadFromMemory(const ArchiveEntryList& srclist, Error* error)
+{
+	// Entries are in the same order SaveState_DownloadState() wrote them in.
+	if (srclist.GetLength() != (std::size(SavestateEntries) + 1) ||
+		srclist[0].GetFilename() != EntryFilename_InternalStructures)
+	{
+		Error::SetString(error, "Memory state is incomplete.");
+		return false;
+	}
+
+	for (u32 i = 0; i < std::size(SavestateEntries); i++)
+	{
+		if (srclist[i + 1].GetFilename() != SavestateEntries[i]->GetFilename())
+		{
+			Error::SetString(error, fmt::format("Memory state is missing {}.", SavestateEntries[i]->GetFilename()));
+			return false;
+		}
+	}
+
+	PreLoadPrep();
+
+	{
+		const ArchiveEntry& internals = srclist[0];
+		const SaveStateBase::VmStateBuffer internals_buffer(srclist.GetPtr(internals.GetDataIndex()),
+			srclist.GetPtr(internals.GetDataIndex()) + internals.GetDataSize());
+		memLoadingState state(internals_buffer);
+		if (!state.FreezeBios() || !state.FreezeInternals(error))
+		{
+			if (!error->IsValid())
+				Error::SetString(error, "Save state corruption in internal structures.");
+
+			VMManager::Reset();
+			return false;
+		}
+	}
+
+	for (u32 i = 0; i < std::size(SavestateEntries); ++i)
+	{
+		const ArchiveEntry& entry = srclist[i + 1];
+		if (!SavestateEntries[i]->FreezeInMemory(std::span<const u8>(srclist.GetPtr(entry.GetDataIndex()), entry.GetDataSize())))
+		{
+			Error::SetString(error, fmt::format("Save state corruption in {}.", SavestateEntries[i]->GetFilename()));
+			VMManager::Reset();
+			return false;
+		}
+	}
+
+	PostLoadPrep();
+	return true;
+}
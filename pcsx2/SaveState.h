@@ -5,6 +5,7 @@
 
 #include <deque>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -52,6 +53,8 @@ class ArchiveEntryList;
 // Wrappers to generate a save state compatible across all frontends.
 // These functions assume that the caller has paused the core thread.
 extern std::unique_ptr<ArchiveEntryList> SaveState_DownloadState(Error* error);
+extern bool SaveState_DownloadState(ArchiveEntryList* destlist, Error* error);
+extern bool SaveState_LoadFromMemory(const ArchiveEntryList& srclist, Error* error);
 extern std::unique_ptr<SaveStateScreenshotData> SaveState_SaveScreenshot();
 extern bool SaveState_ZipToDisk(std::unique_ptr<ArchiveEntryList> srclist, std::unique_ptr<SaveStateScreenshotData> screenshot, const char* filename);
 extern bool SaveState_ReadScreenshot(const std::string& filename, u32* out_width, u32* out_height, std::vector<u32>* out_pixels);
@@ -280,6 +283,7 @@ public:
 protected:
 	std::vector<ArchiveEntry> m_list;
 	VmStateBuffer m_data;
+	u32 m_dirty_generation = 0;
 
 public:
 	ArchiveEntryList() = default;
@@ -311,6 +315,33 @@ public:
 		return *this;
 	}
 
+	const std::vector<ArchiveEntry>& GetEntries() const
+	{
+		return m_list;
+	}
+
+	void SetEntries(std::vector<ArchiveEntry> entries)
+	{
+		m_list = std::move(entries);
+	}
+
+	// Dirty page snapshot the buffer holds main memory for, zero if unknown. See mmap_BeginDirtySnapshot().
+	u32 GetDirtyGeneration() const
+	{
+		return m_dirty_generation;
+	}
+
+	void SetDirtyGeneration(u32 generation)
+	{
+		m_dirty_generation = generation;
+	}
+
+	// Number of bytes of the buffer in use by the entries.
+	size_t GetDataLength() const
+	{
+		return m_list.empty() ? 0 : (m_list.back().GetDataIndex() + m_list.back().GetDataSize());
+	}
+
 	size_t GetLength() const
 	{
 		return m_list.size();
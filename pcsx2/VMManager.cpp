@@ -31,6 +31,7 @@
 #include "R5900.h"
 #include "Recording/InputRecording.h"
 #include "Recording/InputRecordingControls.h"
+#include "Rewind.h"
 #include "SIO/Memcard/MemoryCardFile.h"
 #include "SIO/Pad/Pad.h"
 #include "SIO/Sio.h"
@@ -40,13 +41,19 @@
 #include "USB/USB.h"
 #include "Vif_Dynarec.h"
 #include "VMManager.h"
+#include "vtlb.h"
 #include "ps2/BiosTools.h"
 #include "svnrev.h"
 
+#ifdef _M_X86
+#include "x86/BaseblockEx.h"
+#endif
+
 #include "common/Console.h"
 #include "common/Error.h"
 #include "common/FileSystem.h"
 #include "common/FPControl.h"
+#include "common/Perf.h"
 #include "common/ScopedGuard.h"
 #include "common/SettingsWrapper.h"
 #include "common/SmallString.h"
@@ -1571,6 +1578,8 @@ bool VMManager::Initialize(VMBootParameters boot_params)
 		}
 	}
 
+	Perf::SetJitDumpEnabled(EmuConfig.Profiler.PerfJitDump);
+	Rewind::Initialize();
 	PerformanceMetrics::Clear();
 	return true;
 }
@@ -1599,9 +1608,17 @@ void VMManager::Shutdown(bool save_resume_state)
 	if (g_InputRecording.isActive())
 		g_InputRecording.stop();
 
+	Rewind::Shutdown();
+
 	SaveSessionTime(s_disc_serial);
 	s_elf_override = {};
 	ClearELFInfo();
+
+#ifdef _M_X86
+	// Write out the block profiles for the game which was running.
+	g_eeBlockProfile.SetGame(0);
+	g_iopBlockProfile.SetGame(0);
+#endif
 	CDVDsys_ClearFiles();
 
 	{
@@ -1703,6 +1720,7 @@ void VMManager::Reset()
 	SysMemory::Reset();
 	cpuReset();
 	hwReset();
+	Rewind::Clear();
 
 	if (g_InputRecording.isActive())
 	{
@@ -1807,6 +1825,9 @@ bool VMManager::DoLoadState(const char* filename)
 		return false;
 	}
 
+	// Older captures belong to a different timeline now.
+	Rewind::Clear();
+
 	Host::OnSaveStateLoaded(filename, true);
 	if (g_InputRecording.isActive())
 	{
@@ -2626,6 +2647,8 @@ void VMManager::Execute()
 		vtlb_ResetFastmem();
 	}
 
+	Rewind::ApplyPendingRestore();
+
 	// Execute until we're asked to stop.
 	Cpu->Execute();
 }
@@ -2786,6 +2809,12 @@ void VMManager::Internal::VSyncOnCPUThread()
 
 	Achievements::FrameUpdate();
 
+	// States can't be loaded in the middle of a frame, so rewinding stops execution and restores in Execute().
+	if (Rewind::FrameUpdate())
+		Cpu->ExitExecution();
+
+	mmap_PublishSMCPageStats();
+
 	PollDiscordPresence();
 }
 
@@ -2822,6 +2851,9 @@ void VMManager::CheckForCPUConfigChanges(const Pcsx2Config& old_config)
 
 	Console.WriteLn("Updating CPU configuration...");
 	FPControlRegister::SetCurrent(EmuConfig.Cpu.FPUFPCR);
+
+	// Blocks compiled before the jitdump was enabled aren't in it, the flush below recompiles them.
+	Perf::SetJitDumpEnabled(EmuConfig.Profiler.PerfJitDump);
 	Internal::ClearCPUExecutionCaches();
 	memBindConditionalHandlers();
 
@@ -2972,6 +3004,13 @@ void VMManager::CheckForMiscConfigChanges(const Pcsx2Config& old_config)
 	{
 		SetEmuThreadAffinities();
 	}
+
+	if (HasValidVM() && (EmuConfig.EnableRewind != old_config.EnableRewind ||
+							EmuConfig.RewindBufferSize != old_config.RewindBufferSize))
+	{
+		Rewind::Shutdown();
+		Rewind::Initialize();
+	}
 }
 
 void VMManager::CheckForConfigChanges(const Pcsx2Config& old_config)
@@ -17,6 +17,13 @@ extern void VifUnpackSSE_Init();
 
 _vifT extern void dVifUnpack(const u8* data, bool isFill);
 
+// The unpack reserve is filled one segment at a time, wrapping around at the end. Moving on to a
+// segment evicts the routines compiled into it last time, rather than throwing away the whole cache.
+static constexpr u32 VIF_REC_SEGMENTS = 8;
+
+// Space kept past the end of a segment for the last routine started in it.
+static constexpr u32 VIF_REC_MARGIN = _256kb;
+
 struct nVifStruct
 {
 	// Buffer for partial transfers (should always be first to ensure alignment)
@@ -30,6 +37,9 @@ struct nVifStruct
 
 	u8*                     recWritePtr; // current write pos into the reserve
 	u8*                     recEndPtr;
+	u8*                     recStartPtr;
+	u8*                     recSegmentEnd; // end of the segment being filled
+	u32                     recSegment;
 
 	HashBucket              vifBlocks;   // Vif Blocks
 
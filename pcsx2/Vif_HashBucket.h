@@ -3,7 +3,9 @@
 
 #pragma once
 
-#include <array>
+#include <atomic>
+#include <cstring>
+#include <vector>
 #include "fmt/core.h"
 #include "common/AlignedMalloc.h"
 
@@ -36,101 +38,167 @@ union nVifBlock
 
 }; // 16 bytes
 
-// 0x4000 is enough but 0x10000 allow
-// * to skip the compare value of the first double world in lookup
-// * to use a 16 bits move instead of an 'and' mask to compute the hashed key
-#define hSize 0x10000 // [usn*1:mask*1:upk*4:num*8] hash...
-
-// HashBucket is a container which uses a built-in hash function
-// to perform quick searches. It is designed around the nVifBlock structure
+// HashBucket is an open-addressing table of compiled unpack variants, keyed on
+// the hash_key/key0/key1 fields of nVifBlock and probed linearly.
 //
-// The hash function is determined by taking the first bytes of data and
-// performing a modulus the size of hSize. So the most diverse-data should
-// be in the first bytes of the struct. (hence why nVifBlock is specifically sorted)
+// Each entry remembers the generation it was last used in. The code reserve is
+// filled one segment at a time, and moving to a new segment starts a new
+// generation and evicts the entries whose code lived in that segment. Entries
+// used during the previous generation are handed back to be compiled again, so
+// only cold variants drop out.
 class HashBucket
 {
+public:
+	struct Entry
+	{
+		nVifBlock block;
+		u32 last_used; // generation the variant was last run in
+		u32 code_size;
+		bool is_fill;
+	};
+
+	// Running totals, only written by the thread doing the unpacks.
+	struct Stats
+	{
+		u32 hits;
+		u32 misses;
+		u32 evictions;
+	};
+
+	static constexpr u32 TABLE_SIZE = 0x8000; // must be a power of two
+	static constexpr u32 MAX_ENTRIES = TABLE_SIZE * 3 / 4;
+
 protected:
-	std::array<nVifBlock*, hSize> m_bucket;
+	Entry* m_table = nullptr;
+	u32 m_count = 0;
+	u32 m_generation = 0;
 
-public:
-	HashBucket()
+	std::atomic<u32> m_hits{0};
+	std::atomic<u32> m_misses{0};
+	std::atomic<u32> m_evictions{0};
+
+	static __fi u32 hash(const nVifBlock& block)
 	{
-		m_bucket.fill(nullptr);
+		u32 h = block.hash_key * 0x9E3779B1u;
+		h ^= block.key0 * 0x85EBCA77u;
+		h ^= block.key1 * 0xC2B2AE3Du;
+		return (h ^ (h >> 15)) & (TABLE_SIZE - 1);
 	}
 
+	// There's only ever one writer, so the counters don't need locked increments.
+	static __fi void increment(std::atomic<u32>& counter, u32 amount = 1)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	void insert(const Entry& entry)
+	{
+		u32 pos = hash(entry.block);
+		while (m_table[pos].block.startPtr != 0)
+			pos = (pos + 1) & (TABLE_SIZE - 1);
+
+		m_table[pos] = entry;
+		m_count++;
+	}
+
+public:
+	HashBucket() = default;
 	~HashBucket() { clear(); }
 
 	__fi nVifBlock* find(const nVifBlock& dataPtr)
 	{
-		nVifBlock* chainpos = m_bucket[dataPtr.hash_key];
+		u32 pos = hash(dataPtr);
 
 		while (true)
 		{
-			if (chainpos->key0 == dataPtr.key0 && chainpos->key1 == dataPtr.key1)
-				return chainpos;
-
-			if (chainpos->startPtr == 0)
+			Entry& entry = m_table[pos];
+			if (entry.block.startPtr == 0)
+			{
+				increment(m_misses);
 				return nullptr;
+			}
 
-			chainpos++;
+			if (entry.block.key0 == dataPtr.key0 && entry.block.key1 == dataPtr.key1 &&
+				entry.block.hash_key == dataPtr.hash_key)
+			{
+				entry.last_used = m_generation;
+				increment(m_hits);
+				return &entry.block;
+			}
+
+			pos = (pos + 1) & (TABLE_SIZE - 1);
 		}
 	}
 
-	void add(const nVifBlock& dataPtr)
+	bool full() const { return (m_count >= MAX_ENTRIES); }
+
+	void add(const nVifBlock& dataPtr, u32 code_size, bool is_fill)
 	{
-		u32 b = dataPtr.hash_key;
+		pxAssert(!full());
+		insert(Entry{dataPtr, m_generation, code_size, is_fill});
+	}
 
-		u32 size = bucket_size(dataPtr);
+	// Starts a new generation, removing every entry whose code overlaps [start, end).
+	// Entries which were used during the previous generation are returned in hot.
+	void evict(uptr start, uptr end, std::vector<Entry>& hot)
+	{
+		std::vector<Entry> kept;
+		kept.reserve(m_count);
+		hot.clear();
 
-		// Warning there is an extra +1 due to the empty cell
-		// Performance note: 64B align to reduce cache miss penalty in `find`
-		if ((m_bucket[b] = (nVifBlock*)pcsx2_aligned_realloc(m_bucket[b], sizeof(nVifBlock) * (size + 2), 64, sizeof(nVifBlock) * (size + 1))) == NULL)
+		for (u32 i = 0; i < TABLE_SIZE; i++)
 		{
-			pxFailRel("Failed to allocate HashBucket Chain");
+			const Entry& entry = m_table[i];
+			if (entry.block.startPtr == 0)
+				continue;
+
+			if (entry.block.startPtr < end && (entry.block.startPtr + entry.code_size) > start)
+			{
+				if ((entry.last_used + 1) >= m_generation)
+					hot.push_back(entry);
+			}
+			else
+			{
+				kept.push_back(entry);
+			}
 		}
 
-		// Replace the empty cell by the new block and create a new empty cell
-		memcpy(&m_bucket[b][size++], &dataPtr, sizeof(nVifBlock));
-		memset(&m_bucket[b][size], 0, sizeof(nVifBlock));
+		increment(m_evictions, m_count - static_cast<u32>(kept.size()));
 
-		if (size > 3)
-			DevCon.Warning("recVifUnpk: Bucket 0x%04x has %d micro-programs", b, size);
+		// Rebuilding is simpler than deleting from the probe chains, and this is rare enough not to matter.
+		std::memset(m_table, 0, sizeof(Entry) * TABLE_SIZE);
+		m_count = 0;
+		for (const Entry& entry : kept)
+			insert(entry);
+
+		m_generation++;
 	}
 
-	u32 bucket_size(const nVifBlock& dataPtr)
+	Stats stats() const
 	{
-		nVifBlock* chainpos = m_bucket[dataPtr.hash_key];
-
-		u32 size = 0;
-
-		while (chainpos->startPtr != 0)
-		{
-			size++;
-			chainpos++;
-		}
-
-		return size;
+		return Stats{m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed),
+			m_evictions.load(std::memory_order_relaxed)};
 	}
 
 	void clear()
 	{
-		for (auto& bucket : m_bucket)
-			safe_aligned_free(bucket);
+		safe_aligned_free(m_table);
+		m_count = 0;
 	}
 
 	void reset()
 	{
-		clear();
+		if (m_count > 0)
+			increment(m_evictions, m_count);
 
-		// Allocate an empty cell for all buckets
-		for (auto& bucket : m_bucket)
+		// Performance note: 64B align to reduce cache miss penalty in `find`
+		if (!m_table && (m_table = (Entry*)_aligned_malloc(sizeof(Entry) * TABLE_SIZE, 64)) == nullptr)
 		{
-			if ((bucket = (nVifBlock*)_aligned_malloc(sizeof(nVifBlock), 16)) == nullptr)
-			{
-				pxFailRel("Failed to allocate HashBucket Chain on reset");
-			}
-
-			memset(bucket, 0, sizeof(nVifBlock));
+			pxFailRel("Failed to allocate HashBucket table on reset");
 		}
+
+		std::memset(m_table, 0, sizeof(Entry) * TABLE_SIZE);
+		m_count = 0;
+		m_generation = 0;
 	}
 };
@@ -176,8 +176,11 @@ void dVifReset(int idx)
 
 	const size_t offset = idx ? HostMemoryMap::VIF1recOffset : HostMemoryMap::VIF0recOffset;
 	const size_t size = idx ? HostMemoryMap::VIF1recSize : HostMemoryMap::VIF0recSize;
-	nVif[idx].recWritePtr = SysMemory::GetCodePtr(offset);
-	nVif[idx].recEndPtr = nVif[idx].recWritePtr + (size - _256kb);
+	nVif[idx].recStartPtr = SysMemory::GetCodePtr(offset);
+	nVif[idx].recEndPtr = nVif[idx].recStartPtr + (size - VIF_REC_MARGIN);
+	nVif[idx].recWritePtr = nVif[idx].recStartPtr;
+	nVif[idx].recSegmentEnd = nVif[idx].recStartPtr + (size - VIF_REC_MARGIN) / VIF_REC_SEGMENTS;
+	nVif[idx].recSegment = 0;
 }
 
 void dVifRelease(int idx)
@@ -469,29 +472,66 @@ static u16 dVifComputeLength(uint cl, uint wl, u8 num, bool isFill)
 	return std::min(length, 0xFFFFu);
 }
 
-_vifT __fi nVifBlock* dVifCompile(nVifBlock& block, bool isFill)
+_vifT static void dVifEmit(nVifBlock& block, bool isFill)
 {
 	nVifStruct& v = nVif[idx];
 
-	// Check size before the compilation
-	if (v.recWritePtr >= v.recEndPtr)
-	{
-		DevCon.WriteLn("nVif Recompiler Cache Reset! [0x%016" PRIXPTR " > 0x%016" PRIXPTR "]",
-			v.recWritePtr, v.recEndPtr);
-		dVifReset(idx);
-	}
-
-	// Compile the block now
-	armSetAsmPtr(v.recWritePtr, v.recEndPtr - v.recWritePtr, nullptr);
+	armSetAsmPtr(v.recWritePtr, v.recEndPtr + VIF_REC_MARGIN - v.recWritePtr, nullptr);
 
 	block.startPtr = (uptr)armStartBlock();
 	block.length = dVifComputeLength(block.cl, block.wl, block.num, isFill);
-	v.vifBlocks.add(block);
 
 	VifUnpackNEON_Dynarec(v, block).CompileRoutine();
 
+	v.vifBlocks.add(block, static_cast<u32>(armGetCurrentCodePointer() - (u8*)block.startPtr), isFill);
+
 	Perf::vif.RegisterPC(v.recWritePtr, armGetCurrentCodePointer() - v.recWritePtr, block.upkType /* FIXME ideally a key*/);
 	v.recWritePtr = armEndBlock();
+}
+
+// Moves on to the next segment of the reserve, evicting the routines which were compiled into it.
+// Variants used since the previous switch are compiled again straight away, so only cold ones are lost.
+_vifT static void dVifNextSegment()
+{
+	static std::vector<HashBucket::Entry> hot;
+
+	nVifStruct& v = nVif[idx];
+	const size_t segment_size = (v.recEndPtr - v.recStartPtr) / VIF_REC_SEGMENTS;
+
+	v.recSegment = (v.recSegment + 1) % VIF_REC_SEGMENTS;
+	v.recWritePtr = v.recStartPtr + v.recSegment * segment_size;
+	v.recSegmentEnd = v.recWritePtr + segment_size;
+
+	// The last routine started in a segment can run into the margin past its end.
+	v.vifBlocks.evict((uptr)v.recWritePtr, (uptr)v.recSegmentEnd + VIF_REC_MARGIN, hot);
+	Perf::vif.Unregister(v.recWritePtr, segment_size + VIF_REC_MARGIN);
+
+	for (HashBucket::Entry& entry : hot)
+	{
+		if (v.recWritePtr >= v.recSegmentEnd)
+			break;
+
+		dVifEmit<idx>(entry.block, entry.is_fill);
+	}
+}
+
+_vifT __fi nVifBlock* dVifCompile(nVifBlock& block, bool isFill)
+{
+	nVifStruct& v = nVif[idx];
+
+	// Check size before the compilation
+	if (v.vifBlocks.full())
+	{
+		DevCon.WriteLn("nVif Recompiler Cache Reset! [%u variants]", HashBucket::MAX_ENTRIES);
+		dVifReset(idx);
+	}
+	else if (v.recWritePtr >= v.recSegmentEnd)
+	{
+		dVifNextSegment<idx>();
+	}
+
+	// Compile the block now
+	dVifEmit<idx>(block, isFill);
 
 	return &block;
 }
@@ -20,6 +20,7 @@
 #include "vtlb.h"
 #include "COP0.h"
 #include "Cache.h"
+#include "Counters.h"
 #include "IopMem.h"
 #include "Host.h"
 #include "VMManager.h"
@@ -29,8 +30,10 @@
 
 #include "fmt/core.h"
 
+#include <array>
 #include <bit>
 #include <map>
+#include <mutex>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -855,6 +858,9 @@ static bool vtlb_IsHostCoalesced(u32 page)
 	}
 }
 
+static bool mmap_IsEEPageWriteTracked(u32 offset);
+static bool mmap_IsIOPPageWriteTracked(u32 offset);
+
 static bool vtlb_GetMainMemoryOffsetFromPtr(uptr ptr, u32* mainmem_offset, u32* mainmem_size, PageProtectionMode* prot)
 {
 	const uptr page_end = ptr + VTLB_PAGE_SIZE;
@@ -863,7 +869,9 @@ static bool vtlb_GetMainMemoryOffsetFromPtr(uptr ptr, u32* mainmem_offset, u32*
 	if (ptr >= (uptr)eeMem->Main && page_end <= (uptr)eeMem->ZeroRead)
 	{
 		const u32 eemem_offset = static_cast<u32>(ptr - (uptr)eeMem->Main);
-		const bool writeable = ((eemem_offset < Ps2MemSize::ExposedRam) ? (mmap_GetRamPageInfo(eemem_offset) != ProtMode_Write) : true);
+		const bool writeable = ((eemem_offset < Ps2MemSize::ExposedRam) ?
+									(mmap_GetRamPageInfo(eemem_offset) != ProtMode_Write && !mmap_IsEEPageWriteTracked(eemem_offset)) :
+									true);
 		*mainmem_offset = (eemem_offset + HostMemoryMap::EEmemOffset);
 		*mainmem_size = (offsetof(EEVM_MemoryAllocMess, ZeroRead) - eemem_offset);
 		*prot = PageProtectionMode().Read().Write(writeable);
@@ -876,7 +884,7 @@ static bool vtlb_GetMainMemoryOffsetFromPtr(uptr ptr, u32* mainmem_offset, u32*
 		const u32 iopmem_offset = static_cast<u32>(ptr - (uptr)iopMem->Main);
 		*mainmem_offset = iopmem_offset + HostMemoryMap::IOPmemOffset;
 		*mainmem_size = (offsetof(IopVM_MemoryAllocMess, P) - iopmem_offset);
-		*prot = PageProtectionMode().Read().Write();
+		*prot = PageProtectionMode().Read().Write(!mmap_IsIOPPageWriteTracked(iopmem_offset));
 		return true;
 	}
 
@@ -1465,6 +1473,372 @@ void mmap_MarkCountedRamPage(u32 paddr)
 	vtlb_UpdateFastmemProtection(rampage << __pageshift, __pagesize, PageAccess_ReadOnly());
 }
 
+// ===========================================================================================
+//  Self-Modifying Code Tracking
+// ===========================================================================================
+// Writes to code are counted per page, so the recompiler can tell pages which are written once
+// in a while (overlays being loaded) from pages which mix code with busy data. The count halves
+// every SMC_DECAY_FRAMES, which lets a page go back to write protection after a burst of loads.
+//
+// The 256 byte sub-pages which were written are kept until the count decays to zero, so that
+// the recompiler only has to throw away the blocks which overlap them.
+
+static constexpr u32 SMC_DECAY_FRAMES = 1800;
+static constexpr u32 SMC_WRITE_WEIGHT = 16;
+static constexpr u32 SMC_SUBPAGE_SHIFT = 8;
+
+struct SMCPageInfo
+{
+	u32 decay_frame; // g_FrameCount when write_score was last decayed.
+	u16 write_score; // Writes scaled by SMC_WRITE_WEIGHT, halved every SMC_DECAY_FRAMES.
+	u16 dirty_mask; // Sub-pages written since the score was last zero.
+	u32 recompiles; // Blocks compiled after the page's code was first written.
+	bool written;
+};
+
+static_assert((__pagesize >> SMC_SUBPAGE_SHIFT) <= 16, "Sub-page mask is too small");
+
+alignas(16) static SMCPageInfo s_smc_pages[Ps2MemSize::TotalRam >> __pageshift];
+
+static SMCPageInfo* mmap_GetSMCPage(u32 paddr)
+{
+	const uptr ptr = (uptr)PSM(paddr);
+	const uptr offset = ptr - (uptr)eeMem->Main;
+	if (!ptr || offset >= Ps2MemSize::ExposedRam)
+		return nullptr;
+
+	return &s_smc_pages[offset >> __pageshift];
+}
+
+static u32 mmap_GetDecayedScore(const SMCPageInfo& info)
+{
+	const u32 periods = (g_FrameCount - info.decay_frame) / SMC_DECAY_FRAMES;
+	return (periods < 16) ? (info.write_score >> periods) : 0;
+}
+
+// Applies any pending decay, only called from the CPU thread.
+static SMCPageInfo* mmap_UpdateSMCPage(u32 paddr)
+{
+	SMCPageInfo* info = mmap_GetSMCPage(paddr);
+	if (!info)
+		return nullptr;
+
+	const u32 periods = (g_FrameCount - info->decay_frame) / SMC_DECAY_FRAMES;
+	if (periods > 0)
+	{
+		info->write_score = static_cast<u16>(mmap_GetDecayedScore(*info));
+		info->decay_frame += periods * SMC_DECAY_FRAMES;
+		if (info->write_score == 0)
+			info->dirty_mask = 0;
+	}
+
+	return info;
+}
+
+void mmap_RecordCodeWrite(u32 paddr, u32 size)
+{
+	SMCPageInfo* info = mmap_UpdateSMCPage(paddr);
+	if (!info || size == 0)
+		return;
+
+	const u32 first = (paddr & __pagemask) >> SMC_SUBPAGE_SHIFT;
+	const u32 last = std::min((paddr & __pagemask) + size - 1, __pagemask) >> SMC_SUBPAGE_SHIFT;
+	for (u32 i = first; i <= last; i++)
+		info->dirty_mask |= static_cast<u16>(1u << i);
+
+	info->write_score = static_cast<u16>(std::min<u32>(info->write_score + SMC_WRITE_WEIGHT, 0xffff));
+	info->written = true;
+}
+
+void mmap_RecordBlockCompile(u32 paddr)
+{
+	SMCPageInfo* info = mmap_GetSMCPage(paddr);
+	if (info && info->written)
+		info->recompiles++;
+}
+
+u32 mmap_GetRecentCodeWrites(u32 paddr)
+{
+	const SMCPageInfo* info = mmap_UpdateSMCPage(paddr);
+	return info ? (info->write_score / SMC_WRITE_WEIGHT) : 0;
+}
+
+u16 mmap_GetCodeDirtyMask(u32 paddr)
+{
+	const SMCPageInfo* info = mmap_UpdateSMCPage(paddr);
+	return info ? info->dirty_mask : 0;
+}
+
+// Most recompiled pages as of the last vsync, the overlay reads these from the GS thread.
+static constexpr u32 SMC_STATS_COUNT = 4;
+static std::array<mmap_SMCPageStats, SMC_STATS_COUNT> s_smc_stats;
+static u32 s_smc_stats_count = 0;
+static std::mutex s_smc_stats_mutex;
+
+void mmap_PublishSMCPageStats()
+{
+	std::array<mmap_SMCPageStats, SMC_STATS_COUNT> stats;
+	u32 count = 0;
+
+	if (EmuConfig.GS.OsdShowSMCStats)
+	{
+		const u32 num_pages = Ps2MemSize::ExposedRam >> __pageshift;
+		for (u32 page = 0; page < num_pages; page++)
+		{
+			const SMCPageInfo& info = s_smc_pages[page];
+			if (info.recompiles == 0)
+				continue;
+
+			u32 pos = count;
+			while (pos > 0 && stats[pos - 1].recompiles < info.recompiles)
+			{
+				if (pos < SMC_STATS_COUNT)
+					stats[pos] = stats[pos - 1];
+				pos--;
+			}
+			if (pos >= SMC_STATS_COUNT)
+				continue;
+
+			stats[pos].paddr = page << __pageshift;
+			stats[pos].recompiles = info.recompiles;
+			stats[pos].recent_writes = mmap_GetDecayedScore(info) / SMC_WRITE_WEIGHT;
+			stats[pos].mode = m_PageProtectInfo[page].Mode;
+			count = std::min(count + 1, SMC_STATS_COUNT);
+		}
+	}
+
+	std::unique_lock lock(s_smc_stats_mutex);
+	s_smc_stats = stats;
+	s_smc_stats_count = count;
+}
+
+u32 mmap_GetSMCPageStats(mmap_SMCPageStats* stats, u32 max_count)
+{
+	std::unique_lock lock(s_smc_stats_mutex);
+	const u32 count = std::min(s_smc_stats_count, max_count);
+	std::copy_n(s_smc_stats.begin(), count, stats);
+	return count;
+}
+
+// ===========================================================================================
+//  Dirty Page Tracking
+// ===========================================================================================
+// Incremental save states reuse a buffer holding an older snapshot, and only need to copy
+// the pages which have been written since. Rather than instrumenting every store, clean
+// pages are write-protected, piggybacking on the handler above. The first write to a page
+// after a snapshot faults, marks the page dirty, and makes it writeable again.
+//
+// Pages don't record which snapshot they were clean in, only the generation of the last
+// snapshot they were found dirty in. A buffer holding generation N therefore needs every
+// page stamped after N, which lets any number of buffers share the one set of counters.
+//
+// Code pages under ProtMode_Write are already read-only, the SMC path marks them dirty
+// when it unprotects them. Anything that unprotects memory wholesale (block tracking
+// resets) marks every page dirty instead.
+
+struct DirtyPageTracker
+{
+	static constexpr u32 EE_PAGES = Ps2MemSize::TotalRam >> __pageshift;
+	static constexpr u32 IOP_PAGES = Ps2MemSize::IopRam >> __pageshift;
+
+	// Non-zero if the page is writeable, i.e. it's been written since the last snapshot.
+	u8 ee_dirty[EE_PAGES];
+	u8 iop_dirty[IOP_PAGES];
+
+	// Generation of the last snapshot which found the page dirty.
+	u32 ee_generation[EE_PAGES];
+	u32 iop_generation[IOP_PAGES];
+
+	u32 generation;
+	bool enabled;
+};
+
+static DirtyPageTracker s_dirty_pages;
+
+// EE physical address which IOP memory is mapped at, used to find its fastmem views.
+static constexpr u32 IOP_MEM_EE_PADDR = 0x1c000000;
+
+static bool mmap_IsEEPageWriteTracked(u32 offset)
+{
+	return s_dirty_pages.enabled && !s_dirty_pages.ee_dirty[offset >> __pageshift];
+}
+
+static bool mmap_IsIOPPageWriteTracked(u32 offset)
+{
+	return s_dirty_pages.enabled && !s_dirty_pages.iop_dirty[offset >> __pageshift];
+}
+
+static void mmap_MarkAllPagesDirty()
+{
+	std::memset(s_dirty_pages.ee_dirty, 1, sizeof(s_dirty_pages.ee_dirty));
+	std::memset(s_dirty_pages.iop_dirty, 1, sizeof(s_dirty_pages.iop_dirty));
+}
+
+// Protects or unprotects [start_page, end_page) of EE or IOP memory, including any fastmem views.
+static void mmap_ProtectTrackedPages(bool iop, u32 start_page, u32 end_page, bool writeable)
+{
+	const u32 offset = start_page << __pageshift;
+	const u32 size = (end_page - start_page) << __pageshift;
+	const PageProtectionMode mode = writeable ? PageAccess_ReadWrite() : PageAccess_ReadOnly();
+	if (iop)
+	{
+		HostSys::MemProtect(&iopMem->Main[offset], size, mode);
+		vtlb_UpdateFastmemProtection(IOP_MEM_EE_PADDR + offset, size, mode);
+	}
+	else
+	{
+		HostSys::MemProtect(&eeMem->Main[offset], size, mode);
+		vtlb_UpdateFastmemProtection(offset, size, mode);
+	}
+}
+
+// Stamps dirty pages with the current generation and write-protects them again, a run at a time.
+static void mmap_RearmTrackedPages(bool iop, u8* dirty, u32* generation, u32 num_pages)
+{
+	u32 page = 0;
+	while (page < num_pages)
+	{
+		if (!dirty[page])
+		{
+			page++;
+			continue;
+		}
+
+		const u32 start_page = page;
+		for (; page < num_pages && dirty[page]; page++)
+		{
+			// Code pages are already read-only, and need to stay that way when tracking stops.
+			dirty[page] = 0;
+			generation[page] = s_dirty_pages.generation;
+		}
+
+		mmap_ProtectTrackedPages(iop, start_page, page, false);
+	}
+}
+
+// Handles a write to a page protected only for dirty tracking. Returns false if the page
+// isn't tracked, or is a code page which needs the SMC path.
+static bool mmap_HandleDirtyPageFault(uptr ptr)
+{
+	if (!s_dirty_pages.enabled)
+		return false;
+
+	const uptr ee_offset = ptr - reinterpret_cast<uptr>(eeMem->Main);
+	if (ee_offset < Ps2MemSize::ExposedRam)
+	{
+		const u32 page = static_cast<u32>(ee_offset >> __pageshift);
+		if (s_dirty_pages.ee_dirty[page] || m_PageProtectInfo[page].Mode == ProtMode_Write)
+			return false;
+
+		s_dirty_pages.ee_dirty[page] = 1;
+		mmap_ProtectTrackedPages(false, page, page + 1, true);
+		return true;
+	}
+
+	const uptr iop_offset = ptr - reinterpret_cast<uptr>(iopMem->Main);
+	if (iop_offset < Ps2MemSize::IopRam)
+	{
+		const u32 page = static_cast<u32>(iop_offset >> __pageshift);
+		if (s_dirty_pages.iop_dirty[page])
+			return false;
+
+		s_dirty_pages.iop_dirty[page] = 1;
+		mmap_ProtectTrackedPages(true, page, page + 1, true);
+		return true;
+	}
+
+	return false;
+}
+
+void mmap_SetDirtyTrackingEnabled(bool enabled)
+{
+	if (s_dirty_pages.enabled == enabled)
+		return;
+
+	if (enabled)
+	{
+		// Nothing is protected yet, so the first snapshot stamps everything.
+		mmap_MarkAllPagesDirty();
+		std::memset(s_dirty_pages.ee_generation, 0, sizeof(s_dirty_pages.ee_generation));
+		std::memset(s_dirty_pages.iop_generation, 0, sizeof(s_dirty_pages.iop_generation));
+		s_dirty_pages.enabled = true;
+		return;
+	}
+
+	s_dirty_pages.enabled = false;
+
+	// Drop the protection from clean pages, leaving code pages alone.
+	const u32 ee_pages = Ps2MemSize::ExposedRam >> __pageshift;
+	for (u32 page = 0; page < ee_pages; page++)
+	{
+		if (!s_dirty_pages.ee_dirty[page] && m_PageProtectInfo[page].Mode != ProtMode_Write)
+			mmap_ProtectTrackedPages(false, page, page + 1, true);
+	}
+	for (u32 page = 0; page < DirtyPageTracker::IOP_PAGES; page++)
+	{
+		if (!s_dirty_pages.iop_dirty[page])
+			mmap_ProtectTrackedPages(true, page, page + 1, true);
+	}
+
+	mmap_MarkAllPagesDirty();
+}
+
+bool mmap_IsDirtyTrackingEnabled()
+{
+	return s_dirty_pages.enabled;
+}
+
+u32 mmap_BeginDirtySnapshot()
+{
+	pxAssert(s_dirty_pages.enabled);
+
+	// Only the CPU thread writes to EE/IOP memory while we're here, so a page can't be
+	// dirtied between clearing its flag and protecting it.
+	s_dirty_pages.generation++;
+	mmap_RearmTrackedPages(false, s_dirty_pages.ee_dirty, s_dirty_pages.ee_generation, Ps2MemSize::ExposedRam >> __pageshift);
+	mmap_RearmTrackedPages(true, s_dirty_pages.iop_dirty, s_dirty_pages.iop_generation, DirtyPageTracker::IOP_PAGES);
+	return s_dirty_pages.generation;
+}
+
+bool mmap_CopyChangedPages(u8* dest, const u8* src, u32 size, u32 since)
+{
+	const u32* generation;
+	if (src == eeMem->Main && size <= Ps2MemSize::ExposedRam)
+		generation = s_dirty_pages.ee_generation;
+	else if (src == iopMem->Main && size <= Ps2MemSize::IopRam)
+		generation = s_dirty_pages.iop_generation;
+	else
+		return false;
+
+	if (!s_dirty_pages.enabled || since == 0 || since > s_dirty_pages.generation)
+		return false;
+
+	const u32 num_pages = size >> __pageshift;
+	u32 page = 0;
+	while (page < num_pages)
+	{
+		if (generation[page] <= since)
+		{
+			page++;
+			continue;
+		}
+
+		const u32 start_page = page;
+		while (page < num_pages && generation[page] > since)
+			page++;
+
+		const u32 offset = start_page << __pageshift;
+		std::memcpy(dest + offset, src + offset, (page - start_page) << __pageshift);
+	}
+
+	// Partial trailing page, never the case for the sizes we track.
+	const u32 tail = num_pages << __pageshift;
+	if (tail < size)
+		std::memcpy(dest + tail, src + tail, size - tail);
+
+	return true;
+}
+
 // offset - offset of address relative to psM.
 // All recompiled blocks belonging to the page are cleared, and any new blocks recompiled
 // from code residing in this page will use manual protection.
@@ -1481,7 +1855,21 @@ static __fi void mmap_ClearCpuBlock(uint offset)
 
 	HostSys::MemProtect(&eeMem->Main[rampage << __pageshift], __pagesize, PageAccess_ReadWrite());
 	vtlb_UpdateFastmemProtection(rampage << __pageshift, __pagesize, PageAccess_ReadWrite());
+	s_dirty_pages.ee_dirty[rampage] = 1;
 	m_PageProtectInfo[rampage].Mode = ProtMode_Manual;
+
+	// We only know where the write starts, assume it's no wider than a quadword.
+	const u32 paddr = m_PageProtectInfo[rampage].ReverseRamMap | (offset & __pagemask);
+	mmap_RecordCodeWrite(paddr, 16);
+
+#ifdef _M_X86
+	if (Cpu == &recCpu)
+	{
+		recClearPageWrite(paddr);
+		return;
+	}
+#endif
+
 	Cpu->Clear(m_PageProtectInfo[rampage].ReverseRamMap, __pagesize);
 }
 
@@ -1497,12 +1885,16 @@ PageFaultHandler::HandlerResult PageFaultHandler::HandlePageFault(void* exceptio
 
 		uptr ptr = (uptr)PSM(vaddr);
 		uptr offset = (ptr - (uptr)eeMem->Main);
-		if (ptr && m_PageProtectInfo[offset >> __pageshift].Mode == ProtMode_Write)
+		if (ptr && offset < Ps2MemSize::ExposedRam && m_PageProtectInfo[offset >> __pageshift].Mode == ProtMode_Write)
 		{
 			// fprintf(stderr, "Not backpatching code write at %08X\n", vaddr);
 			mmap_ClearCpuBlock(offset);
 			return HandlerResult::ContinueExecution;
 		}
+		else if (ptr && is_write && mmap_HandleDirtyPageFault(ptr))
+		{
+			return HandlerResult::ContinueExecution;
+		}
 		else
 		{
 			// fprintf(stderr, "Trying backpatching vaddr %08X\n", vaddr);
@@ -1514,6 +1906,9 @@ PageFaultHandler::HandlerResult PageFaultHandler::HandlePageFault(void* exceptio
 	}
 	else
 	{
+		if (mmap_HandleDirtyPageFault(reinterpret_cast<uptr>(fault_address)))
+			return HandlerResult::ContinueExecution;
+
 		// get bad virtual address
 		uptr offset = reinterpret_cast<uptr>(fault_address) - reinterpret_cast<uptr>(eeMem->Main);
 		if (offset >= Ps2MemSize::ExposedRam)
@@ -1532,7 +1927,21 @@ void mmap_ResetBlockTracking()
 {
 	//DbgCon.WriteLn( "vtlb/mmap: Block Tracking reset..." );
 	std::memset(m_PageProtectInfo, 0, sizeof(m_PageProtectInfo));
+	std::memset(s_smc_pages, 0, sizeof(s_smc_pages));
+	{
+		std::unique_lock lock(s_smc_stats_mutex);
+		s_smc_stats_count = 0;
+	}
 	if (eeMem)
 		HostSys::MemProtect(eeMem->Main, Ps2MemSize::ExposedRam, PageAccess_ReadWrite());
 	vtlb_UpdateFastmemProtection(0, Ps2MemSize::ExposedRam, PageAccess_ReadWrite());
+
+	// Pages protected for dirty tracking are writeable again, so nothing can be assumed clean.
+	if (s_dirty_pages.enabled)
+	{
+		if (iopMem)
+			HostSys::MemProtect(iopMem->Main, Ps2MemSize::IopRam, PageAccess_ReadWrite());
+		vtlb_UpdateFastmemProtection(IOP_MEM_EE_PADDR, Ps2MemSize::IopRam, PageAccess_ReadWrite());
+		mmap_MarkAllPagesDirty();
+	}
 }
@@ -232,6 +232,50 @@ extern vtlb_ProtectionMode mmap_GetRamPageInfo(u32 paddr);
 extern void mmap_MarkCountedRamPage(u32 paddr);
 extern void mmap_ResetBlockTracking();
 
+// Self-modifying code tracking. Writes to code pages are kept in a per-page histogram which
+// decays over time, along with which 256 byte sub-pages were written.
+struct mmap_SMCPageStats
+{
+	u32 paddr;
+	u32 recompiles;
+	u32 recent_writes;
+	vtlb_ProtectionMode mode;
+};
+
+extern void mmap_RecordCodeWrite(u32 paddr, u32 size);
+extern void mmap_RecordBlockCompile(u32 paddr);
+
+// Returns roughly how many times code in the page holding paddr has been written lately.
+extern u32 mmap_GetRecentCodeWrites(u32 paddr);
+
+// Returns the recently written 256 byte sub-pages of the page holding paddr, one bit each.
+extern u16 mmap_GetCodeDirtyMask(u32 paddr);
+
+// Takes a snapshot of the most recompiled pages for mmap_GetSMCPageStats(), called on the CPU thread each vsync.
+extern void mmap_PublishSMCPageStats();
+
+// Fills stats with the pages which had been recompiled the most as of the last snapshot, returning how
+// many were written. Safe to call from any thread.
+extern u32 mmap_GetSMCPageStats(mmap_SMCPageStats* stats, u32 max_count);
+
+// Implemented by the EE recompiler. Invalidates the code in a page which was under write protection
+// and is about to be written, the page has already been switched to manual protection.
+extern void recClearPageWrite(u32 paddr);
+
+// Dirty page tracking for incremental save states. While enabled, pages of EE and IOP main
+// memory are write-protected after each snapshot, and the first write to a page stamps it
+// with the generation of the next snapshot.
+extern void mmap_SetDirtyTrackingEnabled(bool enabled);
+extern bool mmap_IsDirtyTrackingEnabled();
+
+// Starts a new snapshot, returning its generation (never zero). Pages written since the
+// previous snapshot are stamped with it and write-protected again.
+extern u32 mmap_BeginDirtySnapshot();
+
+// Copies the pages of src (EE or IOP main memory) which changed after snapshot `since` into
+// dest, which must already hold that snapshot. Returns false if src isn't tracked.
+extern bool mmap_CopyChangedPages(u8* dest, const u8* src, u32 size, u32 since);
+
 // --------------------------------------------------------------------------------------
 //  Goemon game fix
 // --------------------------------------------------------------------------------------
@@ -2,6 +2,31 @@
 // SPDX-License-Identifier: GPL-3.0+
 
 #include "BaseblockEx.h"
+#include "Config.h"
+
+#include "common/Console.h"
+#include "common/FileSystem.h"
+#include "common/Path.h"
+
+#include "fmt/format.h"
+
+#define XXH_STATIC_LINKING_ONLY 1
+#define XXH_INLINE_ALL 1
+#include <xxhash.h>
+
+static constexpr u32 BLOCK_PROFILE_MAGIC = 0x46504242; // BBPF
+static constexpr u32 BLOCK_PROFILE_VERSION = 1;
+
+struct BlockProfileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 count;
+	u32 pad;
+};
+
+BaseBlockProfile g_eeBlockProfile("ee");
+BaseBlockProfile g_iopBlockProfile("iop");
 
 BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
 {
@@ -12,6 +37,18 @@ BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
 	return blocks.insert(startpc, fnptr);
 }
 
+// Points an existing block, and every jump linked to it, at new code.
+void BaseBlocks::Relink(u32 startpc, uptr fnptr)
+{
+	BASEBLOCKEX* block = Get(startpc);
+	pxAssert(block && block->startpc == startpc);
+	block->fnptr = fnptr;
+
+	std::pair<linkiter_t, linkiter_t> range = links.equal_range(startpc);
+	for (linkiter_t i = range.first; i != range.second; ++i)
+		*(u32*)i->second = fnptr - (i->second + 4);
+}
+
 int BaseBlocks::LastIndex(u32 startpc) const
 {
 	if (0 == blocks.size())
@@ -66,3 +103,158 @@ void BaseBlocks::Link(u32 pc, s32* jumpptr)
 		*jumpptr = (s32)(recompiler - (sptr)(jumpptr + 1));
 	links.insert(std::pair<u32, uptr>(pc, (uptr)jumpptr));
 }
+
+BaseBlockProfile::BaseBlockProfile(const char* name)
+	: m_name(name)
+{
+}
+
+std::string BaseBlockProfile::GetCachePath() const
+{
+	return Path::Combine(EmuFolders::Cache, fmt::format("{}_blocks_{:08X}.bin", m_name, m_crc));
+}
+
+u64 BaseBlockProfile::HashCode(const u8* code, u32 size)
+{
+	return XXH3_64bits(code, size * 4);
+}
+
+void BaseBlockProfile::SetGame(u32 crc)
+{
+	if (m_crc == crc)
+		return;
+
+	Flush();
+
+	m_entries.clear();
+	m_pending.clear();
+	m_attempts = 0;
+
+	m_crc = crc;
+	if (m_crc != 0)
+		Load();
+}
+
+void BaseBlockProfile::Load()
+{
+	const std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(GetCachePath().c_str());
+	if (!data.has_value())
+		return;
+
+	BlockProfileHeader header;
+	if (data->size() < sizeof(header))
+		return;
+
+	std::memcpy(&header, data->data(), sizeof(header));
+	if (header.magic != BLOCK_PROFILE_MAGIC || header.version != BLOCK_PROFILE_VERSION ||
+		header.count > MAX_ENTRIES || data->size() != (sizeof(header) + header.count * sizeof(Entry)))
+	{
+		Console.Warning("(BlockProfile) Ignoring invalid %s block profile for %08X.", m_name, m_crc);
+		return;
+	}
+
+	// Ranges are checked against RAM by the recompiler before anything is hashed, only the size is bounded here.
+	const u8* ptr = data->data() + sizeof(header);
+	for (u32 i = 0; i < header.count; i++, ptr += sizeof(Entry))
+	{
+		Entry entry;
+		std::memcpy(&entry, ptr, sizeof(entry));
+		if (entry.size == 0 || entry.size > MAX_BLOCK_SIZE)
+			continue;
+
+		m_pending.push_back(PendingEntry{entry, 0});
+		m_entries.emplace(entry.startpc, entry);
+	}
+
+	DevCon.WriteLn("(BlockProfile) Loaded %zu %s blocks for %08X.", m_pending.size(), m_name, m_crc);
+}
+
+void BaseBlockProfile::Flush()
+{
+	if (!m_dirty || m_crc == 0)
+		return;
+
+	m_dirty = false;
+
+	BlockProfileHeader header = {};
+	header.magic = BLOCK_PROFILE_MAGIC;
+	header.version = BLOCK_PROFILE_VERSION;
+	header.count = static_cast<u32>(m_entries.size());
+
+	std::vector<u8> data(sizeof(header) + m_entries.size() * sizeof(Entry));
+	std::memcpy(data.data(), &header, sizeof(header));
+
+	u8* ptr = data.data() + sizeof(header);
+	for (const auto& it : m_entries)
+	{
+		std::memcpy(ptr, &it.second, sizeof(Entry));
+		ptr += sizeof(Entry);
+	}
+
+	if (!FileSystem::WriteBinaryFile(GetCachePath().c_str(), data.data(), data.size()))
+		Console.Error("(BlockProfile) Failed to write %s block profile for %08X.", m_name, m_crc);
+}
+
+void BaseBlockProfile::Record(u32 startpc, u32 size, const u8* code)
+{
+	if (m_crc == 0 || size == 0)
+		return;
+
+	const u64 hash = HashCode(code, size);
+	auto it = m_entries.find(startpc);
+	if (it != m_entries.end())
+	{
+		if (it->second.size == size && it->second.hash == hash)
+			return;
+
+		it->second.size = size;
+		it->second.hash = hash;
+	}
+	else
+	{
+		if (m_entries.size() >= MAX_ENTRIES)
+			return;
+
+		m_entries.emplace(startpc, Entry{startpc, size, hash});
+	}
+
+	m_dirty = true;
+}
+
+void BaseBlockProfile::Precompile(GetCodeFn get_code, CompileFn compile)
+{
+	// Blocks which don't match yet are put back on the list for the next attempt, but only a few times,
+	// so a profile which doesn't fit the running code stops costing a hash per block.
+	std::vector<PendingEntry> pending = std::move(m_pending);
+	m_pending.clear();
+
+	u32 compiled = 0;
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		const Entry& entry = pending[i].entry;
+		const u8* code = get_code(entry.startpc, entry.size);
+		if (!code || HashCode(code, entry.size) != entry.hash)
+		{
+			if (++pending[i].mismatches < MAX_MISMATCHES)
+				m_pending.push_back(pending[i]);
+			continue;
+		}
+
+		if (!compile(entry.startpc))
+		{
+			m_pending.clear();
+			break;
+		}
+
+		compiled++;
+	}
+
+	if (++m_attempts >= MAX_ATTEMPTS)
+		m_pending.clear();
+
+	if (compiled > 0)
+	{
+		DevCon.WriteLn("(BlockProfile) Precompiled %u %s blocks for %08X, %zu pending.",
+			compiled, m_name, m_crc, m_pending.size());
+	}
+}
@@ -5,6 +5,9 @@
 
 #include <cstring>
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "common/Assertions.h"
 
@@ -26,6 +29,7 @@ struct BASEBLOCKEX
 	u32 startpc;
 	u32 size;    // The size in dwords (equivalent to the number of instructions)
 	u32 x86size; // The size in byte of the translated x86 instructions
+	u16* counter; // Entry counter of tier 0 EE blocks, null if the block isn't counted
 
 #ifdef PCSX2_DEVBUILD
 	// Could be useful to instrument the block
@@ -161,6 +165,7 @@ public:
 	}
 
 	BASEBLOCKEX* New(u32 startpc, uptr fnptr);
+	void Relink(u32 startpc, uptr fnptr);
 	int LastIndex(u32 startpc) const;
 	//BASEBLOCKEX* GetByX86(uptr ip);
 
@@ -226,6 +231,68 @@ public:
 	}
 };
 
+// Per-game list of the blocks a recompiler compiled, keyed by the ELF CRC. It's written to the
+// cache directory so the next boot of the same ELF can compile those blocks before execution
+// first reaches them, instead of stalling mid-game. Each block carries a hash of its guest
+// code, blocks whose code no longer matches (overlays which aren't loaded yet, etc) are kept
+// pending and retried for a while.
+class BaseBlockProfile
+{
+public:
+	// Returns a pointer to size instructions of guest code at pc, or null if they aren't all backed by RAM.
+	using GetCodeFn = const u8* (*)(u32 pc, u32 size);
+	// Compiles the block at pc. Returns false if there's no room left to keep going.
+	using CompileFn = bool (*)(u32 pc);
+
+	explicit BaseBlockProfile(const char* name);
+
+	// Writes out the current profile if it changed, then loads the profile for crc and queues
+	// its blocks for precompilation. Zero means no game is running.
+	void SetGame(u32 crc);
+	void Flush();
+
+	void Record(u32 startpc, u32 size, const u8* code);
+
+	__fi bool HasPending() const { return !m_pending.empty(); }
+
+	// Compiles every pending block whose guest code matches the recorded hash.
+	void Precompile(GetCodeFn get_code, CompileFn compile);
+
+private:
+	static constexpr u32 MAX_ENTRIES = 0x20000;
+	static constexpr u32 MAX_ATTEMPTS = 600;
+	static constexpr u32 MAX_MISMATCHES = 3; // hashes a pending block's code is checked against before giving up on it
+	static constexpr u32 MAX_BLOCK_SIZE = 0xffff; // instructions, matches the size kept in BASEBLOCKEX
+
+	struct Entry
+	{
+		u32 startpc;
+		u32 size;
+		u64 hash;
+	};
+
+	struct PendingEntry
+	{
+		Entry entry;
+		u32 mismatches;
+	};
+
+	std::string GetCachePath() const;
+	void Load();
+
+	static u64 HashCode(const u8* code, u32 size);
+
+	const char* m_name;
+	std::unordered_map<u32, Entry> m_entries;
+	std::vector<PendingEntry> m_pending;
+	u32 m_crc = 0;
+	u32 m_attempts = 0;
+	bool m_dirty = false;
+};
+
+extern BaseBlockProfile g_eeBlockProfile;
+extern BaseBlockProfile g_iopBlockProfile;
+
 #define PC_GETBLOCK_(x, reclut) ((BASEBLOCK*)(reclut[((u32)(x)) >> 16] + (x) * (sizeof(BASEBLOCK) / 4)))
 
 /**
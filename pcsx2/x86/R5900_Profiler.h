@@ -216,6 +216,8 @@ static const char eeOpcodeName[][16] = {
 #include <utility>
 #include <algorithm>
 
+#include "common/Timer.h"
+
 using namespace x86Emitter;
 
 struct eeProfiler
@@ -228,6 +230,10 @@ struct eeProfiler
 	u64 memStatsSlow;
 	u64 memStatsFast;
 	u32 memMask;
+	u32 tierPromotions;
+	u64 dynaPatchLookups;
+	u64 dynaPatchChecks;
+	u64 dynaPatchTicks;
 
 	void Reset()
 	{
@@ -237,6 +243,10 @@ struct eeProfiler
 		memStatsSlow = 0;
 		memStatsFast = 0;
 		memMask = 0xF700FFF0;
+		tierPromotions = 0;
+		dynaPatchLookups = 0;
+		dynaPatchChecks = 0;
+		dynaPatchTicks = 0;
 		pxAssert(eeOpcodeName[static_cast<int>(eeOpcode::LAST)][0] == '!');
 	}
 
@@ -362,6 +372,27 @@ struct eeProfiler
 			if (stat < 0.01)
 				break;
 		}
+
+		DevCon.WriteLn("\nEE Tiering: %u blocks promoted", tierPromotions);
+		DevCon.WriteLn("EE Dynamic Patches: %llu lookups, %llu patches checked, %.3f ms",
+			dynaPatchLookups, dynaPatchChecks, Common::Timer::ConvertValueToMilliseconds(dynaPatchTicks));
+	}
+
+	void OnBlockPromoted()
+	{
+		tierPromotions++;
+	}
+
+	u64 DynamicPatchStart()
+	{
+		return Common::Timer::GetCurrentValue();
+	}
+
+	void OnDynamicPatchesChecked(u64 start, u32 checked)
+	{
+		dynaPatchLookups++;
+		dynaPatchChecks += checked;
+		dynaPatchTicks += Common::Timer::GetCurrentValue() - start;
 	}
 
 	// Warning dirty ebx
@@ -407,6 +438,9 @@ struct eeProfiler
 	__fi void EmitConstMem(u32 add) {}
 	__fi void EmitSlowMem() {}
 	__fi void EmitFastMem() {}
+	__fi void OnBlockPromoted() {}
+	__fi u64 DynamicPatchStart() { return 0; }
+	__fi void OnDynamicPatchesChecked(u64 start, u32 checked) {}
 };
 #endif
 
@@ -81,6 +81,19 @@ u32 s_psxBlockCycles = 0; // cycles of current block recompiling
 static u32 s_savenBlockCycles = 0;
 static bool s_recompilingDelaySlot = false;
 
+// Blocks from the game's profile are compiled from iopRecRecompile(), this stops them recursing.
+static bool s_blockProfilePrecompiling = false;
+static u32 s_blockProfileLastAttempt = 0;
+
+// Host code offset of each guest instruction in the block being compiled, for the jitdump's line info.
+static std::vector<Perf::GuestInstruction> s_perfInsts;
+static bool s_perfRecordInsts = false;
+
+static void psxDisassembleForPerf(std::string& dest, u32 pc)
+{
+	dest = R3000A::disR3000AF(iopMemRead32(pc), pc);
+}
+
 static void iPsxBranchTest(u32 newpc, u32 cpuBranch);
 void psxRecompileNextInstruction(int delayslot);
 
@@ -894,6 +907,9 @@ void recResetIOP()
 {
 	DevCon.WriteLn("iR3000A Recompiler reset.");
 
+	if (recPtr)
+		Perf::iop.Unregister(SysMemory::GetIOPRec(), recPtr - SysMemory::GetIOPRec());
+
 	xSetPtr(SysMemory::GetIOPRec());
 	_DynGen_Dispatchers();
 	recPtr = xGetPtr();
@@ -947,6 +963,9 @@ void recResetIOP()
 	g_psxMaxRecMem = 0;
 
 	psxbranch = 0;
+
+	g_iopBlockProfile.SetGame(VMManager::Internal::HasBootedELF() ? VMManager::GetCurrentCRC() : 0);
+	s_blockProfileLastAttempt = psxRegs.cycle - static_cast<u32>(PSXCLK);
 }
 
 static void recShutdown()
@@ -1031,6 +1050,7 @@ static __fi u32 psxRecClearMem(u32 pc)
 
 		lowerextent = std::min(lowerextent, pexblock->startpc);
 		upperextent = std::max(upperextent, pexblock->startpc + pexblock->size * 4);
+		Perf::iop.Unregister((void*)pexblock->fnptr, pexblock->x86size);
 
 		blockidx++;
 	}
@@ -1461,6 +1481,9 @@ void psxRecompileNextInstruction(bool delayslot, bool swapped_delayslot)
 		_clearNeededX86regs();
 	}
 
+	if (s_perfRecordInsts)
+		s_perfInsts.push_back({static_cast<u32>(xGetPtr() - recPtr), psxpc});
+
 	psxRegs.code = iopMemRead32(psxpc);
 	s_psxBlockCycles++;
 	psxpc += 4;
@@ -1533,6 +1556,43 @@ static void PreBlockCheck(u32 blockpc)
 }
 #endif
 
+static const u8* iopGetBlockProfileCode(u32 startpc, u32 size)
+{
+	if (HWADDR(startpc) >= Ps2MemSize::IopRam || size > ((Ps2MemSize::IopRam - HWADDR(startpc)) / 4))
+		return nullptr;
+
+	return iopVirtMemR<u8>(startpc);
+}
+
+static bool iopPrecompileBlock(u32 startpc)
+{
+	// Leave room for blocks the profile doesn't know about, we can't reset from here.
+	if (recPtr >= (recPtrEnd - _1mb * 4))
+		return false;
+
+	// These have side effects when compiled, so leave them until they're executed.
+	if (startpc == 0x890 || startpc == 0x1630)
+		return true;
+
+	const uptr fnptr = PSX_GETBLOCK(startpc)->GetFnptr();
+	if (fnptr == (uptr)iopJITCompile || fnptr == (uptr)iopJITCompileInBlock)
+		iopRecRecompile(startpc);
+
+	return true;
+}
+
+static void iopPrecompileProfileBlocks()
+{
+	// Modules that aren't loaded yet are retried about once per frame.
+	if ((psxRegs.cycle - s_blockProfileLastAttempt) < static_cast<u32>(PSXCLK / 60))
+		return;
+
+	s_blockProfileLastAttempt = psxRegs.cycle;
+	s_blockProfilePrecompiling = true;
+	g_iopBlockProfile.Precompile(iopGetBlockProfileCode, iopPrecompileBlock);
+	s_blockProfilePrecompiling = false;
+}
+
 static void iopRecRecompile(const u32 startpc)
 {
 	u32 i;
@@ -1565,6 +1625,16 @@ static void iopRecRecompile(const u32 startpc)
 		recResetIOP();
 	}
 
+	if (g_iopBlockProfile.HasPending() && !s_blockProfilePrecompiling)
+	{
+		iopPrecompileProfileBlocks();
+
+		// The block we were asked for may have been in the profile.
+		const uptr fnptr = PSX_GETBLOCK(startpc)->GetFnptr();
+		if (fnptr != (uptr)iopJITCompile && fnptr != (uptr)iopJITCompileInBlock)
+			return;
+	}
+
 	xSetPtr(recPtr);
 	recPtr = xGetAlignedCallTarget();
 
@@ -1581,6 +1651,8 @@ static void iopRecRecompile(const u32 startpc)
 
 	s_pCurBlock->SetFnptr((uptr)x86Ptr);
 	s_psxBlockCycles = 0;
+	s_perfInsts.clear();
+	s_perfRecordInsts = Perf::IsJitDumpEnabled();
 
 	// reset recomp state variables
 	psxpc = startpc;
@@ -1716,6 +1788,9 @@ StartRecomp:
 	pxAssert((psxpc - startpc) >> 2 <= 0xffff);
 	s_pCurBlockEx->size = (psxpc - startpc) >> 2;
 
+	if ((HWADDR(startpc) + (psxpc - startpc)) <= Ps2MemSize::IopRam)
+		g_iopBlockProfile.Record(startpc, s_pCurBlockEx->size, iopVirtMemR<u8>(startpc));
+
 	for (i = 1; i < (u32)s_pCurBlockEx->size; ++i)
 	{
 		if (s_pCurBlock[i].GetFnptr() == (uptr)iopJITCompile)
@@ -1758,7 +1833,9 @@ StartRecomp:
 	pxAssert(xGetPtr() - recPtr < _64kb);
 	s_pCurBlockEx->x86size = xGetPtr() - recPtr;
 
-	Perf::iop.RegisterPC((void*)s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size, s_pCurBlockEx->startpc);
+	Perf::iop.RegisterBlock((void*)s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size, s_pCurBlockEx->startpc,
+		s_perfInsts.data(), s_perfInsts.size(), psxDisassembleForPerf);
+	s_perfRecordInsts = false;
 
 	recPtr = xGetPtr();
 
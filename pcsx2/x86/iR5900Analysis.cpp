@@ -165,7 +165,10 @@ void COP2FlagHackPass::Run(u32 start, u32 end, EEINST* inst_cache)
 		return true;
 	});
 
-	CommitAllFlags();
+	CommitStatusFlag();
+	CommitClipFlag();
+	if (m_last_mac_write && (m_num_successors == 0 || SuccessorsMayReadMACFlag(start, end)))
+		CommitMACFlag();
 
 #if 0
 	if (m_cfc2_pc != start)
@@ -173,6 +176,64 @@ void COP2FlagHackPass::Run(u32 start, u32 end, EEINST* inst_cache)
 #endif
 }
 
+void COP2FlagHackPass::SetSuccessors(const u32* pcs, u32 count)
+{
+	pxAssert(count <= MAX_SUCCESSORS);
+	std::copy(pcs, pcs + count, m_successors);
+	m_num_successors = count;
+}
+
+bool COP2FlagHackPass::SuccessorsMayReadMACFlag(u32 start, u32 end)
+{
+	for (u32 i = 0; i < m_num_successors; i++)
+	{
+		// Code outside the block can be rewritten without the block being invalidated, so the search
+		// has to stay within it (e.g. a loop back-edge). Running off the end counts as a possible read.
+		if (m_successors[i] < start || m_successors[i] >= end)
+			return true;
+
+		bool overwritten = false;
+		const u32 limit = std::min(m_successors[i] + SUCCESSOR_LOOKAHEAD * 4, end);
+		for (u32 apc = m_successors[i]; apc < limit; apc += 4)
+		{
+			const u32* code = static_cast<const u32*>(PSM(apc));
+			if (!code)
+				break;
+
+			cpuRegs.code = *code;
+
+			// Stores (SQ, SB-SWR, SWC1, SQC2, SD) can kick VIF0, and we don't follow control flow, so either of those ends the search.
+			if (_Opcode_ == 037 || (_Opcode_ >= 050 && _Opcode_ <= 056) || _Opcode_ == 071 || _Opcode_ == 076 || _Opcode_ == 077 || (_Opcode_ >= 001 && _Opcode_ <= 007) ||
+				(_Opcode_ >= 024 && _Opcode_ <= 027) || (_Opcode_ == 0 && (_Funct_ == 010 || _Funct_ == 011 || _Funct_ == 014 || _Funct_ == 015)) ||
+				(_Opcode_ == 020 && _Rs_ == 020 && _Funct_ == 030) || ((_Opcode_ == 021 || _Opcode_ == 022) && _Rs_ == 010))
+			{
+				break;
+			}
+
+			if (_Opcode_ != 022)
+				continue;
+
+			// CFC2/CTC2 of the MAC flag or FBRST, or VCALLMS(R), which can run a micro that reads it.
+			if (((_Rs_ == 2 || _Rs_ == 6) && (_Rd_ == REG_MAC_FLAG || _Rd_ == REG_FBRST)) ||
+				(((cpuRegs.code >> 25 & 1) == 1) && ((cpuRegs.code >> 2 & 15) == 14)))
+			{
+				break;
+			}
+
+			if (cop2flags(cpuRegs.code) & 2)
+			{
+				overwritten = true;
+				break;
+			}
+		}
+
+		if (!overwritten)
+			return true;
+	}
+
+	return false;
+}
+
 void COP2FlagHackPass::DumpAnnotatedBlock(u32 start, u32 end, EEINST* inst_cache)
 {
 	AnalysisPass::DumpAnnotatedBlock(start, end, inst_cache, [](u32, EEINST* eeinst, std::string& d) {
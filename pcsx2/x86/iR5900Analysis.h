@@ -35,9 +35,19 @@ namespace R5900
 
 		void Run(u32 start, u32 end, EEINST* inst_cache) override;
 
+		/// Sets the PCs which can execute after the block. If the MAC flag is overwritten there before
+		/// anything reads it, the last MAC flag update in the block is dropped. Only used for hot blocks,
+		/// and only code inside the block is looked at, since that's what its write protection covers.
+		void SetSuccessors(const u32* pcs, u32 count);
+
 	private:
+		static constexpr u32 MAX_SUCCESSORS = 2;
+		static constexpr u32 SUCCESSOR_LOOKAHEAD = 32;
+
 		void DumpAnnotatedBlock(u32 start, u32 end, EEINST* inst_cache);
 
+		bool SuccessorsMayReadMACFlag(u32 start, u32 end);
+
 		void CommitStatusFlag();
 		void CommitMACFlag();
 		void CommitClipFlag();
@@ -49,6 +59,9 @@ namespace R5900
 		EEINST* m_last_clip_write = nullptr;
 
 		u32 m_cfc2_pc = 0;
+
+		u32 m_successors[MAX_SUCCESSORS] = {};
+		u32 m_num_successors = 0;
 	};
 
 	class COP2MicroFinishPass final : public AnalysisPass
@@ -24,6 +24,8 @@
 // Only for MOVQ workaround.
 #include "common/emitter/internal.h"
 
+#include <unordered_set>
+
 //#define DUMP_BLOCKS 1
 //#define TRACE_BLOCKS 1
 
@@ -98,6 +100,10 @@ static EEINST* s_psaveInstInfo = nullptr;
 
 static u32 s_savenBlockCycles = 0;
 
+// Blocks from the game's profile are compiled from recRecompile(), this stops them recursing.
+static bool s_blockProfilePrecompiling = false;
+static u32 s_blockProfileLastAttempt = 0;
+
 static void iBranchTest(u32 newpc = 0xffffffff);
 static void ClearRecLUT(BASEBLOCK* base, int count);
 static u32 scaleblockcycles();
@@ -346,6 +352,7 @@ void recCall(void (*func)())
 static void recRecompile(const u32 startpc);
 static void dyna_block_discard(u32 start, u32 sz);
 static void dyna_page_reset(u32 start, u32 sz);
+static void dyna_block_promote(u32 start);
 
 static const void* DispatcherEvent = nullptr;
 static const void* DispatcherReg = nullptr;
@@ -354,6 +361,7 @@ static const void* JITCompileInBlock = nullptr;
 static const void* EnterRecompiledCode = nullptr;
 static const void* DispatchBlockDiscard = nullptr;
 static const void* DispatchPageReset = nullptr;
+static const void* DispatchBlockPromote = nullptr;
 
 static void recEventTest()
 {
@@ -469,6 +477,14 @@ static const void* _DynGen_DispatchPageReset()
 	return retval;
 }
 
+static const void* _DynGen_DispatchBlockPromote()
+{
+	u8* retval = xGetPtr();
+	xFastCall((const void*)dyna_block_promote);
+	xJMP(DispatcherReg);
+	return retval;
+}
+
 static void _DynGen_Dispatchers()
 {
 	const u8* start = xGetAlignedCallTarget();
@@ -483,6 +499,7 @@ static void _DynGen_Dispatchers()
 	EnterRecompiledCode = _DynGen_EnterRecompiledCode();
 	DispatchBlockDiscard = _DynGen_DispatchBlockDiscard();
 	DispatchPageReset = _DynGen_DispatchPageReset();
+	DispatchBlockPromote = _DynGen_DispatchBlockPromote();
 
 	recBlocks.SetJITCompile(JITCompile);
 
@@ -570,7 +587,44 @@ static void recReserve()
 }
 
 alignas(16) static u16 manual_page[Ps2MemSize::TotalRam >> 12];
-alignas(16) static u8 manual_counter[Ps2MemSize::TotalRam >> 12];
+
+// Pages whose code was written more than this many times lately get uncounted manual blocks.
+static constexpr u32 SMC_MAX_COUNTED_WRITES = 3;
+
+// Tiered compilation: blocks are first compiled with an entry counter. Once it overflows, the
+// block is marked as hot and recompiled with the more expensive tier 1 analysis.
+static constexpr u32 EE_TIER1_THRESHOLD = 4096;
+alignas(16) static u16 tier_counter[0x10000];
+static u32 tier_counters_used = 0;
+static std::unordered_set<u32> s_tier1Blocks;
+static bool s_nBlockTier1 = false;
+
+// Superblocks: tier 1 blocks carry on along the predicted fall-through path of conditional branches,
+// leaving through a side exit when the branch is taken. The trace stays contiguous and within one
+// page, so it's still covered by the block's range for SMC detection.
+static constexpr u32 EE_TRACE_MAX_EXITS = 8;
+static u32 s_traceExits[EE_TRACE_MAX_EXITS];
+static u32 s_traceExitCount = 0;
+
+// State of the fall-through path, saved when it reaches SetBranchImm() and restored after the branch.
+static u32 s_traceJoinPC = 0;
+static u32 s_traceJoinTarget = 0;
+static bool s_traceJoined = false;
+static u32* s_traceJoinJmp = nullptr;
+static _x86regs s_traceX86regs[iREGCNT_GPR];
+static _xmmregs s_traceXMMregs[iREGCNT_XMM];
+static GPR_reg64 s_traceConstRegs[32];
+static u32 s_traceHasConstReg = 0, s_traceFlushedConstReg = 0;
+static u32 s_tracenBlockCycles = 0;
+
+// Host code offset of each guest instruction in the block being compiled, for the jitdump's line info.
+static std::vector<Perf::GuestInstruction> s_perfInsts;
+static bool s_perfRecordInsts = false;
+
+static void recDisassembleForPerf(std::string& dest, u32 pc)
+{
+	disR5900Fasm(dest, *(u32*)PSM(pc), pc, false);
+}
 
 ////////////////////////////////////////////////////
 static void recResetRaw()
@@ -585,6 +639,9 @@ static void recResetRaw()
 
 	EE::Profiler.Reset();
 
+	if (recPtr)
+		Perf::ee.Unregister(SysMemory::GetEERec(), recPtr - SysMemory::GetEERec());
+
 	xSetPtr(SysMemory::GetEERec());
 	_DynGen_Dispatchers();
 	vtlb_DynGenDispatchers();
@@ -601,8 +658,14 @@ static void recResetRaw()
 	recBlocks.Reset();
 	vtlb_ClearLoadStoreInfo();
 
+	tier_counters_used = 0;
+	s_tier1Blocks.clear();
+
 	g_branch = 0;
 	g_resetEeScalingStats = true;
+
+	g_eeBlockProfile.SetGame(VMManager::Internal::HasBootedELF() ? VMManager::GetCurrentCRC() : 0);
+	s_blockProfileLastAttempt = cpuRegs.cycle - PS2CLK;
 }
 
 void recShutdown()
@@ -776,6 +839,7 @@ void recClear(u32 addr, u32 size)
 		// This might end up inside a block that doesn't contain the clearing range,
 		// so set it to recompile now.  This will become JITCompile if we clear it.
 		pblock->SetFnptr((uptr)JITCompileInBlock);
+		Perf::ee.Unregister((void*)pexblock->fnptr, pexblock->x86size);
 
 		blockidx--;
 	}
@@ -879,12 +943,62 @@ void SetBranchReg(u32 reg)
 	iBranchTest();
 }
 
+static bool recIsTraceExit(u32 branchpc)
+{
+	return std::find(s_traceExits, s_traceExits + s_traceExitCount, branchpc) != s_traceExits + s_traceExitCount;
+}
+
+// Keeps the fall-through path of a side exit branch in the superblock. Nothing is flushed, the
+// register state is put back by recTraceContinue() once the branch has finished compiling.
+static void recTraceJoin(u32 joinpc)
+{
+	memcpy(s_traceX86regs, x86regs, sizeof(x86regs));
+	memcpy(s_traceXMMregs, xmmregs, sizeof(xmmregs));
+	memcpy(s_traceConstRegs, g_cpuConstRegs, sizeof(g_cpuConstRegs));
+	s_traceHasConstReg = g_cpuHasConstReg;
+	s_traceFlushedConstReg = g_cpuFlushedConstReg;
+	s_tracenBlockCycles = s_nBlockCycles;
+
+	s_traceJoinJmp = JMP32(0);
+	s_traceJoined = true;
+	s_traceJoinTarget = joinpc;
+	s_traceJoinPC = 0;
+}
+
+static void recTraceContinue(u32 startpc)
+{
+	// The jump isn't needed when the fall-through path was the last thing compiled.
+	if (xGetPtr() == reinterpret_cast<u8*>(s_traceJoinJmp + 1))
+		xSetPtr(reinterpret_cast<u8*>(s_traceJoinJmp) - 1);
+	else
+		x86SetJ32(s_traceJoinJmp);
+
+	memcpy(x86regs, s_traceX86regs, sizeof(x86regs));
+	memcpy(xmmregs, s_traceXMMregs, sizeof(xmmregs));
+	memcpy(g_cpuConstRegs, s_traceConstRegs, sizeof(g_cpuConstRegs));
+	g_cpuHasConstReg = s_traceHasConstReg;
+	g_cpuFlushedConstReg = s_traceFlushedConstReg;
+	s_nBlockCycles = s_tracenBlockCycles;
+
+	// Likely branches folded to not-taken join from their delay slot, which has to be skipped on this path.
+	pc = s_traceJoinTarget;
+	g_pCurInstInfo = s_pInstCache + (pc - startpc) / 4;
+	g_branch = 0;
+	s_traceJoined = false;
+}
+
 void SetBranchImm(u32 imm)
 {
 	g_branch = 1;
 
 	pxAssert(imm);
 
+	if (imm == s_traceJoinPC)
+	{
+		recTraceJoin(imm);
+		return;
+	}
+
 	// end the current block
 	iFlushCall(FLUSH_EVERYTHING);
 	xMOV(ptr32[&cpuRegs.pc], imm);
@@ -1656,7 +1770,11 @@ void encodeMemcheck()
 void recompileNextInstruction(bool delayslot, bool swapped_delay_slot)
 {
 	if (EmuConfig.EnablePatches)
-		Patch::ApplyDynamicPatches(pc);
+	{
+		const u64 patchStart = EE::Profiler.DynamicPatchStart();
+		const u32 patchesChecked = Patch::ApplyDynamicPatches(pc);
+		EE::Profiler.OnDynamicPatchesChecked(patchStart, patchesChecked);
+	}
 
 	// add breakpoint
 	if (!delayslot)
@@ -1676,6 +1794,9 @@ void recompileNextInstruction(bool delayslot, bool swapped_delay_slot)
 		_clearNeededXMMregs();
 	}
 
+	if (s_perfRecordInsts)
+		s_perfInsts.push_back({static_cast<u32>(xGetPtr() - recPtr), pc});
+
 	s_pCode = (int*)PSM(pc);
 	pxAssert(s_pCode);
 
@@ -1996,6 +2117,7 @@ static void PreBlockCheck(u32 blockpc)
 void dyna_block_discard(u32 start, u32 sz)
 {
 	eeRecPerfLog.Write(Color_StrongGray, "Clearing Manual Block @ 0x%08X  [size=%d]", start, sz * 4);
+	mmap_RecordCodeWrite(start, sz * 4);
 	recClear(start, sz);
 }
 
@@ -2005,15 +2127,132 @@ void dyna_block_discard(u32 start, u32 sz)
 void dyna_page_reset(u32 start, u32 sz)
 {
 	recClear(start & ~0xfffUL, 0x400);
-	manual_counter[start >> 12]++;
 	mmap_MarkCountedRamPage(start);
 }
 
-static void memory_protect_recompiled_code(u32 startpc, u32 size)
+// Called when a tier 0 block's entry counter overflows. The block is cleared so that the
+// dispatcher recompiles it, this time with the tier 1 passes.
+void dyna_block_promote(u32 start)
+{
+	const u32 hwstart = HWADDR(start);
+	const BASEBLOCKEX* block = recBlocks.Get(hwstart);
+	if (!block || block->startpc != hwstart)
+		return;
+
+	eeRecPerfLog.Write(Color_StrongGray, "Promoting block @ 0x%08X  [size=%d]", start, block->size * 4);
+	EE::Profiler.OnBlockPromoted();
+
+	s_tier1Blocks.insert(hwstart);
+	recClear(hwstart, block->size);
+}
+
+// Returns how many times the tier 0 block at pc has been entered, or 0 if it isn't counted.
+// Promoted blocks aren't counted any more, they're reported as having reached the threshold.
+static u32 recGetBlockEntryCount(u32 pc)
 {
-	u32 inpage_ptr = HWADDR(startpc);
+	if (s_tier1Blocks.find(HWADDR(pc)) != s_tier1Blocks.end())
+		return EE_TIER1_THRESHOLD;
+
+	const BASEBLOCKEX* block = recBlocks.Get(HWADDR(pc));
+	if (!block || block->startpc != HWADDR(pc) || !block->counter)
+		return 0;
+
+	return static_cast<u16>(*block->counter - static_cast<u16>(0x10000 - EE_TIER1_THRESHOLD));
+}
+
+// Marks every register as live, as at the end of a block.
+static void recMarkAllLive(EEINST* pinst)
+{
+	for (u8& reg : pinst->regs)
+		reg |= EEINST_LIVE;
+	for (u8& reg : pinst->fpuregs)
+		reg |= EEINST_LIVE;
+	for (u8& reg : pinst->vfregs)
+		reg |= EEINST_LIVE;
+	for (u8& reg : pinst->viregs)
+		reg |= EEINST_LIVE;
+}
+
+// Decides whether the superblock being formed carries on past the conditional branch at branchpc.
+static bool recTryExtendTrace(u32 branchpc, u32 target, bool has_cop2)
+{
+	if (!s_nBlockTier1 || s_traceExitCount == EE_TRACE_MAX_EXITS)
+		return false;
+
+	// Both paths go to the same place, or the delay slot is in the next page.
+	if (target == branchpc + 8 || ((branchpc + 4) & 0xffc) == 0)
+		return false;
+
+	// The COP2 passes only commit flags at the end of the block, which a side exit would skip.
+	const u32 delay_slot_op = *(u32*)PSM(branchpc + 4) >> 26;
+	if (has_cop2 || delay_slot_op == 022 || delay_slot_op == 066 || delay_slot_op == 076)
+		return false;
+
+	// Prefer the entry counts of the successors. Without them, backward branches are assumed to
+	// be loops and forward branches to be skipping rarely executed code.
+	const u32 taken = recGetBlockEntryCount(target);
+	const u32 fallthrough = recGetBlockEntryCount(branchpc + 8);
+	if ((taken | fallthrough) ? (fallthrough <= taken) : (target <= branchpc))
+		return false;
+
+	s_traceExits[s_traceExitCount++] = branchpc;
+	return true;
+}
+
+// Emits the pre-execution integrity check of a block under manual protection. startpc must be
+// the block's physical address.
+static void recEmitManualBlockCheck(u32 startpc, u32 size, bool counted)
+{
+	const u32 inpage_ptr = startpc;
 	const u32 inpage_sz = size * 4;
 
+	xMOV(arg1regd, inpage_ptr);
+	xMOV(arg2regd, inpage_sz / 4);
+	//xMOV( eax, startpc );		// uncomment this to access startpc (as eax) in dyna_block_discard
+
+	u32 lpc = inpage_ptr;
+	u32 stg = inpage_sz;
+
+	while (stg > 0)
+	{
+		xCMP(ptr32[PSM(lpc)], *(u32*)PSM(lpc));
+		xJNE(DispatchBlockDiscard);
+
+		stg -= 4;
+		lpc += 4;
+	}
+
+	if (counted)
+	{
+		// Counted blocks add a weighted (by block size) value into manual_page each time they're
+		// run.  If the block gets run a lot, it resets and re-protects itself in the hope
+		// that whatever forced it to be manually-checked before was a 1-time deal.
+
+		// fixme? Currently this algo is kinda dumb and results in the forced recompilation of a
+		// lot of blocks before it decides to mark a 'busy' page as uncounted.  There might be
+		// be a more clever approach that could streamline this process, by doing a first-pass
+		// test using the vtlb memory protection (without recompilation!) to reprotect a counted
+		// block.  But unless a new algo is relatively simple in implementation, it's probably
+		// not worth the effort (tests show that we have lots of recompiler memory to spare, and
+		// that the current amount of recompilation is fairly cheap).
+
+		xADD(ptr16[&manual_page[inpage_ptr >> 12]], size);
+		xJC(DispatchPageReset);
+
+		eeRecPerfLog.Write("Manual block @ %08X : size =%3d  page/offs = 0x%05X/0x%03X  inpgsz = %d  writes = %d",
+			startpc, size, inpage_ptr >> 12, inpage_ptr & 0xfff, inpage_sz, mmap_GetRecentCodeWrites(inpage_ptr));
+	}
+	else
+	{
+		eeRecPerfLog.Write("Uncounted Manual block @ 0x%08X : size =%3d page/offs = 0x%05X/0x%03X  inpgsz = %d",
+			startpc, size, inpage_ptr >> 12, inpage_ptr & 0xfff, inpage_sz);
+	}
+}
+
+static void memory_protect_recompiled_code(u32 startpc, u32 size)
+{
+	const u32 inpage_ptr = HWADDR(startpc);
+
 	// The kernel context register is stored @ 0x800010C0-0x80001300
 	// The EENULL thread context register is stored @ 0x81000-....
 	const bool contains_thread_stack = ((startpc >> 12) == 0x81) || ((startpc >> 12) == 0x80001);
@@ -2028,67 +2267,102 @@ static void memory_protect_recompiled_code(u32 startpc, u32 size)
 
 		case ProtMode_None:
 		case ProtMode_Write:
+			mmap_RecordBlockCompile(inpage_ptr);
 			mmap_MarkCountedRamPage(inpage_ptr);
 			manual_page[inpage_ptr >> 12] = 0;
 			break;
 
 		case ProtMode_Manual:
-			xMOV(arg1regd, inpage_ptr);
-			xMOV(arg2regd, inpage_sz / 4);
-			//xMOV( eax, startpc );		// uncomment this to access startpc (as eax) in dyna_block_discard
+			// Tweakpoint!  SMC_MAX_COUNTED_WRITES is a 'magic' number representing the number of
+			// times a page's code can be written, before the recompiler gives up and sets blocks up
+			// as uncounted (permanent) manual blocks.  Higher thresholds result in more recompilations
+			// for blocks that share code and data on the same page.  The write count decays, so pages
+			// which only see the odd overlay load go back to being counted.
+			mmap_RecordBlockCompile(inpage_ptr);
+			recEmitManualBlockCheck(inpage_ptr, size,
+				!contains_thread_stack && mmap_GetRecentCodeWrites(inpage_ptr) <= SMC_MAX_COUNTED_WRITES);
+			break;
+	}
+}
 
-			u32 lpc = inpage_ptr;
-			u32 stg = inpage_sz;
+// Called by the page fault handler when code in a write-protected page is about to be written.
+// Blocks overlapping the recently written sub-pages are cleared. The rest of the page keeps its
+// code, behind the same integrity check as a manual block, instead of being recompiled.
+void recClearPageWrite(u32 paddr)
+{
+	const u32 page = HWADDR(paddr) & ~0xfffu;
+	const u16 dirty = mmap_GetCodeDirtyMask(page);
 
-			while (stg > 0)
-			{
-				xCMP(ptr32[PSM(lpc)], *(u32*)PSM(lpc));
-				xJNE(DispatchBlockDiscard);
+	// Patches write to memory while a block is being compiled, don't emit anything in the middle of it.
+	if (s_pCurBlockEx || dirty == 0xffff || (recPtr + _64kb) >= recPtrEnd)
+	{
+		recClear(page, 0x400);
+		return;
+	}
 
-				stg -= 4;
-				lpc += 4;
-			}
+	struct PageBlock
+	{
+		u32 startpc;
+		u32 size;
+		uptr fnptr;
+	};
+	static PageBlock s_kept[0x400];
+	static PageBlock s_cleared[0x400];
+	u32 num_kept = 0;
+	u32 num_cleared = 0;
 
-			// Tweakpoint!  3 is a 'magic' number representing the number of times a counted block
-			// is re-protected before the recompiler gives up and sets it up as an uncounted (permanent)
-			// manual block.  Higher thresholds result in more recompilations for blocks that share code
-			// and data on the same page.  Side effects of a lower threshold: over extended gameplay
-			// with several map changes, a game's overall performance could degrade.
+	// Work out what to keep first, clearing blocks moves the rest around.
+	for (int i = recBlocks.LastIndex(page + 0xffc); i >= 0; i--)
+	{
+		const BASEBLOCKEX* block = recBlocks[i];
+		const u32 blockend = block->startpc + block->size * 4;
+		if (blockend <= page)
+			break;
 
-			// (ideally, perhaps, manual_counter should be reset to 0 every few minutes?)
+		u16 block_mask = 0;
+		if (block->startpc >= page && blockend <= page + 0x1000)
+		{
+			for (u32 sub = (block->startpc & 0xfff) >> 8; sub <= ((blockend - 4) & 0xfff) >> 8; sub++)
+				block_mask |= static_cast<u16>(1u << sub);
+		}
 
-			if (!contains_thread_stack && manual_counter[inpage_ptr >> 12] <= 3)
-			{
-				// Counted blocks add a weighted (by block size) value into manual_page each time they're
-				// run.  If the block gets run a lot, it resets and re-protects itself in the hope
-				// that whatever forced it to be manually-checked before was a 1-time deal.
-
-				// Counted blocks have a secondary threshold check in manual_counter, which forces a block
-				// to 'uncounted' mode if it's recompiled several times.  This protects against excessive
-				// recompilation of blocks that reside on the same codepage as data.
-
-				// fixme? Currently this algo is kinda dumb and results in the forced recompilation of a
-				// lot of blocks before it decides to mark a 'busy' page as uncounted.  There might be
-				// be a more clever approach that could streamline this process, by doing a first-pass
-				// test using the vtlb memory protection (without recompilation!) to reprotect a counted
-				// block.  But unless a new algo is relatively simple in implementation, it's probably
-				// not worth the effort (tests show that we have lots of recompiler memory to spare, and
-				// that the current amount of recompilation is fairly cheap).
-
-				xADD(ptr16[&manual_page[inpage_ptr >> 12]], size);
-				xJC(DispatchPageReset);
-
-				// note: clearcnt is measured per-page, not per-block!
-				eeRecPerfLog.Write("Manual block @ %08X : size =%3d  page/offs = 0x%05X/0x%03X  inpgsz = %d  clearcnt = %d",
-					startpc, size, inpage_ptr >> 12, inpage_ptr & 0xfff, inpage_sz, manual_counter[inpage_ptr >> 12]);
-			}
-			else
-			{
-				eeRecPerfLog.Write("Uncounted Manual block @ 0x%08X : size =%3d page/offs = 0x%05X/0x%03X  inpgsz = %d",
-					startpc, size, inpage_ptr >> 12, inpage_ptr & 0xfff, inpage_sz);
-			}
-			break;
+		if (block_mask != 0 && !(block_mask & dirty) && num_kept < std::size(s_kept))
+			s_kept[num_kept++] = {block->startpc, block->size, block->fnptr};
+		else if (num_cleared < std::size(s_cleared))
+			s_cleared[num_cleared++] = {block->startpc, block->size, block->fnptr};
+		else
+		{
+			recClear(page, 0x400);
+			return;
+		}
 	}
+
+	for (u32 i = 0; i < num_cleared; i++)
+		recClear(s_cleared[i].startpc, s_cleared[i].size);
+
+	// We might have interrupted another emitter, e.g. a DMA during the IOP recompiler.
+	u8* const old_ptr = xGetPtr();
+
+	for (u32 i = 0; i < num_kept; i++)
+	{
+		const PageBlock& kept = s_kept[i];
+		const BASEBLOCKEX* block = recBlocks.Get(kept.startpc);
+		if (!block || block->startpc != kept.startpc || block->fnptr != kept.fnptr)
+			continue;
+
+		u8* thunk = recBeginThunk();
+		recEmitManualBlockCheck(kept.startpc, kept.size, mmap_GetRecentCodeWrites(page) <= SMC_MAX_COUNTED_WRITES);
+		xJMP((void*)kept.fnptr);
+		recEndThunk();
+
+		recBlocks.Relink(kept.startpc, (uptr)thunk);
+		PC_GETBLOCK(kept.startpc)->SetFnptr((uptr)thunk);
+	}
+
+	xSetPtr(old_ptr);
+
+	eeRecPerfLog.Write(Color_StrongGray, "SMC write @ 0x%08X : kept %u blocks, cleared %u  dirty = %04X",
+		paddr, num_kept, num_cleared, dirty);
 }
 
 // Skip MPEG Game-Fix
@@ -2171,6 +2445,39 @@ static bool recSkipTimeoutLoop(s32 reg, bool is_timeout_loop)
 	return true;
 }
 
+static const u8* recGetBlockProfileCode(u32 startpc, u32 size)
+{
+	if (HWADDR(startpc) >= Ps2MemSize::ExposedRam || size > ((Ps2MemSize::ExposedRam - HWADDR(startpc)) / 4))
+		return nullptr;
+
+	return static_cast<const u8*>(PSM(startpc));
+}
+
+static bool recPrecompileBlock(u32 startpc)
+{
+	// Leave room for blocks the profile doesn't know about, we can't reset from here.
+	if (recPtr >= (recPtrEnd - _16mb))
+		return false;
+
+	const uptr fnptr = PC_GETBLOCK(startpc)->GetFnptr();
+	if (fnptr == (uptr)JITCompile || fnptr == (uptr)JITCompileInBlock)
+		recRecompile(startpc);
+
+	return true;
+}
+
+static void recPrecompileProfileBlocks()
+{
+	// Code that isn't loaded yet (overlays) is retried about once per frame.
+	if ((cpuRegs.cycle - s_blockProfileLastAttempt) < (PS2CLK / 60))
+		return;
+
+	s_blockProfileLastAttempt = cpuRegs.cycle;
+	s_blockProfilePrecompiling = true;
+	g_eeBlockProfile.Precompile(recGetBlockProfileCode, recPrecompileBlock);
+	s_blockProfilePrecompiling = false;
+}
+
 static void recRecompile(const u32 startpc)
 {
 	u32 i = 0;
@@ -2191,6 +2498,16 @@ static void recRecompile(const u32 startpc)
 		recResetRaw();
 	}
 
+	if (g_eeBlockProfile.HasPending() && !s_blockProfilePrecompiling)
+	{
+		recPrecompileProfileBlocks();
+
+		// The block we were asked for may have been in the profile.
+		const uptr fnptr = PC_GETBLOCK(startpc)->GetFnptr();
+		if (fnptr != (uptr)JITCompile && fnptr != (uptr)JITCompileInBlock)
+			return;
+	}
+
 	xSetPtr(recPtr);
 	recPtr = xGetAlignedCallTarget();
 
@@ -2205,6 +2522,8 @@ static void recRecompile(const u32 startpc)
 
 	pxAssert(s_pCurBlockEx);
 
+	s_nBlockTier1 = !s_tier1Blocks.empty() && s_tier1Blocks.find(HWADDR(startpc)) != s_tier1Blocks.end();
+
 	if (HWADDR(startpc) == EELOAD_START)
 	{
 		// The EELOAD _start function is the same across all BIOS versions
@@ -2272,6 +2591,11 @@ static void recRecompile(const u32 startpc)
 	i = startpc;
 	s_nEndBlock = 0xffffffff;
 	s_branchTo = -1;
+	s_traceExitCount = 0;
+	s_traceJoinPC = 0;
+	s_traceJoined = false;
+	s_perfInsts.clear();
+	s_perfRecordInsts = Perf::IsJitDumpEnabled();
 
 	// Timeout loop speedhack.
 	// God of War 2 and other games (e.g. NFS series) have these timeout loops which just spin for a few thousand
@@ -2293,6 +2617,37 @@ static void recRecompile(const u32 startpc)
 	s32 timeout_reg = -1;
 	bool is_timeout_loop = true;
 
+	// Where execution can continue statically after the block, used by the tier 1 passes.
+	u32 successors[2];
+	u32 num_successors = 0;
+	const auto set_branch_successors = [&successors, &num_successors]() {
+		if (s_nEndBlock == s_branchTo)
+		{
+			successors[0] = s_nEndBlock;
+			num_successors = 1;
+		}
+		else
+		{
+			successors[0] = s_branchTo;
+			successors[1] = s_nEndBlock;
+			num_successors = 2;
+		}
+	};
+
+	// Start of the last superblock segment, loops are only split inside it.
+	u32 segstart = startpc;
+	bool trace_has_cop2 = false;
+	const auto extend_trace = [&i, &segstart, &trace_has_cop2, &is_timeout_loop]() {
+		if (!recTryExtendTrace(i, s_branchTo, trace_has_cop2))
+			return false;
+
+		i += 8;
+		segstart = i;
+		s_branchTo = -1;
+		is_timeout_loop = false;
+		return true;
+	};
+
 	// compile breakpoints as individual blocks
 	const int n1 = isBreakpointNeeded(i);
 	const int n2 = isMemcheckNeeded(i);
@@ -2320,21 +2675,27 @@ static void recRecompile(const u32 startpc)
 			{
 				willbranch3 = 1;
 				s_nEndBlock = i;
+				successors[0] = i;
+				num_successors = 1;
 
 				eeRecPerfLog.Write("Pagesplit @ %08X : size=%d insts", startpc, (i - startpc) / 4);
 				break;
 			}
 
-			if (pblock->GetFnptr() != (uptr)JITCompile && pblock->GetFnptr() != (uptr)JITCompileInBlock)
+			// Hot blocks carry on through other blocks, so registers stay cached across the join.
+			if (!s_nBlockTier1 && pblock->GetFnptr() != (uptr)JITCompile && pblock->GetFnptr() != (uptr)JITCompileInBlock)
 			{
 				willbranch3 = 1;
 				s_nEndBlock = i;
+				successors[0] = i;
+				num_successors = 1;
 				break;
 			}
 		}
 
 		//HUH ? PSM ? whut ? THIS IS VIRTUAL ACCESS GOD DAMMIT
 		cpuRegs.code = *(int*)PSM(i);
+		trace_has_cop2 |= (_Opcode_ == 022 || _Opcode_ == 066 || _Opcode_ == 076);
 
 		if (is_timeout_loop)
 		{
@@ -2379,11 +2740,15 @@ static void recRecompile(const u32 startpc)
 				{
 					// branches
 					s_branchTo = _Imm_ * 4 + i + 4;
-					if (s_branchTo > startpc && s_branchTo < i)
+					if (extend_trace())
+						continue;
+
+					if (s_branchTo > segstart && s_branchTo < i)
 						s_nEndBlock = s_branchTo;
 					else
 						s_nEndBlock = i + 8;
 
+					set_branch_successors();
 					goto StartRecomp;
 				}
 				break;
@@ -2392,6 +2757,8 @@ static void recRecompile(const u32 startpc)
 			case 3: // JAL
 				s_branchTo = (_InstrucTarget_ << 2) | ((i + 4) & 0xf0000000);
 				s_nEndBlock = i + 8;
+				successors[0] = s_branchTo;
+				num_successors = 1;
 				goto StartRecomp;
 
 			// branches
@@ -2404,11 +2771,15 @@ static void recRecompile(const u32 startpc)
 			case 22:
 			case 23:
 				s_branchTo = _Imm_ * 4 + i + 4;
-				if (s_branchTo > startpc && s_branchTo < i)
+				if (extend_trace())
+					continue;
+
+				if (s_branchTo > segstart && s_branchTo < i)
 					s_nEndBlock = s_branchTo;
 				else
 					s_nEndBlock = i + 8;
 
+				set_branch_successors();
 				goto StartRecomp;
 
 			case 16: // cp0
@@ -2430,11 +2801,15 @@ static void recRecompile(const u32 startpc)
 					// BC1F, BC1T, BC1FL, BC1TL
 					// BC2F, BC2T, BC2FL, BC2TL
 					s_branchTo = _Imm_ * 4 + i + 4;
-					if (s_branchTo > startpc && s_branchTo < i)
+					if (extend_trace())
+						continue;
+
+					if (s_branchTo > segstart && s_branchTo < i)
 						s_nEndBlock = s_branchTo;
 					else
 						s_nEndBlock = i + 8;
 
+					set_branch_successors();
 					goto StartRecomp;
 				}
 				break;
@@ -2450,7 +2825,7 @@ StartRecomp:
 	// which alter the machine state apart from registers, it will do the same thing on every
 	// iteration.
 	s_nBlockFF = false;
-	if (s_branchTo == startpc)
+	if (s_branchTo == startpc && s_traceExitCount == 0)
 	{
 		s_nBlockFF = true;
 
@@ -2550,6 +2925,11 @@ StartRecomp:
 		for (i = s_nEndBlock; i > startpc; i -= 4)
 		{
 			cpuRegs.code = *(int*)PSM(i - 4);
+
+			// Anything can be read after a side exit, which is after the branch or its delay slot.
+			if (s_traceExitCount > 0 && (recIsTraceExit(i - 4) || recIsTraceExit(i - 8)))
+				recMarkAllLive(pcur);
+
 			pcur[-1] = pcur[0];
 			recBackpropBSC(cpuRegs.code, pcur - 1, pcur);
 			pcur--;
@@ -2564,7 +2944,12 @@ StartRecomp:
 		COP2MicroFinishPass().Run(startpc, s_nEndBlock, s_pInstCache + 1);
 
 		if (EmuConfig.Speedhacks.vuFlagHack)
-			COP2FlagHackPass().Run(startpc, s_nEndBlock, s_pInstCache + 1);
+		{
+			COP2FlagHackPass pass;
+			if (s_nBlockTier1)
+				pass.SetSuccessors(successors, num_successors);
+			pass.Run(startpc, s_nEndBlock, s_pInstCache + 1);
+		}
 	}
 
 #ifdef DUMP_BLOCKS
@@ -2587,6 +2972,9 @@ StartRecomp:
 #endif
 #endif
 
+	if (s_traceExitCount > 0)
+		eeRecPerfLog.Write("Superblock @ %08X : size=%d insts, %u side exits", startpc, (s_nEndBlock - startpc) / 4, s_traceExitCount);
+
 	// Detect and handle self-modified code
 	memory_protect_recompiled_code(startpc, (s_nEndBlock - startpc) >> 2);
 
@@ -2595,10 +2983,27 @@ StartRecomp:
 
 	if (doRecompilation)
 	{
+		// Count entries into tier 0 blocks, promoting them once the counter overflows.
+		if (EmuConfig.Cpu.Recompiler.EnableEETiering && !s_nBlockTier1 &&
+			HWADDR(startpc) < Ps2MemSize::ExposedRam && tier_counters_used < std::size(tier_counter))
+		{
+			u16* counter = &tier_counter[tier_counters_used++];
+			*counter = static_cast<u16>(0x10000 - EE_TIER1_THRESHOLD);
+			s_pCurBlockEx->counter = counter;
+			xADD(ptr16[counter], 1);
+			xForwardJAE8 not_hot;
+			xMOV(ptr32[&cpuRegs.pc], startpc);
+			xMOV(arg1regd, startpc);
+			xJMP(DispatchBlockPromote);
+			not_hot.SetTarget();
+		}
+
 		// Finally: Generate x86 recompiled code!
 		g_pCurInstInfo = s_pInstCache;
 		while (!g_branch && pc < s_nEndBlock)
 		{
+			s_traceJoinPC = (s_traceExitCount > 0 && recIsTraceExit(pc)) ? (pc + 8) : 0;
+
 #ifdef DUMP_BLOCKS
 			if (dump_block)
 			{
@@ -2628,7 +3033,11 @@ StartRecomp:
 #else
 			recompileNextInstruction(false, false); // For the love of recursion, batman!
 #endif
+
+			if (s_traceJoined)
+				recTraceContinue(startpc);
 		}
+		s_traceJoinPC = 0;
 	}
 
 	pxAssert((pc - startpc) >> 2 <= 0xffff);
@@ -2660,6 +3069,7 @@ StartRecomp:
 		}
 
 		memcpy(&recRAMCopy[HWADDR(startpc) / 4], PSM(startpc), pc - startpc);
+		g_eeBlockProfile.Record(startpc, s_pCurBlockEx->size, static_cast<const u8*>(PSM(startpc)));
 	}
 
 	s_pCurBlock->SetFnptr((uptr)recPtr);
@@ -2722,7 +3132,9 @@ StartRecomp:
 		iDumpBlock(s_pCurBlockEx->startpc, s_pCurBlockEx->size*4, s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size);
 	}
 #endif
-	Perf::ee.RegisterPC((void*)s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size, s_pCurBlockEx->startpc);
+	Perf::ee.RegisterBlock((void*)s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size, s_pCurBlockEx->startpc,
+		s_perfInsts.data(), s_perfInsts.size(), recDisassembleForPerf);
+	s_perfRecordInsts = false;
 
 	recPtr = xGetPtr();
 
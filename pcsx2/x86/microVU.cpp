@@ -7,6 +7,8 @@
 #include "common/Perf.h"
 #include "common/StringUtil.h"
 
+#include <bit>
+
 //------------------------------------------------------------------
 // Micro VU - Main Functions
 //------------------------------------------------------------------
@@ -42,6 +44,9 @@ void mVUreset(microVU& mVU, bool resetReserve)
 		VU0.VI[REG_VPU_STAT].UL &= ~0x100;
 	}
 
+	if (mVU.prog.x86ptr)
+		(mVU.index ? Perf::vu1 : Perf::vu0).Unregister(mVU.cache, mVU.prog.x86ptr - mVU.cache);
+
 	xSetPtr(mVU.cache);
 	mVUdispatcherAB(mVU);
 	mVUdispatcherCD(mVU);
@@ -64,11 +69,15 @@ void mVUreset(microVU& mVU, bool resetReserve)
 	mVU.prog.x86start = xGetAlignedCallTarget();
 	mVU.prog.x86ptr   = mVU.prog.x86start;
 
+	// Micro memory may have been changed without going through mVUclear (e.g. state load)
+	std::memset(mVU.prog.chunkDirty, 0xff, sizeof(mVU.prog.chunkDirty));
+
 	for (u32 i = 0; i < (mVU.progSize / 2); i++)
 	{
 		if (!mVU.prog.prog[i])
 		{
 			mVU.prog.prog[i] = new std::deque<microProgram*>();
+			mVU.prog.index[i] = new microProgramIndex();
 			continue;
 		}
 		std::deque<microProgram*>::iterator it(mVU.prog.prog[i]->begin());
@@ -77,6 +86,8 @@ void mVUreset(microVU& mVU, bool resetReserve)
 			mVUdeleteProg(mVU, it[0]);
 		}
 		mVU.prog.prog[i]->clear();
+		mVU.prog.index[i]->layouts.clear();
+		mVU.prog.index[i]->dirty.clear();
 		mVU.prog.quick[i].block = NULL;
 		mVU.prog.quick[i].prog = NULL;
 	}
@@ -96,12 +107,22 @@ void mVUclose(microVU& mVU)
 			mVUdeleteProg(mVU, it[0]);
 		}
 		safe_delete(mVU.prog.prog[i]);
+		safe_delete(mVU.prog.index[i]);
 	}
 }
 
 // Clears Block Data in specified range
 __fi void mVUclear(mV, u32 addr, u32 size)
 {
+	// The data is written after this call, so just flag the hashes for recalculation on the next search
+	if (size > 0 && addr < mVU.microMemSize)
+	{
+		const u32 first = addr / (mVUhashChunkWords * 4);
+		const u32 last = (std::min(addr + size, mVU.microMemSize) - 1) / (mVUhashChunkWords * 4);
+		for (u32 i = first; i <= last; i++)
+			mVU.prog.chunkDirty[i / 64] |= static_cast<u64>(1) << (i % 64);
+	}
+
 	if (!mVU.prog.cleared)
 	{
 		mVU.prog.cleared = 1; // Next execution searches/creates a new microprogram
@@ -137,6 +158,7 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC)
 	prog->idx = mVU.prog.total++;
 	prog->ranges = new std::deque<microRange>();
 	prog->startPC = startPC;
+	mVUmarkProgDirty(mVU, *prog);
 	if(doWholeProgCompare)
 		mVUcacheProg(mVU, *prog); // Cache Micro Program
 	double cacheSize = (double)((uptr)mVU.prog.x86end - (uptr)mVU.prog.x86start);
@@ -163,9 +185,158 @@ __ri void mVUcacheProg(microVU& mVU, microProgram& prog)
 		else
 			memcpy(prog.data, mVU.regs().Micro, 0x4000);
 	}
+	mVUmarkProgDirty(mVU, prog);
 	mVUdumpProg(mVU, prog);
 }
 
+//------------------------------------------------------------------
+// Micro VU - Program Index
+//------------------------------------------------------------------
+
+// Hashes a word of micro memory together with its position. Range hashes are the sum of their words,
+// so they can be built from the cached per-chunk sums of the current micro memory.
+static __fi u64 mVUhashWord(u32 pos, u32 word)
+{
+	u64 h = (static_cast<u64>(pos) << 32) | word;
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+	return h ^ (h >> 31);
+}
+
+// Queues a program to be (re)indexed, called when its ranges or data change
+void mVUmarkProgDirty(microVU& mVU, microProgram& prog)
+{
+	if (prog.indexDirty)
+		return;
+	prog.indexDirty = true;
+	mVU.prog.index[prog.startPC]->dirty.push_back(&prog);
+}
+
+// Gets the valid ranges of a program in a canonical order, matching what mVUcmpProg compares
+static void mVUgetProgRanges(microVU& mVU, const microProgram& prog, std::vector<microRange>& ranges)
+{
+	ranges.clear();
+	if (doWholeProgCompare)
+	{
+		ranges.push_back({0, static_cast<s32>(mVU.microMemSize)});
+		return;
+	}
+
+	for (const microRange& range : *prog.ranges)
+	{
+		const s32 end = std::min<s32>(range.end, mVU.microMemSize);
+		if (range.start >= 0 && end > range.start)
+			ranges.push_back({range.start, end});
+	}
+	std::sort(ranges.begin(), ranges.end(), [](const microRange& lhs, const microRange& rhs) {
+		return (lhs.start != rhs.start) ? (lhs.start < rhs.start) : (lhs.end < rhs.end);
+	});
+}
+
+// Recalculates the hashes of micro memory chunks written since the last search
+static void mVUupdateChunkHashes(microVU& mVU)
+{
+	const u32* micro = reinterpret_cast<const u32*>(mVU.regs().Micro);
+	const u32 numChunks = mVU.microMemSize / (mVUhashChunkWords * 4);
+	for (u32 i = 0; i < std::size(mVU.prog.chunkDirty); i++)
+	{
+		u64 bits = mVU.prog.chunkDirty[i];
+		mVU.prog.chunkDirty[i] = 0;
+		for (; bits != 0; bits &= bits - 1)
+		{
+			const u32 chunk = i * 64 + std::countr_zero(bits);
+			if (chunk >= numChunks)
+				break;
+
+			u64 hash = 0;
+			for (u32 pos = chunk * mVUhashChunkWords; pos < (chunk + 1) * mVUhashChunkWords; pos++)
+				hash += mVUhashWord(pos, micro[pos]);
+			mVU.prog.chunkHash[chunk] = hash;
+		}
+	}
+}
+
+// Hashes the current micro memory over the given ranges, chunk hashes must be up to date
+static u64 mVUhashMicroRanges(microVU& mVU, const std::vector<microRange>& ranges)
+{
+	const u32* micro = reinterpret_cast<const u32*>(mVU.regs().Micro);
+	u64 hash = 0;
+	for (const microRange& range : ranges)
+	{
+		u32 pos = range.start / 4;
+		const u32 end = range.end / 4;
+		for (; pos < end && (pos % mVUhashChunkWords) != 0; pos++)
+			hash += mVUhashWord(pos, micro[pos]);
+		for (; (pos + mVUhashChunkWords) <= end; pos += mVUhashChunkWords)
+			hash += mVU.prog.chunkHash[pos / mVUhashChunkWords];
+		for (; pos < end; pos++)
+			hash += mVUhashWord(pos, micro[pos]);
+	}
+	return hash;
+}
+
+static void mVUunindexProg(microProgramIndex& index, microProgram& prog)
+{
+	for (auto layout = index.layouts.begin(); layout != index.layouts.end(); ++layout)
+	{
+		if (layout->sig != prog.rangeSig)
+			continue;
+
+		auto [begin, end] = layout->progs.equal_range(prog.hash);
+		for (auto it = begin; it != end; ++it)
+		{
+			if (it->second != &prog)
+				continue;
+
+			layout->progs.erase(it);
+			if (layout->progs.empty())
+				index.layouts.erase(layout);
+			prog.indexed = false;
+			return;
+		}
+	}
+}
+
+// Moves programs whose ranges changed since the last search to the right place in the index
+static void mVUindexDirtyProgs(microVU& mVU, microProgramIndex& index)
+{
+	std::vector<microRange> ranges;
+	for (microProgram* prog : index.dirty)
+	{
+		if (prog->indexed)
+			mVUunindexProg(index, *prog);
+
+		mVUgetProgRanges(mVU, *prog, ranges);
+
+		u64 sig = 0, hash = 0;
+		for (const microRange& range : ranges)
+		{
+			sig += mVUhashWord(range.start, range.end);
+			for (s32 pos = range.start / 4; pos < range.end / 4; pos++)
+				hash += mVUhashWord(pos, prog->data[pos]);
+		}
+
+		auto layout = std::find_if(index.layouts.begin(), index.layouts.end(), [sig, &ranges](const microProgramLayout& l) {
+			return (l.sig == sig && l.ranges.size() == ranges.size() &&
+					std::equal(ranges.begin(), ranges.end(), l.ranges.begin(), [](const microRange& lhs, const microRange& rhs) {
+						return (lhs.start == rhs.start && lhs.end == rhs.end);
+					}));
+		});
+		if (layout == index.layouts.end())
+		{
+			index.layouts.push_back({sig, ranges, {}});
+			layout = index.layouts.end() - 1;
+		}
+
+		layout->progs.emplace(hash, prog);
+		prog->rangeSig = sig;
+		prog->hash = hash;
+		prog->indexed = true;
+		prog->indexDirty = false;
+	}
+	index.dirty.clear();
+}
+
 // Generate Hash for partial program based on compiled ranges...
 u64 mVUrangesHash(microVU& mVU, microProgram& prog)
 {
@@ -219,6 +390,7 @@ __fi bool mVUcmpProg(microVU& mVU, microProgram& prog)
 {
 	if (doWholeProgCompare)
 	{
+		mVU.profiler.OnProgCompare(mVU.microMemSize);
 		if (memcmp((u8*)prog.data, mVU.regs().Micro, mVU.microMemSize))
 			return false;
 	}
@@ -232,6 +404,7 @@ __fi bool mVUcmpProg(microVU& mVU, microProgram& prog)
 #endif
 			auto cmpOffset = [&](void* x) { return (u8*)x + range.start; };
 
+			mVU.profiler.OnProgCompare(range.end - range.start);
 			if (memcmp(cmpOffset(prog.data), cmpOffset(mVU.regs().Micro), (range.end - range.start)))
 				return false;
 		}
@@ -251,17 +424,24 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState)
 
 	if (!quick.prog) // If null, we need to search for new program
 	{
-		std::deque<microProgram*>::iterator it(list->begin());
-		for (; it != list->end(); ++it)
+		microProgramIndex& index = *mVU.prog.index[mVU.regs().start_pc / 8];
+		mVUupdateChunkHashes(mVU);
+		if (!index.dirty.empty())
+			mVUindexDirtyProgs(mVU, index);
+
+		// Any program which matches must have the same hash over its ranges, so we only need to compare
+		// against programs in each layout whose hash matches the current micro memory.
+		for (const microProgramLayout& layout : index.layouts)
 		{
-			bool b = mVUcmpProg(mVU, *it[0]);
-
-			if (b)
+			auto [begin, end] = layout.progs.equal_range(mVUhashMicroRanges(mVU, layout.ranges));
+			for (auto it = begin; it != end; ++it)
 			{
-				quick.block = it[0]->block[startPC / 8];
-				quick.prog  = it[0];
-				list->erase(it);
-				list->push_front(quick.prog);
+				if (!mVUcmpProg(mVU, *it->second))
+					continue;
+
+				mVU.profiler.OnProgSearch(true);
+				quick.block = it->second->block[startPC / 8];
+				quick.prog  = it->second;
 
 				// Sanity check, in case for some reason the program compilation aborted half way through (JALR for example)
 				if (quick.block == nullptr)
@@ -273,6 +453,8 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState)
 			}
 		}
 
+		mVU.profiler.OnProgSearch(false);
+
 		// If cleared and program not found, make a new program instance
 		mVU.prog.cleared = 0;
 		mVU.prog.isSame  = 1;
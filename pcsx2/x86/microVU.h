@@ -9,6 +9,8 @@
 #include <deque>
 #include <algorithm>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "Common.h"
 #include "VU.h"
 #include "MTVU.h"
@@ -50,10 +52,32 @@ struct microProgram
 	std::deque<microRange>* ranges;          // The ranges of the microProgram that have already been recompiled
 	u32 startPC; // Start PC of this program
 	int idx;     // Program index
+	u64 hash;    // Hash of data[] over the recompiled ranges (key in microProgramIndex)
+	u64 rangeSig;    // Hash of the range bounds, identifies the layout the program is indexed under
+	bool indexed;    // Program is in its layout's hash table
+	bool indexDirty; // Ranges or data changed since the program was indexed
 };
 
 typedef std::deque<microProgram*> microProgramList;
 
+// Programs with the same startPC and the same recompiled ranges, keyed by the hash of those ranges
+struct microProgramLayout
+{
+	u64 sig;
+	std::vector<microRange> ranges; // Sorted by start
+	std::unordered_multimap<u64, microProgram*> progs;
+};
+
+// Hash index for finding a cached program without comparing against every program in the list
+struct microProgramIndex
+{
+	std::vector<microProgramLayout> layouts;
+	std::vector<microProgram*> dirty; // Programs to (re)index before the next search
+};
+
+static constexpr u32 mVUhashChunkWords = 16;                       // Words per cached micro memory hash chunk
+static constexpr u32 mVUhashChunks     = mProgSize / mVUhashChunkWords; // Number of hash chunks for VU1
+
 struct microProgramQuick
 {
 	microBlockManager* block; // Quick reference to valid microBlockManager for current startPC
@@ -64,6 +88,9 @@ struct microProgManager
 {
 	microIR<mProgSize> IRinfo;             // IR information
 	microProgramList*  prog [mProgSize/2]; // List of microPrograms indexed by startPC values
+	microProgramIndex* index[mProgSize/2]; // Hash index of each list
+	u64                chunkHash [mVUhashChunks];      // Sum of word hashes over each chunk of micro memory
+	u64                chunkDirty[mVUhashChunks / 64]; // Chunks written since their hash was last computed
 	microProgramQuick  quick[mProgSize/2]; // Quick reference to valid microPrograms for current execution
 	microProgram*      cur;                // Pointer to currently running MicroProgram
 	int                total;              // Total Number of valid MicroPrograms
@@ -288,6 +315,7 @@ mVUop(mVUopL);
 // Private Functions
 extern void mVUcacheProg(microVU& mVU, microProgram& prog);
 extern void mVUdeleteProg(microVU& mVU, microProgram*& prog);
+extern void mVUmarkProgDirty(microVU& mVU, microProgram& prog);
 _mVUt extern void* mVUsearchProg(u32 startPC, uptr pState);
 extern void* mVUexecuteVU0(u32 startPC, u32 cycles);
 extern void* mVUexecuteVU1(u32 startPC, u32 cycles);
@@ -92,6 +92,10 @@ struct microProfiler
 {
 	static const u32 progLimit = 10000;
 	u64 opStats[opLastOpcode];
+	u64 searchCount;  // Program searches (after micro memory was written)
+	u64 searchHits;   // Searches which found a cached program
+	u64 compareCount; // Program ranges compared against micro memory
+	u64 compareBytes; // Bytes compared against micro memory
 	u32 progCount;
 	int index;
 	void Reset(int _index)
@@ -104,6 +108,16 @@ struct microProfiler
 		xADD(ptr32[&(((u32*)opStats)[op * 2 + 0])], 1);
 		xADC(ptr32[&(((u32*)opStats)[op * 2 + 1])], 0);
 	}
+	void OnProgSearch(bool found)
+	{
+		searchCount++;
+		searchHits += found;
+	}
+	void OnProgCompare(u32 bytes)
+	{
+		compareCount++;
+		compareBytes += bytes;
+	}
 	void Print()
 	{
 		progCount++;
@@ -129,7 +143,11 @@ struct microProfiler
 				DevCon.WriteLn("%s - [%3.4f%%][count=%u]",
 					str.c_str(), stat, (u32)count);
 			}
-			DevCon.WriteLn("Total = 0x%x%x\n\n", (u32)(u64)(total >> 32), (u32)total);
+			DevCon.WriteLn("Total = 0x%x%x", (u32)(u64)(total >> 32), (u32)total);
+			DevCon.WriteLn("Prog Searches = %llu [hits=%llu] [compares/search=%3.2f] [bytes/search=%3.1f]\n\n",
+				searchCount, searchHits,
+				searchCount ? (double)compareCount / (double)searchCount : 0.0,
+				searchCount ? (double)compareBytes / (double)searchCount : 0.0);
 		}
 	}
 };
@@ -138,6 +156,8 @@ struct microProfiler
 {
 	__fi void Reset(int _index) {}
 	__fi void EmitOp(microOpcode op) {}
+	__fi void OnProgSearch(bool found) {}
+	__fi void OnProgCompare(u32 bytes) {}
 	__fi void Print() {}
 };
 #endif
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
+// SPDX-License-Identifier: GPL-3.0+
+
+#include "common/Pcsx2Defs.h"
+#include "common/LRUCache.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+
+TEST(LRUCache, InsertLookup)
+{
+	LRUCache<int, int> cache(4);
+	ASSERT_EQ(cache.Lookup(1), nullptr);
+
+	cache.Insert(1, 10);
+	cache.Insert(2, 20);
+	ASSERT_EQ(cache.GetSize(), 2u);
+	ASSERT_NE(cache.Lookup(1), nullptr);
+	ASSERT_EQ(*cache.Lookup(1), 10);
+	ASSERT_EQ(*cache.Lookup(2), 20);
+	ASSERT_EQ(cache.Lookup(3), nullptr);
+}
+
+TEST(LRUCache, InsertReplacesExisting)
+{
+	LRUCache<int, int> cache(2);
+	cache.Insert(1, 10);
+	cache.Insert(2, 20);
+	cache.Insert(1, 11);
+	ASSERT_EQ(cache.GetSize(), 2u);
+	ASSERT_EQ(*cache.Lookup(1), 11);
+	ASSERT_EQ(*cache.Lookup(2), 20);
+}
+
+TEST(LRUCache, EvictsLeastRecentlyInserted)
+{
+	LRUCache<int, int> cache(3);
+	cache.Insert(1, 10);
+	cache.Insert(2, 20);
+	cache.Insert(3, 30);
+	cache.Insert(4, 40);
+	ASSERT_EQ(cache.GetSize(), 3u);
+	ASSERT_EQ(cache.Lookup(1), nullptr);
+	ASSERT_NE(cache.Lookup(2), nullptr);
+	ASSERT_NE(cache.Lookup(3), nullptr);
+	ASSERT_NE(cache.Lookup(4), nullptr);
+}
+
+TEST(LRUCache, LookupRefreshesItem)
+{
+	LRUCache<int, int> cache(3);
+	cache.Insert(1, 10);
+	cache.Insert(2, 20);
+	cache.Insert(3, 30);
+
+	// 1 is now the most recent, so 2 should go first.
+	ASSERT_NE(cache.Lookup(1), nullptr);
+	cache.Insert(4, 40);
+	ASSERT_NE(cache.Lookup(1), nullptr);
+	ASSERT_EQ(cache.Lookup(2), nullptr);
+
+	// Re-inserting refreshes too, leaving 4 as the oldest.
+	cache.Insert(3, 31);
+	cache.Insert(1, 11);
+	cache.Insert(5, 50);
+	ASSERT_EQ(cache.Lookup(4), nullptr);
+	ASSERT_EQ(*cache.Lookup(3), 31);
+	ASSERT_EQ(*cache.Lookup(1), 11);
+	ASSERT_EQ(*cache.Lookup(5), 50);
+}
+
+TEST(LRUCache, ReinsertAtCapacityKeepsOthers)
+{
+	LRUCache<int, int> cache(2);
+	cache.Insert(1, 10);
+	cache.Insert(2, 20);
+	cache.Insert(2, 21);
+	ASSERT_EQ(cache.GetSize(), 2u);
+	ASSERT_EQ(*cache.Lookup(1), 10);
+	ASSERT_EQ(*cache.Lookup(2), 21);
+}
+
+TEST(LRUCache, SetMaxCapacityEvictsOldest)
+{
+	LRUCache<int, int> cache(4);
+	for (int i = 0; i < 4; i++)
+		cache.Insert(i, i);
+	ASSERT_NE(cache.Lookup(0), nullptr);
+
+	cache.SetMaxCapacity(2);
+	ASSERT_EQ(cache.GetSize(), 2u);
+	ASSERT_EQ(cache.GetMaxCapacity(), 2u);
+	ASSERT_NE(cache.Lookup(0), nullptr);
+	ASSERT_NE(cache.Lookup(3), nullptr);
+	ASSERT_EQ(cache.Lookup(1), nullptr);
+	ASSERT_EQ(cache.Lookup(2), nullptr);
+}
+
+TEST(LRUCache, ZeroCapacityHoldsOneItem)
+{
+	LRUCache<int, int> cache(0);
+	cache.Insert(1, 10);
+	cache.Insert(2, 20);
+	ASSERT_EQ(cache.GetSize(), 1u);
+	ASSERT_EQ(cache.Lookup(1), nullptr);
+	ASSERT_EQ(*cache.Lookup(2), 20);
+}
+
+TEST(LRUCache, EvictAndRemove)
+{
+	LRUCache<int, int> cache(8);
+	for (int i = 0; i < 5; i++)
+		cache.Insert(i, i);
+
+	cache.Evict(2);
+	ASSERT_EQ(cache.GetSize(), 3u);
+	ASSERT_EQ(cache.Lookup(0), nullptr);
+	ASSERT_EQ(cache.Lookup(1), nullptr);
+
+	ASSERT_TRUE(cache.Remove(3));
+	ASSERT_FALSE(cache.Remove(3));
+	ASSERT_EQ(cache.GetSize(), 2u);
+	ASSERT_EQ(cache.Lookup(3), nullptr);
+
+	cache.Evict(100);
+	ASSERT_EQ(cache.GetSize(), 0u);
+
+	cache.Insert(7, 7);
+	cache.Clear();
+	ASSERT_EQ(cache.GetSize(), 0u);
+	ASSERT_EQ(cache.Lookup(7), nullptr);
+}
+
+TEST(LRUCache, PointersStableAcrossOtherAccesses)
+{
+	LRUCache<int, std::string> cache(16);
+	std::string* first = cache.Insert(1, "one");
+	for (int i = 2; i < 16; i++)
+		cache.Insert(i, std::to_string(i));
+	for (int i = 15; i >= 2; i--)
+		ASSERT_NE(cache.Lookup(i), nullptr);
+
+	ASSERT_EQ(cache.Lookup(1), first);
+	ASSERT_EQ(*first, "one");
+}
+
+TEST(LRUCache, StringKeys)
+{
+	LRUCache<std::string, int> cache(2);
+	cache.Insert("a", 1);
+	cache.Insert("b", 2);
+
+	// Lookups and removals don't need to construct a std::string.
+	ASSERT_EQ(*cache.Lookup(std::string_view("a")), 1);
+	cache.Insert("c", 3);
+	ASSERT_EQ(cache.Lookup(std::string_view("b")), nullptr);
+	ASSERT_TRUE(cache.Remove(std::string_view("a")));
+	ASSERT_EQ(cache.GetSize(), 1u);
+	ASSERT_EQ(*cache.Lookup(std::string_view("c")), 3);
+}
+
+struct LRUCacheTestKey
+{
+	u32 a;
+	u32 b;
+
+	bool operator==(const LRUCacheTestKey& rhs) const { return (a == rhs.a && b == rhs.b); }
+};
+
+struct LRUCacheTestKeyHash
+{
+	size_t operator()(const LRUCacheTestKey& key) const { return (static_cast<size_t>(key.a) << 16) ^ key.b; }
+};
+
+TEST(LRUCache, CustomHash)
+{
+	LRUCache<LRUCacheTestKey, int, LRUCacheTestKeyHash> cache(2);
+	cache.Insert({1, 2}, 12);
+	cache.Insert({2, 1}, 21);
+	ASSERT_EQ(*cache.Lookup(LRUCacheTestKey{1, 2}), 12);
+	cache.Insert({3, 3}, 33);
+	ASSERT_EQ(cache.Lookup(LRUCacheTestKey{2, 1}), nullptr);
+	ASSERT_EQ(*cache.Lookup(LRUCacheTestKey{1, 2}), 12);
+	ASSERT_EQ(*cache.Lookup(LRUCacheTestKey{3, 3}), 33);
+}
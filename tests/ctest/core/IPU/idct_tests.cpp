@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
+// SPDX-License-Identifier: GPL-3.0+
+
+#include "pcsx2/IPU/IPU_MultiISA.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Scalar integer IDCT the vectorised one replaced, row pass and then column pass in place.
+namespace
+{
+	static constexpr int W1 = 2841;
+	static constexpr int W2 = 2676;
+	static constexpr int W3 = 2408;
+	static constexpr int W5 = 1609;
+	static constexpr int W6 = 1108;
+	static constexpr int W7 = 565;
+
+	static void Butterfly(int& t0, int& t1, int w0, int w1, int d0, int d1)
+	{
+		const int tmp = w0 * (d0 + d1);
+		t0 = tmp + (w1 - w0) * d1;
+		t1 = tmp - (w1 + w0) * d0;
+	}
+
+	static void ReferenceIDCT(s16* block)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			s16* const rblock = block + 8 * i;
+			if (!(rblock[1] | rblock[2] | rblock[3] | rblock[4] | rblock[5] | rblock[6] | rblock[7]))
+			{
+				const s16 dc = static_cast<s16>(rblock[0] << 3);
+				for (int j = 0; j < 8; j++)
+					rblock[j] = dc;
+				continue;
+			}
+
+			int a0, a1, a2, a3;
+			{
+				const int d0 = (rblock[0] << 11) + 128;
+				const int d2 = rblock[2] << 11;
+				const int t0 = d0 + d2;
+				const int t1 = d0 - d2;
+				int t2, t3;
+				Butterfly(t2, t3, W6, W2, rblock[3], rblock[1]);
+				a0 = t0 + t2;
+				a1 = t1 + t3;
+				a2 = t1 - t3;
+				a3 = t0 - t2;
+			}
+
+			int b0, b1, b2, b3;
+			{
+				int t0, t1, t2, t3;
+				Butterfly(t0, t1, W7, W1, rblock[7], rblock[4]);
+				Butterfly(t2, t3, W3, W5, rblock[5], rblock[6]);
+				b0 = t0 + t2;
+				b3 = t1 + t3;
+				t0 -= t2;
+				t1 -= t3;
+				b1 = ((t0 + t1) * 181) >> 8;
+				b2 = ((t0 - t1) * 181) >> 8;
+			}
+
+			rblock[0] = static_cast<s16>((a0 + b0) >> 8);
+			rblock[1] = static_cast<s16>((a1 + b1) >> 8);
+			rblock[2] = static_cast<s16>((a2 + b2) >> 8);
+			rblock[3] = static_cast<s16>((a3 + b3) >> 8);
+			rblock[4] = static_cast<s16>((a3 - b3) >> 8);
+			rblock[5] = static_cast<s16>((a2 - b2) >> 8);
+			rblock[6] = static_cast<s16>((a1 - b1) >> 8);
+			rblock[7] = static_cast<s16>((a0 - b0) >> 8);
+		}
+
+		for (int i = 0; i < 8; i++)
+		{
+			s16* const cblock = block + i;
+
+			int a0, a1, a2, a3;
+			{
+				const int d0 = (cblock[8 * 0] << 11) + 65536;
+				const int d2 = cblock[8 * 2] << 11;
+				const int t0 = d0 + d2;
+				const int t1 = d0 - d2;
+				int t2, t3;
+				Butterfly(t2, t3, W6, W2, cblock[8 * 3], cblock[8 * 1]);
+				a0 = t0 + t2;
+				a1 = t1 + t3;
+				a2 = t1 - t3;
+				a3 = t0 - t2;
+			}
+
+			int b0, b1, b2, b3;
+			{
+				int t0, t1, t2, t3;
+				Butterfly(t0, t1, W7, W1, cblock[8 * 7], cblock[8 * 4]);
+				Butterfly(t2, t3, W3, W5, cblock[8 * 5], cblock[8 * 6]);
+				b0 = t0 + t2;
+				b3 = t1 + t3;
+				t0 = (t0 - t2) >> 8;
+				t1 = (t1 - t3) >> 8;
+				b1 = (t0 + t1) * 181;
+				b2 = (t0 - t1) * 181;
+			}
+
+			cblock[8 * 0] = static_cast<s16>((a0 + b0) >> 17);
+			cblock[8 * 1] = static_cast<s16>((a1 + b1) >> 17);
+			cblock[8 * 2] = static_cast<s16>((a2 + b2) >> 17);
+			cblock[8 * 3] = static_cast<s16>((a3 + b3) >> 17);
+			cblock[8 * 4] = static_cast<s16>((a3 - b3) >> 17);
+			cblock[8 * 5] = static_cast<s16>((a2 - b2) >> 17);
+			cblock[8 * 6] = static_cast<s16>((a1 - b1) >> 17);
+			cblock[8 * 7] = static_cast<s16>((a0 - b0) >> 17);
+		}
+	}
+
+	// Fills blocks from the given generator, runs both IDCTs and stops at the first mismatching block.
+	template <typename Fill>
+	static void CheckBlocks(u32 seed, int count, const Fill& fill)
+	{
+		std::mt19937 rng(seed);
+		alignas(16) s16 block[64];
+		alignas(16) s16 expected[64];
+		alignas(16) s16 input[64];
+
+		for (int n = 0; n < count; n++)
+		{
+			fill(rng, input);
+			std::memcpy(block, input, sizeof(block));
+			std::memcpy(expected, input, sizeof(expected));
+
+			ReferenceIDCT(expected);
+			MULTI_ISA_SELECT(IPU_IDCT)(block);
+
+			for (int i = 0; i < 64; i++)
+			{
+				ASSERT_EQ(block[i], expected[i]) << "block " << n << " coefficient " << i << " input " <<
+					::testing::PrintToString(std::vector<s16>(input, input + 64));
+			}
+		}
+	}
+} // namespace
+
+TEST(IDCT, MatchesReferenceFullRange)
+{
+	CheckBlocks(0x1d0c7u, 1000000, [](std::mt19937& rng, s16* block) {
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		for (int i = 0; i < 64; i++)
+			block[i] = static_cast<s16>(dist(rng));
+	});
+}
+
+TEST(IDCT, MatchesReferenceDequantisedRange)
+{
+	// Dequantised coefficients are saturated to 12 bits before the IDCT.
+	CheckBlocks(0x5a7u, 500000, [](std::mt19937& rng, s16* block) {
+		std::uniform_int_distribution<int> dist(-2048, 2047);
+		for (int i = 0; i < 64; i++)
+			block[i] = static_cast<s16>(dist(rng));
+	});
+}
+
+TEST(IDCT, MatchesReferenceSparse)
+{
+	// Mostly empty blocks, so plenty of rows take the reference's DC only shortcut.
+	CheckBlocks(0x59a25eu, 500000, [](std::mt19937& rng, s16* block) {
+		std::uniform_int_distribution<int> value(-32768, 32767);
+		std::uniform_int_distribution<int> chance(0, 7);
+		for (int i = 0; i < 64; i++)
+		{
+			const bool dc = (i & 7) == 0;
+			block[i] = (chance(rng) < (dc ? 6 : 1)) ? static_cast<s16>(value(rng)) : 0;
+		}
+	});
+}
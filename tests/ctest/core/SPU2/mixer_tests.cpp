@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2002-2024 PCSX2 Dev Team
+// SPDX-License-Identifier: GPL-3.0+
+
+#include "pcsx2/SPU2/defs.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct MixedSample
+	{
+		VoiceMixSet Voices[2];
+	};
+
+	// Random ADPCM blocks everywhere outside the dynamic area, with loop flags on some of the blocks so
+	// voices jump around and stop.
+	static void RandomiseMemory(std::mt19937& rng)
+	{
+		std::memset(_spu2mem, 0, sizeof(_spu2mem));
+
+		for (u32 addr = SPU2_DYN_MEMLINE; addr < 0x100000; addr += pcm_WordsPerBlock)
+		{
+			const u16 flags = ((rng() & 3) == 0) ? (rng() & 7) : 0;
+			_spu2mem[addr] = static_cast<s16>((flags << 8) | (rng() & 0xff));
+			for (int i = 1; i < pcm_WordsPerBlock; i++)
+				_spu2mem[addr + i] = static_cast<s16>(rng());
+		}
+	}
+
+	static u32 RandomBlockAddress(std::mt19937& rng)
+	{
+		return std::uniform_int_distribution<u32>(SPU2_DYN_MEMLINE, 0xF0000)(rng) & ~7u;
+	}
+
+	// Voices part way through every ADSR phase, playing from a random block the way StartQueuedVoice()
+	// leaves them. Only the first voice may be modulated, since the batched mixer can't handle the rest.
+	static void RandomiseCore(std::mt19937& rng, uint coreidx)
+	{
+		V_Core& core = Cores[coreidx];
+		core.Init(coreidx);
+		core.NoiseOut = rng();
+		core.Regs.ENDX = 0;
+
+		for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; voiceidx++)
+		{
+			V_VoiceGates& gates = core.VoiceGates[voiceidx];
+			gates.DryL = (rng() & 1) ? -1 : 0;
+			gates.DryR = (rng() & 1) ? -1 : 0;
+			gates.WetL = (rng() & 1) ? -1 : 0;
+			gates.WetR = (rng() & 1) ? -1 : 0;
+
+			V_Voice& vc = core.Voices[voiceidx];
+			vc.Volume.Left.RegSet(static_cast<u16>(rng()));
+			vc.Volume.Left.Counter = 0;
+			vc.Volume.Right.RegSet(static_cast<u16>(rng()));
+			vc.Volume.Right.Counter = 0;
+
+			vc.ADSR.reg32 = rng();
+			vc.ADSR.UpdateCache();
+			vc.ADSR.Phase = static_cast<u8>(rng() % V_ADSR::ADSR_PHASES);
+			vc.ADSR.Value = (vc.ADSR.Phase != V_ADSR::PHASE_STOPPED) ? static_cast<s32>(rng() & 0x7fff) : 0;
+			vc.ADSR.Counter = rng() & 0xffff;
+
+			vc.Pitch = static_cast<u16>(rng());
+			vc.Noise = (rng() & 7) == 0;
+			vc.Modulated = (voiceidx == 0) && (rng() & 1);
+
+			vc.PlayCycle = Cycles - 16;
+			vc.LoopCycle = Cycles - 17;
+			vc.PendingLoopStart = false;
+			vc.StartA = RandomBlockAddress(rng);
+			vc.LoopStartA = RandomBlockAddress(rng);
+
+			vc.SCurrent = 28;
+			vc.SP = -1;
+			vc.LoopMode = 0;
+			vc.LoopFlags = 0;
+			vc.NextA = vc.StartA | 1;
+			vc.Prev1 = vc.Prev2 = 0;
+			vc.PV1 = vc.PV2 = vc.PV3 = vc.PV4 = 0;
+			vc.OutX = 0;
+		}
+	}
+
+	static void InvalidatePcmCache()
+	{
+		for (PcmCacheEntry& entry : pcm_cache_data)
+			entry.Validated = false;
+	}
+
+	// Mixes the given number of samples, stepping the output position and clock like spu2Mix() does.
+	static std::vector<MixedSample> MixSamples(int count, bool batched, int* batched_count)
+	{
+		std::vector<MixedSample> samples(count);
+
+		for (MixedSample& sample : samples)
+		{
+			for (uint coreidx = 0; coreidx < 2; coreidx++)
+			{
+				VoiceMixSet& dest = sample.Voices[coreidx];
+				dest = VoiceMixSet::Empty;
+				if (batched && spu2MixCoreVoices(dest, coreidx, true))
+					(*batched_count)++;
+				else
+					spu2MixCoreVoices(dest, coreidx, false);
+			}
+
+			if (++OutPos >= 0x200)
+				OutPos = 0;
+			Cycles++;
+		}
+
+		return samples;
+	}
+
+	static void CompareVoices(const V_Core& expected, const V_Core& actual)
+	{
+		EXPECT_EQ(expected.Regs.ENDX, actual.Regs.ENDX) << "core " << expected.Index;
+
+		for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; voiceidx++)
+		{
+			const V_Voice& ev = expected.Voices[voiceidx];
+			const V_Voice& av = actual.Voices[voiceidx];
+			SCOPED_TRACE(testing::Message() << "core " << expected.Index << " voice " << voiceidx);
+
+			EXPECT_EQ(ev.Volume.Left.Value, av.Volume.Left.Value);
+			EXPECT_EQ(ev.Volume.Right.Value, av.Volume.Right.Value);
+			EXPECT_EQ(ev.ADSR.Phase, av.ADSR.Phase);
+			EXPECT_EQ(ev.ADSR.Value, av.ADSR.Value);
+			EXPECT_EQ(ev.ADSR.Counter, av.ADSR.Counter);
+			EXPECT_EQ(ev.SP, av.SP);
+			EXPECT_EQ(ev.SCurrent, av.SCurrent);
+			EXPECT_EQ(ev.NextA, av.NextA);
+			EXPECT_EQ(ev.LoopStartA, av.LoopStartA);
+			EXPECT_EQ(ev.LoopFlags, av.LoopFlags);
+			EXPECT_EQ(ev.Prev1, av.Prev1);
+			EXPECT_EQ(ev.Prev2, av.Prev2);
+			EXPECT_EQ(ev.PV1, av.PV1);
+			EXPECT_EQ(ev.PV2, av.PV2);
+			EXPECT_EQ(ev.PV3, av.PV3);
+			EXPECT_EQ(ev.PV4, av.PV4);
+			EXPECT_EQ(ev.OutX, av.OutX);
+		}
+	}
+} // namespace
+
+TEST(SPU2Mixer, BatchedMatchesScalar)
+{
+	static constexpr int SAMPLES = 4096;
+
+	for (u32 seed = 1; seed <= 16; seed++)
+	{
+		SCOPED_TRACE(testing::Message() << "seed " << seed);
+
+		std::mt19937 rng(seed);
+		RandomiseMemory(rng);
+		RandomiseCore(rng, 0);
+		RandomiseCore(rng, 1);
+		OutPos = static_cast<u16>(rng() & 0x1ff);
+
+		V_Core start_cores[2];
+		std::memcpy(start_cores, Cores, sizeof(Cores));
+		const std::vector<s16> start_mem(_spu2mem, _spu2mem + std::size(_spu2mem));
+		const u16 start_outpos = OutPos;
+		const u32 start_cycles = Cycles;
+
+		InvalidatePcmCache();
+		const std::vector<MixedSample> expected = MixSamples(SAMPLES, false, nullptr);
+		V_Core expected_cores[2];
+		std::memcpy(expected_cores, Cores, sizeof(Cores));
+		const std::vector<s16> expected_mem(_spu2mem, _spu2mem + std::size(_spu2mem));
+
+		std::memcpy(Cores, start_cores, sizeof(Cores));
+		std::memcpy(_spu2mem, start_mem.data(), sizeof(_spu2mem));
+		OutPos = start_outpos;
+		Cycles = start_cycles;
+
+		InvalidatePcmCache();
+		int batched_count = 0;
+		const std::vector<MixedSample> actual = MixSamples(SAMPLES, true, &batched_count);
+		EXPECT_GT(batched_count, 0);
+
+		for (int i = 0; i < SAMPLES; i++)
+		{
+			for (uint coreidx = 0; coreidx < 2; coreidx++)
+			{
+				const VoiceMixSet& ev = expected[i].Voices[coreidx];
+				const VoiceMixSet& av = actual[i].Voices[coreidx];
+				ASSERT_TRUE(ev.Dry.Left == av.Dry.Left && ev.Dry.Right == av.Dry.Right &&
+							ev.Wet.Left == av.Wet.Left && ev.Wet.Right == av.Wet.Right)
+					<< "sample " << i << " core " << coreidx;
+			}
+		}
+
+		CompareVoices(expected_cores[0], Cores[0]);
+		CompareVoices(expected_cores[1], Cores[1]);
+		EXPECT_TRUE(expected_mem == std::vector<s16>(_spu2mem, _spu2mem + std::size(_spu2mem)));
+	}
+}